@@ -1,16 +1,16 @@
 #pragma once
 
-#include <Windows.h>
-#include <mmdeviceapi.h>
-#include <audioclient.h>
-#include <audiopolicy.h>
-#include <dsound.h>
+#include <chrono>
 #include <memory>
 #include <functional>
 #include <thread>
 #include <atomic>
 #include <vector>
 #include <string>
+#include <cstdint>
+#include "AudioPipeline.h"
+#include "CaptureFreshnessGuard.h"
+#include "ICaptureSource.h"
 
 class AudioCaptureManager {
 public:
@@ -22,7 +22,17 @@ public:
         AUTO                // Try methods in order until one works
     };
 
-    using AudioDataCallback = std::function<void(const float* samples, size_t sampleCount, size_t channels)>;
+    // How often a device source wakes with new audio (WASAPI engine period,
+    // DirectSound notification chunk). Shorter periods cut latency but cost
+    // more wakeups and may glitch on weak drivers.
+    enum class CaptureLatency {
+        LOW,        // 3 ms, via IAudioClient3 where the driver supports it
+        BALANCED,   // 10 ms, the usual shared-mode engine period
+        SAFE        // 20 ms
+    };
+
+    // Invoked on the pipeline's consumer thread, never on the capture thread
+    using AudioDataCallback = AudioPipeline::BlockCallback;
 
     AudioCaptureManager();
     ~AudioCaptureManager();
@@ -32,11 +42,36 @@ public:
     void StopCapture();
     void SetAudioCallback(AudioDataCallback callback);
 
+    // WAV file used by FILE_INPUT (empty = generated test tone). Real-time
+    // playback loops; otherwise the file is analyzed once as fast as the
+    // consumer keeps up, without dropping blocks. Call before Initialize.
+    void SetInputFile(const std::string& path, bool realTime = true);
+
+    // Real-time FILE_INPUT only: deliver audio this far ahead of its playback
+    // time, stamped with the playback time (see FileCaptureSource::SetLookAhead).
+    // Call before Initialize.
+    void SetInputLookAhead(std::chrono::milliseconds lead) { m_inputLookAhead = lead; }
+
+    // Device period to ask for; sources fall back to what the driver allows.
+    // Call before Initialize.
+    void SetCaptureLatency(CaptureLatency latency) { m_captureLatency = latency; }
+    static std::chrono::milliseconds GetCapturePeriod(CaptureLatency latency);
+
+    // Stall recovery: audio older than this when it reaches the capture
+    // thread is skipped instead of analyzed (0 keeps everything). Applies to
+    // real-time sources. Call while stopped.
+    void SetMaxCaptureAge(std::chrono::milliseconds maxAge) { m_freshnessGuard.SetMaxAge(maxAge); }
+
     bool IsCapturing() const { return m_isCapturing; }
-    UINT32 GetSampleRate() const { return m_sampleRate; }
-    UINT32 GetChannelCount() const { return m_channelCount; }
+    bool IsInputFinished() const { return m_inputFinished; }
+    uint32_t GetSampleRate() const { return m_source ? m_source->GetSampleRate() : 0; }
+    uint32_t GetChannelCount() const { return m_source ? m_source->GetChannelCount() : 0; }
+    uint32_t GetChannelMask() const { return m_source ? m_source->GetChannelMask() : 0; }
     CaptureMethod GetActiveMethod() const { return m_activeMethod; }
+    bool IsEventDriven() const { return m_source && m_source->IsEventDriven(); }
     std::string GetMethodName() const;
+    AudioPipeline::Stats GetPipelineStats() const { return m_pipeline.GetStats(); }
+    CaptureFreshnessGuard::Stats GetFreshnessStats() const { return m_freshnessGuard.GetStats(); }
 
     // Static utility methods
     static std::vector<std::string> GetAvailableDevices();
@@ -44,46 +79,31 @@ public:
     static bool IsDirectSoundAvailable();
 
 private:
-    bool InitializeWASAPILoopback();
-    bool InitializeWASAPIMicrophone();
-    bool InitializeDirectSound();
-    bool InitializeFileInput();
+    // Returns nullptr for methods not available on this platform
+    std::unique_ptr<ICaptureSource> CreateSource(CaptureMethod method) const;
+    bool TryInitialize(CaptureMethod method);
 
     void CaptureThread();
-    void WASAPICaptureLoop();
-    void DirectSoundCaptureLoop();
-    void FileInputLoop();
-    void Cleanup();
-
-    // WASAPI members
-    IMMDeviceEnumerator* m_deviceEnumerator;
-    IMMDevice* m_device;
-    IAudioClient* m_audioClient;
-    IAudioCaptureClient* m_captureClient;
-    WAVEFORMATEX* m_waveFormat;
-    UINT32 m_bufferFrameCount;
-
-    // DirectSound members
-    LPDIRECTSOUNDCAPTURE m_dsCapture;
-    LPDIRECTSOUNDCAPTUREBUFFER m_dsCaptureBuffer;
-    DSCBUFFERDESC m_dsBufferDesc;
-    WAVEFORMATEX m_dsWaveFormat;
-
-    // Audio format
-    UINT32 m_sampleRate;
-    UINT32 m_channelCount;
+
+    // Active capture backend
+    std::unique_ptr<ICaptureSource> m_source;
     CaptureMethod m_activeMethod;
 
     // Threading
     std::thread m_captureThread;
     std::atomic<bool> m_isCapturing;
     std::atomic<bool> m_shouldStop;
+    std::atomic<bool> m_inputFinished;
+
+    // Capture -> processing handoff (SPSC ring + consumer thread)
+    AudioPipeline m_pipeline;
 
-    // Callback
-    AudioDataCallback m_audioCallback;
+    // Skips the backlog a real-time source hands over after a stall
+    CaptureFreshnessGuard m_freshnessGuard;
+    CaptureLatency m_captureLatency;
 
-    // File input (for testing)
-    std::string m_testAudioFile;
-    std::vector<float> m_fileAudioData;
-    size_t m_filePosition;
-};
\ No newline at end of file
+    // File input
+    std::string m_inputFile;
+    bool m_inputRealTime;
+    std::chrono::milliseconds m_inputLookAhead;
+};
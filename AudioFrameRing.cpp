@@ -0,0 +1,122 @@
+#include "AudioFrameRing.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+}
+
+AudioFrameRing::AudioFrameRing(size_t slotCount, size_t samplesPerSlot)
+    : m_slotCount(RoundUpToPowerOfTwo((std::max)(slotCount, size_t(2))))
+    , m_mask(m_slotCount - 1)
+    , m_samplesPerSlot((std::max)(samplesPerSlot, size_t(1)))
+    , m_storage(m_slotCount * m_samplesPerSlot, 0.0f)
+    , m_slots(m_slotCount)
+    , m_writeIndex(0)
+    , m_cachedReadIndex(0)
+    , m_overflowCount(0)
+    , m_readIndex(0)
+    , m_padding{}
+{
+}
+
+bool AudioFrameRing::Push(const float* samples, size_t sampleCount, size_t channels, const BlockTimestamps& timestamps) {
+    if (!samples || channels == 0 || channels > m_samplesPerSlot) {
+        return false;
+    }
+
+    const size_t frameCount = sampleCount / channels;
+    if (frameCount == 0) {
+        return true;
+    }
+
+    const size_t framesPerSlot = m_samplesPerSlot / channels;
+    const size_t slotsNeeded = (frameCount + framesPerSlot - 1) / framesPerSlot;
+
+    // Only re-read the consumer's index when the cached one says we're full
+    const size_t write = m_writeIndex.load(std::memory_order_relaxed);
+    if (slotsNeeded > m_slotCount - (write - m_cachedReadIndex)) {
+        m_cachedReadIndex = m_readIndex.load(std::memory_order_acquire);
+        if (slotsNeeded > m_slotCount - (write - m_cachedReadIndex)) {
+            m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    size_t framesLeft = frameCount;
+    for (size_t i = 0; i < slotsNeeded; ++i) {
+        const size_t frames = (std::min)(framesLeft, framesPerSlot);
+        const size_t count = frames * channels;
+
+        std::memcpy(SlotData(write + i), samples, count * sizeof(float));
+        SlotInfo& info = m_slots[(write + i) & m_mask];
+        info.sampleCount = count;
+        info.channels = channels;
+        info.timestamps = timestamps;
+        info.packetEnd = i + 1 == slotsNeeded;
+
+        samples += count;
+        framesLeft -= frames;
+    }
+
+    m_writeIndex.store(write + slotsNeeded, std::memory_order_release);
+    return true;
+}
+
+bool AudioFrameRing::CanPush(size_t sampleCount, size_t channels) {
+    if (channels == 0 || channels > m_samplesPerSlot) {
+        return true;
+    }
+
+    const size_t framesPerSlot = m_samplesPerSlot / channels;
+    const size_t slotsNeeded = (sampleCount / channels + framesPerSlot - 1) / framesPerSlot;
+    if (slotsNeeded > m_slotCount) {
+        return true;
+    }
+
+    const size_t write = m_writeIndex.load(std::memory_order_relaxed);
+    if (slotsNeeded <= m_slotCount - (write - m_cachedReadIndex)) {
+        return true;
+    }
+    m_cachedReadIndex = m_readIndex.load(std::memory_order_acquire);
+    return slotsNeeded <= m_slotCount - (write - m_cachedReadIndex);
+}
+
+bool AudioFrameRing::Front(Block& block) const {
+    const size_t read = m_readIndex.load(std::memory_order_relaxed);
+    if (read == m_writeIndex.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    const SlotInfo& info = m_slots[read & m_mask];
+    block.samples = SlotData(read);
+    block.sampleCount = info.sampleCount;
+    block.channels = info.channels;
+    block.timestamps = info.timestamps;
+    block.packetEnd = info.packetEnd;
+    return true;
+}
+
+void AudioFrameRing::Pop() {
+    const size_t read = m_readIndex.load(std::memory_order_relaxed);
+    m_readIndex.store(read + 1, std::memory_order_release);
+}
+
+void AudioFrameRing::Reset() {
+    m_writeIndex.store(0, std::memory_order_relaxed);
+    m_readIndex.store(0, std::memory_order_relaxed);
+    m_cachedReadIndex = 0;
+}
+
+size_t AudioFrameRing::GetDepth() const {
+    // Read index first so a concurrent push/pop can't make the difference negative
+    const size_t read = m_readIndex.load(std::memory_order_acquire);
+    const size_t write = m_writeIndex.load(std::memory_order_acquire);
+    return write - read;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "LatencyTracker.h"
+
+// Wait-free single-producer/single-consumer ring of audio blocks.
+// Storage is allocated once up front; Push copies a packet into one or more
+// fixed-size slots so the capture side can release its device buffer right away.
+// Exactly one thread may call Push and exactly one thread may call Front/Pop.
+class AudioFrameRing {
+public:
+    struct Block {
+        const float* samples;
+        size_t sampleCount;
+        size_t channels;
+        BlockTimestamps timestamps;
+        bool packetEnd;     // Last (or only) slot of its packet
+    };
+
+    // slotCount is rounded up to a power of two
+    AudioFrameRing(size_t slotCount, size_t samplesPerSlot);
+    ~AudioFrameRing() = default;
+
+    AudioFrameRing(const AudioFrameRing&) = delete;
+    AudioFrameRing& operator=(const AudioFrameRing&) = delete;
+
+    // Producer: copies whole frames into the ring. Returns false and counts an
+    // overflow if the packet does not fit; nothing is written in that case.
+    // A packet split over several slots stamps them all with its timestamps.
+    bool Push(const float* samples, size_t sampleCount, size_t channels, const BlockTimestamps& timestamps);
+
+    // Producer: false while the consumer still has to free slots for this
+    // packet. Packets that could never fit report true (Push then drops them).
+    bool CanPush(size_t sampleCount, size_t channels);
+
+    // Consumer: peek at the oldest block, then Pop once done with it
+    bool Front(Block& block) const;
+    void Pop();
+
+    // Discard everything. Only safe while neither side is running.
+    void Reset();
+
+    size_t GetDepth() const;
+    size_t GetSlotCount() const { return m_slotCount; }
+    size_t GetSamplesPerSlot() const { return m_samplesPerSlot; }
+    uint64_t GetOverflowCount() const { return m_overflowCount.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct SlotInfo {
+        size_t sampleCount = 0;
+        size_t channels = 0;
+        BlockTimestamps timestamps;
+        bool packetEnd = false;
+    };
+
+    float* SlotData(size_t index) { return m_storage.data() + (index & m_mask) * m_samplesPerSlot; }
+    const float* SlotData(size_t index) const { return m_storage.data() + (index & m_mask) * m_samplesPerSlot; }
+
+    const size_t m_slotCount;
+    const size_t m_mask;
+    const size_t m_samplesPerSlot;
+    std::vector<float> m_storage;
+    std::vector<SlotInfo> m_slots;
+
+    // Producer-owned line
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_writeIndex;
+    size_t m_cachedReadIndex;
+    std::atomic<uint64_t> m_overflowCount;
+
+    // Consumer-owned line
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_readIndex;
+    char m_padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+};
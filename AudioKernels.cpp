@@ -0,0 +1,713 @@
+#include "AudioKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+    #define AUDIOKERNELS_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define AUDIOKERNELS_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// GCC/Clang need per-function target attributes to emit AVX2 without -mavx2;
+// MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+    #define AUDIOKERNELS_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define AUDIOKERNELS_TARGET(isa)
+#endif
+
+// The layout-dependent helpers are forced inline so a layout kernel sees its
+// channel count as a constant all the way down
+#if defined(_MSC_VER)
+    #define AUDIOKERNELS_INLINE __forceinline
+#else
+    #define AUDIOKERNELS_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace AudioKernels {
+namespace {
+
+// Frames per downmix chunk. Small enough that the mono scratch stays in L1.
+constexpr size_t CHUNK_FRAMES = 256;
+
+void DownmixScalar(const float* in, size_t frames, size_t channels, float* out) {
+    const float scale = 1.0f / static_cast<float>(channels);
+    for (size_t f = 0; f < frames; ++f) {
+        const float* frame = in + f * channels;
+        float sum = 0.0f;
+        for (size_t ch = 0; ch < channels; ++ch) {
+            sum += frame[ch];
+        }
+        out[f] = sum * scale;
+    }
+}
+
+// Downmix plus per-channel sum of squares, for channels <= MAX_CHANNELS
+AUDIOKERNELS_INLINE void SplitScalar(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+    const float scale = 1.0f / static_cast<float>(channels);
+    float sums[MAX_CHANNELS] = {};
+    for (size_t f = 0; f < frames; ++f) {
+        const float* frame = in + f * channels;
+        float sum = 0.0f;
+        for (size_t ch = 0; ch < channels; ++ch) {
+            sum += frame[ch];
+            sums[ch] += frame[ch] * frame[ch];
+        }
+        mono[f] = sum * scale;
+    }
+    std::copy(sums, sums + channels, channelSumSquares);
+}
+
+void SumSquaresPeakScalar(const float* mono, size_t count, float& sumSquares, float& peak) {
+    float sum = 0.0f;
+    float maxAbs = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        sum += mono[i] * mono[i];
+        maxAbs = std::max(maxAbs, std::abs(mono[i]));
+    }
+    sumSquares = sum;
+    peak = maxAbs;
+}
+
+struct ScalarOps {
+    static void Downmix(const float* in, size_t frames, size_t channels, float* out) {
+        DownmixScalar(in, frames, channels, out);
+    }
+    static void Split(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+        SplitScalar(in, frames, channels, mono, channelSumSquares);
+    }
+    static void SumSquaresPeak(const float* mono, size_t count, float& sumSquares, float& peak) {
+        SumSquaresPeakScalar(mono, count, sumSquares, peak);
+    }
+
+    // Split with the channel count fixed at compile time (0 = as passed)
+    template <size_t Channels>
+    static void SplitLayout(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+        SplitScalar(in, frames, Channels ? Channels : channels, mono, channelSumSquares);
+    }
+};
+
+#if AUDIOKERNELS_X86
+
+float HorizontalSum(__m128 v) {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+struct SSE2Ops {
+    static void Downmix(const float* in, size_t frames, size_t channels, float* out) {
+        size_t f = 0;
+        if (channels == 2) {
+            const __m128 half = _mm_set1_ps(0.5f);
+            for (; f + 4 <= frames; f += 4) {
+                __m128 a = _mm_loadu_ps(in + f * 2);
+                __m128 b = _mm_loadu_ps(in + f * 2 + 4);
+                __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(out + f, _mm_mul_ps(_mm_add_ps(left, right), half));
+            }
+        }
+        else if (channels % 4 == 0) {
+            // Sum each frame's channels four at a time, then transpose four
+            // frames so the horizontal sums become one vertical add.
+            const __m128 scale = _mm_set1_ps(1.0f / static_cast<float>(channels));
+            for (; f + 4 <= frames; f += 4) {
+                __m128 v0 = _mm_setzero_ps();
+                __m128 v1 = _mm_setzero_ps();
+                __m128 v2 = _mm_setzero_ps();
+                __m128 v3 = _mm_setzero_ps();
+                const float* frame = in + f * channels;
+                for (size_t ch = 0; ch < channels; ch += 4) {
+                    v0 = _mm_add_ps(v0, _mm_loadu_ps(frame + ch));
+                    v1 = _mm_add_ps(v1, _mm_loadu_ps(frame + channels + ch));
+                    v2 = _mm_add_ps(v2, _mm_loadu_ps(frame + channels * 2 + ch));
+                    v3 = _mm_add_ps(v3, _mm_loadu_ps(frame + channels * 3 + ch));
+                }
+                _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+                __m128 sum = _mm_add_ps(_mm_add_ps(v0, v1), _mm_add_ps(v2, v3));
+                _mm_storeu_ps(out + f, _mm_mul_ps(sum, scale));
+            }
+        }
+        DownmixScalar(in + f * channels, frames - f, channels, out + f);
+    }
+
+    // Four frames at a time. When the channel count is a multiple of four each
+    // load holds one frame's channels, so channel energies add up vertically
+    // and only the frame sums are transposed (as in Downmix). Other layouts
+    // are transposed in registers so every channel ends up in its own vector:
+    // groups of four channels with _MM_TRANSPOSE4_PS, a remaining pair with
+    // 64-bit loads and a shuffle, a last odd channel gathered.
+    AUDIOKERNELS_INLINE static void Split(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+        if (channels % 4 == 0) {
+            SplitQuads(in, frames, channels, mono, channelSumSquares);
+            return;
+        }
+
+        __m128 acc[MAX_CHANNELS];
+        for (size_t ch = 0; ch < channels; ++ch) {
+            acc[ch] = _mm_setzero_ps();
+        }
+
+        size_t f = 0;
+        if (channels == 2) {
+            const __m128 half = _mm_set1_ps(0.5f);
+            for (; f + 4 <= frames; f += 4) {
+                __m128 a = _mm_loadu_ps(in + f * 2);
+                __m128 b = _mm_loadu_ps(in + f * 2 + 4);
+                __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                acc[0] = _mm_add_ps(acc[0], _mm_mul_ps(left, left));
+                acc[1] = _mm_add_ps(acc[1], _mm_mul_ps(right, right));
+                _mm_storeu_ps(mono + f, _mm_mul_ps(_mm_add_ps(left, right), half));
+            }
+        }
+        else {
+            const __m128 scale = _mm_set1_ps(1.0f / static_cast<float>(channels));
+            for (; f + 4 <= frames; f += 4) {
+                const float* f0 = in + f * channels;
+                const float* f1 = f0 + channels;
+                const float* f2 = f1 + channels;
+                const float* f3 = f2 + channels;
+                __m128 sum = _mm_setzero_ps();
+
+                size_t ch = 0;
+                for (; ch + 4 <= channels; ch += 4) {
+                    __m128 c0 = _mm_loadu_ps(f0 + ch);
+                    __m128 c1 = _mm_loadu_ps(f1 + ch);
+                    __m128 c2 = _mm_loadu_ps(f2 + ch);
+                    __m128 c3 = _mm_loadu_ps(f3 + ch);
+                    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+                    acc[ch] = _mm_add_ps(acc[ch], _mm_mul_ps(c0, c0));
+                    acc[ch + 1] = _mm_add_ps(acc[ch + 1], _mm_mul_ps(c1, c1));
+                    acc[ch + 2] = _mm_add_ps(acc[ch + 2], _mm_mul_ps(c2, c2));
+                    acc[ch + 3] = _mm_add_ps(acc[ch + 3], _mm_mul_ps(c3, c3));
+                    sum = _mm_add_ps(sum, _mm_add_ps(_mm_add_ps(c0, c1), _mm_add_ps(c2, c3)));
+                }
+                if (ch + 2 <= channels) {
+                    __m128 a = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(f0 + ch)),
+                                            reinterpret_cast<const __m64*>(f1 + ch));
+                    __m128 b = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(f2 + ch)),
+                                            reinterpret_cast<const __m64*>(f3 + ch));
+                    __m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                    __m128 y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                    acc[ch] = _mm_add_ps(acc[ch], _mm_mul_ps(x, x));
+                    acc[ch + 1] = _mm_add_ps(acc[ch + 1], _mm_mul_ps(y, y));
+                    sum = _mm_add_ps(sum, _mm_add_ps(x, y));
+                    ch += 2;
+                }
+                if (ch < channels) {
+                    __m128 x = _mm_set_ps(f3[ch], f2[ch], f1[ch], f0[ch]);
+                    acc[ch] = _mm_add_ps(acc[ch], _mm_mul_ps(x, x));
+                    sum = _mm_add_ps(sum, x);
+                }
+                _mm_storeu_ps(mono + f, _mm_mul_ps(sum, scale));
+            }
+        }
+
+        float tail[MAX_CHANNELS];
+        SplitScalar(in + f * channels, frames - f, channels, mono + f, tail);
+        for (size_t ch = 0; ch < channels; ++ch) {
+            channelSumSquares[ch] = HorizontalSum(acc[ch]) + tail[ch];
+        }
+    }
+
+    AUDIOKERNELS_INLINE static void SplitQuads(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+        __m128 acc[MAX_CHANNELS / 4];
+        for (size_t g = 0; g < channels / 4; ++g) {
+            acc[g] = _mm_setzero_ps();
+        }
+
+        const __m128 scale = _mm_set1_ps(1.0f / static_cast<float>(channels));
+        size_t f = 0;
+        for (; f + 4 <= frames; f += 4) {
+            __m128 v0 = _mm_setzero_ps();
+            __m128 v1 = _mm_setzero_ps();
+            __m128 v2 = _mm_setzero_ps();
+            __m128 v3 = _mm_setzero_ps();
+            const float* frame = in + f * channels;
+            for (size_t ch = 0; ch < channels; ch += 4) {
+                __m128 a0 = _mm_loadu_ps(frame + ch);
+                __m128 a1 = _mm_loadu_ps(frame + channels + ch);
+                __m128 a2 = _mm_loadu_ps(frame + channels * 2 + ch);
+                __m128 a3 = _mm_loadu_ps(frame + channels * 3 + ch);
+                __m128 squares = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, a0), _mm_mul_ps(a1, a1)),
+                                            _mm_add_ps(_mm_mul_ps(a2, a2), _mm_mul_ps(a3, a3)));
+                acc[ch / 4] = _mm_add_ps(acc[ch / 4], squares);
+                v0 = _mm_add_ps(v0, a0);
+                v1 = _mm_add_ps(v1, a1);
+                v2 = _mm_add_ps(v2, a2);
+                v3 = _mm_add_ps(v3, a3);
+            }
+            _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+            __m128 sum = _mm_add_ps(_mm_add_ps(v0, v1), _mm_add_ps(v2, v3));
+            _mm_storeu_ps(mono + f, _mm_mul_ps(sum, scale));
+        }
+
+        float tail[MAX_CHANNELS];
+        SplitScalar(in + f * channels, frames - f, channels, mono + f, tail);
+        for (size_t g = 0; g < channels / 4; ++g) {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, acc[g]);
+            for (size_t k = 0; k < 4; ++k) {
+                channelSumSquares[g * 4 + k] = lanes[k] + tail[g * 4 + k];
+            }
+        }
+    }
+
+    static void SumSquaresPeak(const float* mono, size_t count, float& sumSquares, float& peak) {
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        __m128 sum = _mm_setzero_ps();
+        __m128 maxAbs = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 v = _mm_loadu_ps(mono + i);
+            sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+            maxAbs = _mm_max_ps(maxAbs, _mm_and_ps(v, absMask));
+        }
+
+        alignas(16) float sums[4];
+        alignas(16) float peaks[4];
+        _mm_store_ps(sums, sum);
+        _mm_store_ps(peaks, maxAbs);
+
+        float tailSum = 0.0f;
+        float tailPeak = 0.0f;
+        SumSquaresPeakScalar(mono + i, count - i, tailSum, tailPeak);
+
+        sumSquares = (sums[0] + sums[1]) + (sums[2] + sums[3]) + tailSum;
+        peak = std::max({ peaks[0], peaks[1], peaks[2], peaks[3], tailPeak });
+    }
+
+    template <size_t Channels>
+    static void SplitLayout(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+        Split(in, frames, Channels ? Channels : channels, mono, channelSumSquares);
+    }
+};
+
+struct AVX2Ops {
+    AUDIOKERNELS_TARGET("avx2")
+    static void Downmix(const float* in, size_t frames, size_t channels, float* out) {
+        size_t f = 0;
+        if (channels == 2) {
+            const __m256 half = _mm256_set1_ps(0.5f);
+            for (; f + 8 <= frames; f += 8) {
+                __m256 a = _mm256_loadu_ps(in + f * 2);
+                __m256 b = _mm256_loadu_ps(in + f * 2 + 8);
+                // In-lane shuffles leave the frames in 0,2,1,3 quad order
+                __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                __m256 sum = _mm256_mul_ps(_mm256_add_ps(left, right), half);
+                sum = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0)));
+                _mm256_storeu_ps(out + f, sum);
+            }
+        }
+        else if (channels % 8 == 0) {
+            // Three rounds of hadd reduce four 8-wide frame sums to one __m128
+            const __m128 scale = _mm_set1_ps(1.0f / static_cast<float>(channels));
+            for (; f + 4 <= frames; f += 4) {
+                __m256 v0 = _mm256_setzero_ps();
+                __m256 v1 = _mm256_setzero_ps();
+                __m256 v2 = _mm256_setzero_ps();
+                __m256 v3 = _mm256_setzero_ps();
+                const float* frame = in + f * channels;
+                for (size_t ch = 0; ch < channels; ch += 8) {
+                    v0 = _mm256_add_ps(v0, _mm256_loadu_ps(frame + ch));
+                    v1 = _mm256_add_ps(v1, _mm256_loadu_ps(frame + channels + ch));
+                    v2 = _mm256_add_ps(v2, _mm256_loadu_ps(frame + channels * 2 + ch));
+                    v3 = _mm256_add_ps(v3, _mm256_loadu_ps(frame + channels * 3 + ch));
+                }
+                __m256 pairs = _mm256_hadd_ps(_mm256_hadd_ps(v0, v1), _mm256_hadd_ps(v2, v3));
+                __m128 sum = _mm_add_ps(_mm256_castps256_ps128(pairs), _mm256_extractf128_ps(pairs, 1));
+                _mm_storeu_ps(out + f, _mm_mul_ps(sum, scale));
+            }
+        }
+        else {
+            SSE2Ops::Downmix(in, frames, channels, out);
+            return;
+        }
+        DownmixScalar(in + f * channels, frames - f, channels, out + f);
+    }
+
+    // 8-wide for stereo and 7.1; other layouts gain little over SSE2
+    AUDIOKERNELS_TARGET("avx2")
+    AUDIOKERNELS_INLINE static void Split(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+        if (channels == 8) {
+            SplitEight(in, frames, mono, channelSumSquares);
+            return;
+        }
+        if (channels != 2) {
+            SSE2Ops::Split(in, frames, channels, mono, channelSumSquares);
+            return;
+        }
+
+        const __m256 half = _mm256_set1_ps(0.5f);
+        __m256 leftAcc = _mm256_setzero_ps();
+        __m256 rightAcc = _mm256_setzero_ps();
+        size_t f = 0;
+        for (; f + 8 <= frames; f += 8) {
+            __m256 a = _mm256_loadu_ps(in + f * 2);
+            __m256 b = _mm256_loadu_ps(in + f * 2 + 8);
+            // Frame order within the vectors doesn't matter for the energies
+            __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            leftAcc = _mm256_add_ps(leftAcc, _mm256_mul_ps(left, left));
+            rightAcc = _mm256_add_ps(rightAcc, _mm256_mul_ps(right, right));
+            __m256 sum = _mm256_mul_ps(_mm256_add_ps(left, right), half);
+            sum = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0)));
+            _mm256_storeu_ps(mono + f, sum);
+        }
+
+        float tail[MAX_CHANNELS];
+        SSE2Ops::Split(in + f * 2, frames - f, 2, mono + f, tail);
+        channelSumSquares[0] = HorizontalSum(_mm_add_ps(_mm256_castps256_ps128(leftAcc), _mm256_extractf128_ps(leftAcc, 1))) + tail[0];
+        channelSumSquares[1] = HorizontalSum(_mm_add_ps(_mm256_castps256_ps128(rightAcc), _mm256_extractf128_ps(rightAcc, 1))) + tail[1];
+    }
+
+    // One frame per load: channel energies accumulate vertically, frame sums
+    // reduce with the same hadd rounds as Downmix
+    AUDIOKERNELS_TARGET("avx2")
+    AUDIOKERNELS_INLINE static void SplitEight(const float* in, size_t frames, float* mono, float* channelSumSquares) {
+        const __m128 scale = _mm_set1_ps(1.0f / 8.0f);
+        __m256 acc = _mm256_setzero_ps();
+        size_t f = 0;
+        for (; f + 4 <= frames; f += 4) {
+            const float* frame = in + f * 8;
+            __m256 v0 = _mm256_loadu_ps(frame);
+            __m256 v1 = _mm256_loadu_ps(frame + 8);
+            __m256 v2 = _mm256_loadu_ps(frame + 16);
+            __m256 v3 = _mm256_loadu_ps(frame + 24);
+            acc = _mm256_add_ps(acc, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v0, v0), _mm256_mul_ps(v1, v1)),
+                                                   _mm256_add_ps(_mm256_mul_ps(v2, v2), _mm256_mul_ps(v3, v3))));
+            __m256 pairs = _mm256_hadd_ps(_mm256_hadd_ps(v0, v1), _mm256_hadd_ps(v2, v3));
+            __m128 sum = _mm_add_ps(_mm256_castps256_ps128(pairs), _mm256_extractf128_ps(pairs, 1));
+            _mm_storeu_ps(mono + f, _mm_mul_ps(sum, scale));
+        }
+
+        float tail[MAX_CHANNELS];
+        SplitScalar(in + f * 8, frames - f, 8, mono + f, tail);
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, acc);
+        for (size_t ch = 0; ch < 8; ++ch) {
+            channelSumSquares[ch] = lanes[ch] + tail[ch];
+        }
+    }
+
+    AUDIOKERNELS_TARGET("avx2")
+    static void SumSquaresPeak(const float* mono, size_t count, float& sumSquares, float& peak) {
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+        __m256 sum = _mm256_setzero_ps();
+        __m256 maxAbs = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256 v = _mm256_loadu_ps(mono + i);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(v, v));
+            maxAbs = _mm256_max_ps(maxAbs, _mm256_and_ps(v, absMask));
+        }
+
+        __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        __m128 max4 = _mm_max_ps(_mm256_castps256_ps128(maxAbs), _mm256_extractf128_ps(maxAbs, 1));
+        alignas(16) float sums[4];
+        alignas(16) float peaks[4];
+        _mm_store_ps(sums, sum4);
+        _mm_store_ps(peaks, max4);
+
+        float tailSum = 0.0f;
+        float tailPeak = 0.0f;
+        SSE2Ops::SumSquaresPeak(mono + i, count - i, tailSum, tailPeak);
+
+        sumSquares = (sums[0] + sums[1]) + (sums[2] + sums[3]) + tailSum;
+        peak = std::max({ peaks[0], peaks[1], peaks[2], peaks[3], tailPeak });
+    }
+
+    template <size_t Channels>
+    AUDIOKERNELS_TARGET("avx2")
+    static void SplitLayout(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+        Split(in, frames, Channels ? Channels : channels, mono, channelSumSquares);
+    }
+};
+
+bool CpuSupportsAVX2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // AUDIOKERNELS_X86
+
+#if AUDIOKERNELS_NEON
+
+struct NEONOps {
+    static void Downmix(const float* in, size_t frames, size_t channels, float* out) {
+        size_t f = 0;
+        if (channels == 2) {
+            const float32x4_t half = vdupq_n_f32(0.5f);
+            for (; f + 4 <= frames; f += 4) {
+                float32x4x2_t lr = vld2q_f32(in + f * 2);
+                vst1q_f32(out + f, vmulq_f32(vaddq_f32(lr.val[0], lr.val[1]), half));
+            }
+        }
+        else if (channels == 4) {
+            const float32x4_t quarter = vdupq_n_f32(0.25f);
+            for (; f + 4 <= frames; f += 4) {
+                float32x4x4_t ch = vld4q_f32(in + f * 4);
+                float32x4_t sum = vaddq_f32(vaddq_f32(ch.val[0], ch.val[1]), vaddq_f32(ch.val[2], ch.val[3]));
+                vst1q_f32(out + f, vmulq_f32(sum, quarter));
+            }
+        }
+        else if (channels % 4 == 0) {
+            const float scale = 1.0f / static_cast<float>(channels);
+            for (; f < frames; ++f) {
+                const float* frame = in + f * channels;
+                float32x4_t sum = vld1q_f32(frame);
+                for (size_t ch = 4; ch < channels; ch += 4) {
+                    sum = vaddq_f32(sum, vld1q_f32(frame + ch));
+                }
+                out[f] = vaddvq_f32(sum) * scale;
+            }
+        }
+        DownmixScalar(in + f * channels, frames - f, channels, out + f);
+    }
+
+    // Same four-frame transpose scheme as SSE2Ops::Split, with vld2/vld4 for
+    // the layouts NEON can deinterleave directly
+    AUDIOKERNELS_INLINE static void Split(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+        float32x4_t acc[MAX_CHANNELS];
+        for (size_t ch = 0; ch < channels; ++ch) {
+            acc[ch] = vdupq_n_f32(0.0f);
+        }
+
+        const float32x4_t scale = vdupq_n_f32(1.0f / static_cast<float>(channels));
+        size_t f = 0;
+        if (channels == 2) {
+            for (; f + 4 <= frames; f += 4) {
+                float32x4x2_t lr = vld2q_f32(in + f * 2);
+                acc[0] = vmlaq_f32(acc[0], lr.val[0], lr.val[0]);
+                acc[1] = vmlaq_f32(acc[1], lr.val[1], lr.val[1]);
+                vst1q_f32(mono + f, vmulq_f32(vaddq_f32(lr.val[0], lr.val[1]), scale));
+            }
+        }
+        else if (channels == 4) {
+            for (; f + 4 <= frames; f += 4) {
+                float32x4x4_t c = vld4q_f32(in + f * 4);
+                for (size_t ch = 0; ch < 4; ++ch) {
+                    acc[ch] = vmlaq_f32(acc[ch], c.val[ch], c.val[ch]);
+                }
+                float32x4_t sum = vaddq_f32(vaddq_f32(c.val[0], c.val[1]), vaddq_f32(c.val[2], c.val[3]));
+                vst1q_f32(mono + f, vmulq_f32(sum, scale));
+            }
+        }
+        else {
+            for (; f + 4 <= frames; f += 4) {
+                const float* f0 = in + f * channels;
+                const float* f1 = f0 + channels;
+                const float* f2 = f1 + channels;
+                const float* f3 = f2 + channels;
+                float32x4_t sum = vdupq_n_f32(0.0f);
+
+                size_t ch = 0;
+                for (; ch + 4 <= channels; ch += 4) {
+                    float32x4x2_t t01 = vtrnq_f32(vld1q_f32(f0 + ch), vld1q_f32(f1 + ch));
+                    float32x4x2_t t23 = vtrnq_f32(vld1q_f32(f2 + ch), vld1q_f32(f3 + ch));
+                    float32x4_t c0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+                    float32x4_t c1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+                    float32x4_t c2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+                    float32x4_t c3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+                    acc[ch] = vmlaq_f32(acc[ch], c0, c0);
+                    acc[ch + 1] = vmlaq_f32(acc[ch + 1], c1, c1);
+                    acc[ch + 2] = vmlaq_f32(acc[ch + 2], c2, c2);
+                    acc[ch + 3] = vmlaq_f32(acc[ch + 3], c3, c3);
+                    sum = vaddq_f32(sum, vaddq_f32(vaddq_f32(c0, c1), vaddq_f32(c2, c3)));
+                }
+                if (ch + 2 <= channels) {
+                    float32x4x2_t xy = vuzpq_f32(vcombine_f32(vld1_f32(f0 + ch), vld1_f32(f1 + ch)),
+                                                 vcombine_f32(vld1_f32(f2 + ch), vld1_f32(f3 + ch)));
+                    acc[ch] = vmlaq_f32(acc[ch], xy.val[0], xy.val[0]);
+                    acc[ch + 1] = vmlaq_f32(acc[ch + 1], xy.val[1], xy.val[1]);
+                    sum = vaddq_f32(sum, vaddq_f32(xy.val[0], xy.val[1]));
+                    ch += 2;
+                }
+                if (ch < channels) {
+                    const float gathered[4] = { f0[ch], f1[ch], f2[ch], f3[ch] };
+                    float32x4_t x = vld1q_f32(gathered);
+                    acc[ch] = vmlaq_f32(acc[ch], x, x);
+                    sum = vaddq_f32(sum, x);
+                }
+                vst1q_f32(mono + f, vmulq_f32(sum, scale));
+            }
+        }
+
+        float tail[MAX_CHANNELS];
+        SplitScalar(in + f * channels, frames - f, channels, mono + f, tail);
+        for (size_t ch = 0; ch < channels; ++ch) {
+            channelSumSquares[ch] = vaddvq_f32(acc[ch]) + tail[ch];
+        }
+    }
+
+    static void SumSquaresPeak(const float* mono, size_t count, float& sumSquares, float& peak) {
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        float32x4_t maxAbs = vdupq_n_f32(0.0f);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            float32x4_t v = vld1q_f32(mono + i);
+            sum = vmlaq_f32(sum, v, v);
+            maxAbs = vmaxq_f32(maxAbs, vabsq_f32(v));
+        }
+
+        float tailSum = 0.0f;
+        float tailPeak = 0.0f;
+        SumSquaresPeakScalar(mono + i, count - i, tailSum, tailPeak);
+
+        sumSquares = vaddvq_f32(sum) + tailSum;
+        peak = std::max(vmaxvq_f32(maxAbs), tailPeak);
+    }
+
+    template <size_t Channels>
+    static void SplitLayout(const float* in, size_t frames, size_t channels, float* mono, float* channelSumSquares) {
+        Split(in, frames, Channels ? Channels : channels, mono, channelSumSquares);
+    }
+};
+
+#endif // AUDIOKERNELS_NEON
+
+// Channels fixes the layout at compile time: the layout branches fold away,
+// the per-channel loops unroll and their accumulators stay in registers.
+// 0 is the generic kernel, which takes the channel count as passed.
+template <typename Ops, size_t Channels>
+void Analyze(const float* samples, size_t frames, size_t channelCount,
+             BlockStats& stats, float* monoOut) {
+    const size_t channels = Channels ? Channels : channelCount;
+    alignas(32) float scratch[CHUNK_FRAMES];
+
+    for (size_t start = 0; start < frames; start += CHUNK_FRAMES) {
+        const size_t count = std::min(CHUNK_FRAMES, frames - start);
+        const float* in = samples + start * channels;
+        float* dest = monoOut ? monoOut + start : scratch;
+
+        // Mono input is analysed in place unless the caller wants a copy
+        const float* mono = in;
+        if (channels > MAX_CHANNELS) {
+            Ops::Downmix(in, count, channels, dest);
+            mono = dest;
+        }
+        else if (channels > 1) {
+            float channelSums[MAX_CHANNELS];
+            Ops::template SplitLayout<Channels>(in, count, channels, dest, channelSums);
+            for (size_t ch = 0; ch < channels; ++ch) {
+                stats.channelSumSquares[ch] += channelSums[ch];
+            }
+            mono = dest;
+        }
+        else if (monoOut) {
+            std::memcpy(dest, in, count * sizeof(float));
+        }
+
+        float sumSquares = 0.0f;
+        float peak = 0.0f;
+        Ops::SumSquaresPeak(mono, count, sumSquares, peak);
+        stats.sumSquares += sumSquares;
+        stats.peak = std::max(stats.peak, peak);
+        if (channels == 1) {
+            stats.channelSumSquares[0] += sumSquares;
+        }
+    }
+
+    stats.frames += frames;
+}
+
+// Mono, stereo, 5.1 and 7.1 have their own kernels
+template <typename Ops>
+AnalyzeFn SelectLayout(size_t channels) {
+    switch (channels) {
+        case 1: return &Analyze<Ops, 1>;
+        case 2: return &Analyze<Ops, 2>;
+        case 6: return &Analyze<Ops, 6>;
+        case 8: return &Analyze<Ops, 8>;
+        default: return &Analyze<Ops, 0>;
+    }
+}
+
+InstructionSet DetectInstructionSet() {
+#if AUDIOKERNELS_X86
+    if (CpuSupportsAVX2()) {
+        return InstructionSet::AVX2;
+    }
+    return InstructionSet::SSE2;
+#elif AUDIOKERNELS_NEON
+    return InstructionSet::NEON;
+#else
+    return InstructionSet::Scalar;
+#endif
+}
+
+} // namespace
+
+AnalyzeFn GetAnalyzeKernel(InstructionSet isa, size_t channels) {
+    switch (isa) {
+        case InstructionSet::Scalar:
+            return SelectLayout<ScalarOps>(channels);
+#if AUDIOKERNELS_X86
+        case InstructionSet::SSE2:
+            return SelectLayout<SSE2Ops>(channels);
+        case InstructionSet::AVX2:
+            return CpuSupportsAVX2() ? SelectLayout<AVX2Ops>(channels) : nullptr;
+#endif
+#if AUDIOKERNELS_NEON
+        case InstructionSet::NEON:
+            return SelectLayout<NEONOps>(channels);
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+AnalyzeFn GetAnalyzeKernel(InstructionSet isa) {
+    return GetAnalyzeKernel(isa, 0);
+}
+
+AnalyzeFn GetAnalyzeKernel(size_t channels) {
+    return GetAnalyzeKernel(GetActiveInstructionSet(), channels);
+}
+
+AnalyzeFn GetAnalyzeKernel() {
+    static const AnalyzeFn kernel = GetAnalyzeKernel(GetActiveInstructionSet());
+    return kernel;
+}
+
+InstructionSet GetActiveInstructionSet() {
+    static const InstructionSet isa = DetectInstructionSet();
+    return isa;
+}
+
+const char* GetInstructionSetName(InstructionSet isa) {
+    switch (isa) {
+        case InstructionSet::Scalar: return "Scalar";
+        case InstructionSet::SSE2: return "SSE2";
+        case InstructionSet::AVX2: return "AVX2";
+        case InstructionSet::NEON: return "NEON";
+        default: return "Unknown";
+    }
+}
+
+} // namespace AudioKernels
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Single-pass analysis kernels used by AudioProcessor.
+// A kernel walks the interleaved buffer once: it deinterleaves in registers,
+// accumulating per-channel energy and the mono downmix together, then takes
+// RMS/peak of the downmixed chunk while it is still in L1, optionally handing
+// the mono signal on to the spectral analyzer. Kernels never allocate; the
+// fastest variant supported by the running CPU is selected once, on first use.
+// Common layouts (mono, stereo, 5.1, 7.1) also get kernels compiled for their
+// channel count, picked once per stream, so the per-frame channel loops are
+// unrolled and branch-free.
+namespace AudioKernels {
+
+    // Layouts up to 7.1 get per-channel stats; wider ones are only downmixed
+    constexpr size_t MAX_CHANNELS = 8;
+
+    enum class InstructionSet {
+        Scalar,
+        SSE2,
+        AVX2,
+        NEON
+    };
+
+    // Raw accumulators; AudioProcessor turns these into AudioFeatures
+    struct BlockStats {
+        double sumSquares = 0.0;    // Sum of squared mono samples
+        float peak = 0.0f;          // Largest absolute mono sample
+        size_t frames = 0;          // Frames accumulated so far
+        double channelSumSquares[MAX_CHANNELS] = {};   // Per input channel, if channels <= MAX_CHANNELS
+    };
+
+    // samples:   interleaved input, frames * channels floats
+    // monoOut:   optional, receives the downmixed signal (frames floats)
+    using AnalyzeFn = void (*)(const float* samples, size_t frames, size_t channels,
+                               BlockStats& stats, float* monoOut);
+
+    // Best kernel for this CPU, for any channel count
+    AnalyzeFn GetAnalyzeKernel();
+
+    // Specific kernel, or nullptr if the CPU/build does not support it
+    AnalyzeFn GetAnalyzeKernel(InstructionSet isa);
+
+    // Best / specific kernel for one channel count. Counts without a layout
+    // kernel (and 0) get the generic one. A layout kernel ignores its channels
+    // argument, so it must only be called with the count it was picked for.
+    AnalyzeFn GetAnalyzeKernel(size_t channels);
+    AnalyzeFn GetAnalyzeKernel(InstructionSet isa, size_t channels);
+
+    InstructionSet GetActiveInstructionSet();
+    const char* GetInstructionSetName(InstructionSet isa);
+}
@@ -0,0 +1,180 @@
+#include "AudioPipeline.h"
+#include <iostream>
+
+namespace {
+// A capture gap this many packet periods long is the source pausing (WASAPI
+// loopback delivers nothing while the system is silent), not an underrun
+constexpr int PAUSE_PERIODS = 4;
+}
+
+AudioPipeline::AudioPipeline(size_t slotCount, size_t samplesPerSlot)
+    : m_ring(slotCount, samplesPerSlot)
+    , m_isRunning(false)
+    , m_shouldStop(false)
+    , m_dataSignal(0)
+    , m_spaceSignal(0)
+    , m_blocksQueued(0)
+    , m_blocksProcessed(0)
+    , m_underruns(0)
+    , m_maxDepth(0)
+{
+}
+
+AudioPipeline::~AudioPipeline() {
+    Stop();
+}
+
+void AudioPipeline::SetCallback(BlockCallback callback) {
+    m_callback = callback;
+}
+
+bool AudioPipeline::Start() {
+    if (m_isRunning) {
+        return true;
+    }
+
+    m_ring.Reset();
+    m_shouldStop = false;
+    m_isRunning = true;
+    m_consumerThread = std::thread(&AudioPipeline::ConsumerThread, this);
+    return true;
+}
+
+void AudioPipeline::Stop() {
+    if (!m_isRunning) {
+        return;
+    }
+
+    m_shouldStop = true;
+    m_dataSignal.fetch_add(1, std::memory_order_release);
+    m_dataSignal.notify_one();
+    m_spaceSignal.fetch_add(1, std::memory_order_release);
+    m_spaceSignal.notify_one();
+
+    if (m_consumerThread.joinable()) {
+        m_consumerThread.join();
+    }
+
+    m_isRunning = false;
+}
+
+bool AudioPipeline::Push(const float* samples, size_t sampleCount, size_t channels, BlockTimestamps::Clock::time_point captureTime) {
+    BlockTimestamps timestamps;
+    timestamps.capture = captureTime;
+    timestamps.queued = BlockTimestamps::Clock::now();
+    if (!m_ring.Push(samples, sampleCount, channels, timestamps)) {
+        return false;
+    }
+
+    m_blocksQueued.fetch_add(1, std::memory_order_relaxed);
+
+    // Producer is the only writer of the high-water mark
+    size_t depth = m_ring.GetDepth();
+    if (depth > m_maxDepth.load(std::memory_order_relaxed)) {
+        m_maxDepth.store(depth, std::memory_order_relaxed);
+    }
+
+    m_dataSignal.fetch_add(1, std::memory_order_release);
+    m_dataSignal.notify_one();
+    return true;
+}
+
+bool AudioPipeline::PushWait(const float* samples, size_t sampleCount, size_t channels, BlockTimestamps::Clock::time_point captureTime) {
+    for (;;) {
+        // Same pattern as the consumer: sample the signal before checking, so
+        // a pop (or Stop) in between always wakes the wait
+        uint32_t signal = m_spaceSignal.load(std::memory_order_acquire);
+        if (m_ring.CanPush(sampleCount, channels)) {
+            break;
+        }
+        if (m_shouldStop || !m_isRunning) {
+            return false;
+        }
+        m_spaceSignal.wait(signal, std::memory_order_acquire);
+    }
+    return Push(samples, sampleCount, channels, captureTime);
+}
+
+AudioPipeline::Stats AudioPipeline::GetStats() const {
+    Stats stats;
+    stats.blocksQueued = m_blocksQueued.load(std::memory_order_relaxed);
+    stats.blocksProcessed = m_blocksProcessed.load(std::memory_order_relaxed);
+    stats.overflows = m_ring.GetOverflowCount();
+    stats.underruns = m_underruns.load(std::memory_order_relaxed);
+    stats.maxDepth = m_maxDepth.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioPipeline::ConsumerThread() {
+    using Clock = BlockTimestamps::Clock;
+
+    // Blocks already queued when Stop is called are still delivered, so a
+    // finite source is never cut short
+    Clock::time_point lastCapture{};
+    Clock::duration packetPeriod{};
+    Clock::time_point idleStart{};      // When the ring last ran empty, if it has since
+    bool packetStart = true;            // The next slot starts a packet
+    for (;;) {
+        // Sample the signal before checking the ring so a push that lands in
+        // between always wakes the wait below
+        uint32_t signal = m_dataSignal.load(std::memory_order_acquire);
+
+        AudioFrameRing::Block block;
+        if (m_ring.Front(block)) {
+            block.timestamps.dequeued = Clock::now();
+            if (packetStart) {
+                // Judged on the capture clock, once per packet. Steady state,
+                // packets are captured one period apart and the wait for the
+                // next is under a period. A gap of a few periods lost packets
+                // (an underrun); a longer one is the source pausing, and the
+                // period is learned again after it. A packet captured on time
+                // but delivered over 1.5 periods (margin for jitter) after the
+                // ring ran empty came late: also an underrun.
+                const Clock::duration gap = block.timestamps.capture - lastCapture;
+                const Clock::duration waited = idleStart != Clock::time_point{} ? block.timestamps.dequeued - idleStart
+                                                                                 : Clock::duration::zero();
+                if (lastCapture == Clock::time_point{} || gap <= Clock::duration::zero()) {
+                    // First packet, or no usable capture clock
+                } else if (packetPeriod == Clock::duration::zero()) {
+                    packetPeriod = gap;
+                } else if (gap > packetPeriod * PAUSE_PERIODS) {
+                    packetPeriod = Clock::duration::zero();
+                } else if (gap > packetPeriod * 3 / 2 || waited > packetPeriod * 3 / 2) {
+                    m_underruns.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    packetPeriod = gap;
+                }
+                lastCapture = block.timestamps.capture;
+                idleStart = Clock::time_point{};
+            }
+
+            try {
+                if (m_callback) {
+                    m_callback(block.samples, block.sampleCount, block.channels, block.timestamps);
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Exception in audio pipeline callback: " << e.what() << std::endl;
+            }
+
+            m_ring.Pop();
+            m_spaceSignal.fetch_add(1, std::memory_order_release);
+            m_spaceSignal.notify_one();
+            packetStart = block.packetEnd;
+            if (block.packetEnd) {
+                m_blocksProcessed.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        // Ring is empty: sleep until the producer signals more data. Stop bumps
+        // the signal after setting the flag, so re-check it against this sample.
+        if (m_shouldStop) {
+            break;
+        }
+        if (idleStart == Clock::time_point{}) {
+            idleStart = Clock::now();
+        }
+        m_dataSignal.wait(signal, std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include "AudioFrameRing.h"
+#include "LatencyTracker.h"
+
+// Decouples audio capture from analysis/haptics.
+// The capture thread pushes packets into an SPSC ring (wait-free, never blocks on
+// the consumer) and a dedicated consumer thread runs the processing callback.
+// A slow callback can only cause dropped packets, counted as overflows; it can
+// never hold up the capture device.
+class AudioPipeline {
+public:
+    // timestamps has capture, queued and dequeued set
+    using BlockCallback = std::function<void(const float* samples, size_t sampleCount, size_t channels, const BlockTimestamps& timestamps)>;
+
+    struct Stats {
+        // Packets, however many ring slots (callback calls) each one spans
+        uint64_t blocksQueued = 0;     // Accepted by Push
+        uint64_t blocksProcessed = 0;  // Handed to the callback in full
+        uint64_t overflows = 0;        // Dropped because the ring was full
+        uint64_t underruns = 0;        // Came late, or after a few lost ones (see ConsumerThread)
+        size_t maxDepth = 0;           // High-water mark of queued slots
+    };
+
+    AudioPipeline(size_t slotCount = 64, size_t samplesPerSlot = 4096);
+    ~AudioPipeline();
+
+    AudioPipeline(const AudioPipeline&) = delete;
+    AudioPipeline& operator=(const AudioPipeline&) = delete;
+
+    // Must be called while stopped
+    void SetCallback(BlockCallback callback);
+
+    bool Start();
+    void Stop();    // Delivers blocks already queued, then joins the consumer
+    bool IsRunning() const { return m_isRunning; }
+
+    // Producer side, called from the capture thread. captureTime is when the
+    // packet's first frame was captured; the queue time is stamped here.
+    bool Push(const float* samples, size_t sampleCount, size_t channels, BlockTimestamps::Clock::time_point captureTime);
+
+    // Lossless variant for sources that are not tied to a device clock (file
+    // playback): sleeps until the consumer frees space instead of dropping.
+    // Returns false if the pipeline is stopped while waiting.
+    bool PushWait(const float* samples, size_t sampleCount, size_t channels, BlockTimestamps::Clock::time_point captureTime);
+
+    Stats GetStats() const;
+
+private:
+    void ConsumerThread();
+
+    AudioFrameRing m_ring;
+    BlockCallback m_callback;
+
+    std::thread m_consumerThread;
+    std::atomic<bool> m_isRunning;
+    std::atomic<bool> m_shouldStop;
+
+    // Bumped on every push so the consumer can block in atomic::wait, and on
+    // every pop so PushWait can
+    std::atomic<uint32_t> m_dataSignal;
+    std::atomic<uint32_t> m_spaceSignal;
+
+    // Counters
+    std::atomic<uint64_t> m_blocksQueued;
+    std::atomic<uint64_t> m_blocksProcessed;
+    std::atomic<uint64_t> m_underruns;
+    std::atomic<size_t> m_maxDepth;
+};
@@ -3,18 +3,23 @@
 #include <iostream>
 
 AudioProcessor::AudioProcessor()
-    : m_sampleRate(44100)
-    , m_sensitivity(4.0f)   // Default to 4x sensitivity
-    , m_bassCutoff(0.1f)    // ~4.4kHz at 44.1kHz
-    , m_trebleCutoff(0.3f)  // ~13.2kHz at 44.1kHz
-    , m_bassFilterState(0.0f)
-    , m_trebleFilterPrevSample(0.0f)
-    , m_trebleFilterPrevOutput(0.0f)
-    , m_historyIndex(0)
+    : m_analyzeKernel(AudioKernels::GetAnalyzeKernel())
+    , m_kernelChannels(0)
+    , m_sampleRate(44100)
+    , m_sensitivity(DEFAULT_SENSITIVITY)
+    , m_autoGain(GAIN_CHANNELS)
+    , m_channelMask(0)
+    , m_roleChannels(0)
+    , m_channelRoles{}
+    , m_decimatedAnalysis(false)
+    , m_analysisTargetRate(2000)
+    , m_onsetLagFrames(0.0f)
+    , m_trendSmoothingSeconds(DEFAULT_TREND_SMOOTHING)
 {
-    m_volumeHistory.resize(HISTORY_SIZE, 0.0f);
-    m_bassHistory.resize(HISTORY_SIZE, 0.0f);
-    m_trebleHistory.resize(HISTORY_SIZE, 0.0f);
+    m_mono.resize(MONO_CHUNK_FRAMES, 0.0f);
+    m_decimated.resize(MONO_CHUNK_FRAMES / 2 + 1, 0.0f);
+    ConfigureAnalysis();
+    m_autoGain.Reset(DEFAULT_SENSITIVITY);
 }
 
 AudioProcessor::~AudioProcessor() = default;
@@ -22,59 +27,253 @@ AudioProcessor::~AudioProcessor() = default;
 void AudioProcessor::SetSampleRate(uint32_t sampleRate) {
     m_sampleRate = sampleRate;
     
-    // Reset filter states when sample rate changes
-    m_bassFilterState = 0.0f;
-    m_trebleFilterPrevSample = 0.0f;
-    m_trebleFilterPrevOutput = 0.0f;
+    // Band edges are in Hz, so the bin mapping depends on the rate
+    ConfigureAnalysis();
+    m_autoGain.Reset(DEFAULT_SENSITIVITY);
+    m_volumeHistory.Reset();
+    m_bassHistory.Reset();
+    m_midrangeHistory.Reset();
+    m_trebleHistory.Reset();
 }
 
 void AudioProcessor::SetFrequencyBands(float bassLimit, float trebleLimit) {
-    // Convert Hz to normalized frequency (0-1 where 1 = Nyquist frequency)
-    m_bassCutoff = std::clamp(bassLimit / (m_sampleRate * 0.5f), 0.01f, 0.9f);
-    m_trebleCutoff = std::clamp(trebleLimit / (m_sampleRate * 0.5f), 0.01f, 0.9f);
+    m_spectralSettings.bassCutoff = std::max(bassLimit, 1.0f);
+    m_spectralSettings.trebleCutoff = std::max(trebleLimit, m_spectralSettings.bassCutoff);
+    ConfigureAnalysis();
 }
 
-AudioProcessor::AudioFeatures AudioProcessor::ProcessAudio(const float* samples, size_t sampleCount, size_t channels) {
-    if (!samples || sampleCount == 0) {
-        return {};
+void AudioProcessor::SetSpectralSettings(const SpectralAnalyzer::Settings& settings) {
+    m_spectralSettings = settings;
+    ConfigureAnalysis();
+}
+
+void AudioProcessor::SetOnsetSettings(const OnsetDetector::Settings& settings) {
+    const float hopSeconds = static_cast<float>(m_spectrum.GetHopSize()) / static_cast<float>(m_spectrum.GetSampleRate());
+    m_onsets.Configure(hopSeconds, settings);
+}
+
+void AudioProcessor::SetChannelMask(uint32_t channelMask) {
+    m_channelMask = channelMask;
+    m_roleChannels = 0;
+}
+
+void AudioProcessor::UpdateChannelRoles(size_t channels) {
+    // SPEAKER_* bits from ksmedia.h
+    constexpr uint32_t LEFT_SPEAKERS = 0x1 | 0x10 | 0x40 | 0x200 | 0x1000 | 0x8000;      // FL, BL, FLC, SL, TFL, TBL
+    constexpr uint32_t RIGHT_SPEAKERS = 0x2 | 0x20 | 0x80 | 0x400 | 0x4000 | 0x20000;    // FR, BR, FRC, SR, TFR, TBR
+    constexpr uint32_t LFE_SPEAKER = 0x8;
+
+    uint32_t mask = m_channelMask;
+    if (mask == 0) {
+        // KSAUDIO_SPEAKER_* defaults: mono, stereo, 3.0, quad, 5.0, 5.1, 6.1, 7.1 surround
+        static const uint32_t defaults[MAX_CHANNELS] = { 0x4, 0x3, 0x7, 0x33, 0x37, 0x3F, 0x13F, 0x63F };
+        mask = defaults[channels - 1];
     }
 
-    // Convert to mono if stereo by averaging channels
-    std::vector<float> monoSamples;
-    if (channels > 1) {
-        monoSamples.reserve(sampleCount / channels);
-        for (size_t i = 0; i < sampleCount; i += channels) {
-            float sum = 0.0f;
-            for (size_t ch = 0; ch < channels && i + ch < sampleCount; ++ch) {
-                sum += samples[i + ch];
-            }
-            monoSamples.push_back(sum / static_cast<float>(channels));
+    // Channels take the set bits of the mask in order; any beyond them are centred
+    for (size_t ch = 0; ch < channels; ++ch) {
+        const uint32_t speaker = mask & (~mask + 1);
+        mask &= mask - 1;
+        if (speaker & LEFT_SPEAKERS) {
+            m_channelRoles[ch] = ChannelRole::Left;
+        } else if (speaker & RIGHT_SPEAKERS) {
+            m_channelRoles[ch] = ChannelRole::Right;
+        } else if (speaker & LFE_SPEAKER) {
+            m_channelRoles[ch] = ChannelRole::Lfe;
+        } else {
+            m_channelRoles[ch] = ChannelRole::Centre;
         }
+    }
+    m_roleChannels = channels;
+}
+
+void AudioProcessor::SetDecimatedAnalysis(bool enabled, uint32_t targetRate) {
+    m_decimatedAnalysis = enabled;
+    m_analysisTargetRate = std::max<uint32_t>(targetRate, 1);
+    ConfigureAnalysis();
+}
+
+void AudioProcessor::ConfigureAnalysis() {
+    if (!m_decimatedAnalysis) {
+        m_decimator.Configure(m_sampleRate, m_sampleRate, MONO_CHUNK_FRAMES);
+        m_spectrum.Configure(m_sampleRate, m_spectralSettings);
+        m_spectralSettings = m_spectrum.GetSettings();
     } else {
-        monoSamples.assign(samples, samples + sampleCount);
+        m_decimator.Configure(m_sampleRate, m_analysisTargetRate, MONO_CHUNK_FRAMES);
+
+        // Same window duration at the lower rate, but never coarser than 64
+        // points (~47 Hz bins at 3 kHz), which high device rates would otherwise hit
+        size_t fftSize = 8;
+        while (fftSize < m_spectralSettings.fftSize) {
+            fftSize <<= 1;
+        }
+        SpectralAnalyzer::Settings settings = m_spectralSettings;
+        settings.fftSize = std::max<size_t>(fftSize / m_decimator.GetFactor(), 64);
+        m_spectrum.Configure(m_decimator.GetOutputRate(), settings);
+    }
+
+    // A frame reports an onset once it is well inside the Hann window, i.e.
+    // around the window's centre: half the FFT before the completing sample
+    const size_t factor = m_decimatedAnalysis ? m_decimator.GetFactor() : 1;
+    m_onsetLagFrames = static_cast<float>(m_spectrum.GetSettings().fftSize / 2 * factor);
+    SetOnsetSettings(m_onsets.GetSettings());
+}
+
+void AudioProcessor::PushSpectrum(const float* mono, size_t count, size_t firstFrame, size_t frameStep, AudioFeatures& features) {
+    // Hop-sized pushes, so every spectrum frame (not just the block's last)
+    // reaches the onset detector
+    size_t offset = 0;
+    while (offset < count) {
+        const size_t take = std::min(count - offset, m_spectrum.GetSamplesUntilHop());
+        offset += take;
+        if (!m_spectrum.Push(mono + offset - take, take)) {
+            continue;
+        }
+
+        const float strength = m_onsets.Process(m_spectrum.GetBands(), m_spectrum.GetBandCount());
+        if (strength > 0.0f && features.onsetCount < MAX_ONSETS) {
+            const float frame = static_cast<float>(firstFrame + offset * frameStep) - m_onsetLagFrames;
+            features.onsets[features.onsetCount].time = frame / static_cast<float>(m_sampleRate);
+            features.onsets[features.onsetCount].strength = strength;
+            ++features.onsetCount;
+        }
+    }
+}
+
+AudioProcessor::AudioFeatures AudioProcessor::ProcessAudio(const float* samples, size_t sampleCount, size_t channels) {
+    if (!samples || sampleCount == 0 || channels == 0) {
+        return {};
+    }
+
+    size_t frameCount = sampleCount / channels;
+    if (frameCount == 0) {
+        return {};
     }
 
     AudioFeatures features = {};
+
+    // Layout kernels are picked once per stream, not per block
+    if (channels != m_kernelChannels) {
+        m_analyzeKernel = AudioKernels::GetAnalyzeKernel(channels);
+        m_kernelChannels = channels;
+    }
+
+    // One sweep for downmix and RMS/peak; the mono chunk goes straight on to
+    // the spectral analyzer (decimated first if enabled), which runs one FFT
+    // and one onset-detector step per completed hop
+    AudioKernels::BlockStats stats;
+    for (size_t start = 0; start < frameCount; start += MONO_CHUNK_FRAMES) {
+        const size_t count = std::min(MONO_CHUNK_FRAMES, frameCount - start);
+        m_analyzeKernel(samples + start * channels, count, channels, stats, m_mono.data());
+        if (m_decimatedAnalysis) {
+            const size_t decimated = m_decimator.Process(m_mono.data(), count, m_decimated.data());
+            PushSpectrum(m_decimated.data(), decimated, start, m_decimator.GetFactor(), features);
+        } else {
+            PushSpectrum(m_mono.data(), count, start, 1, features);
+        }
+    }
     
     // Calculate basic audio features
-    features.volume = CalculateRMS(monoSamples.data(), monoSamples.size());
-    features.peak = CalculatePeak(monoSamples.data(), monoSamples.size());
-    features.bass = CalculateBassEnergy(monoSamples.data(), monoSamples.size());
-    features.treble = CalculateTrebleEnergy(monoSamples.data(), monoSamples.size());
-    
-    // Calculate midrange as total energy minus bass and treble
-    features.midrange = std::max(0.0f, features.volume - (features.bass + features.treble) * 0.5f);
+    const double invFrames = 1.0 / static_cast<double>(frameCount);
+    const float blockSeconds = static_cast<float>(frameCount) / static_cast<float>(m_sampleRate);
+    features.volume = static_cast<float>(std::sqrt(stats.sumSquares * invFrames));
+    features.peak = stats.peak;
+
+    // Band levels from the latest spectrum frame
+    features.bass = m_spectrum.GetBass();
+    features.midrange = m_spectrum.GetMidrange();
+    features.treble = m_spectrum.GetTreble();
+    if (m_decimatedAnalysis) {
+        // Treble is whatever the decimator removed, over this block
+        features.treble = static_cast<float>(std::sqrt(m_decimator.ConsumeHighBandPower()));
+    }
+    features.bandCount = static_cast<uint32_t>(m_spectrum.GetBandCount());
+    for (uint32_t b = 0; b < features.bandCount; ++b) {
+        features.bands[b] = m_spectrum.GetBands()[b];
+    }
     
+    // Spatial features from per-channel energy. A side level is the RMS over
+    // that side's channels plus the centre ones; LFE stays out of both.
+    if (channels <= MAX_CHANNELS) {
+        if (m_roleChannels != channels) {
+            UpdateChannelRoles(channels);
+        }
+
+        double sidePower[2] = {};
+        size_t sideCount[2] = {};
+        features.channelCount = static_cast<uint32_t>(channels);
+        for (size_t ch = 0; ch < channels; ++ch) {
+            const double meanSquare = stats.channelSumSquares[ch] * invFrames;
+            const float level = static_cast<float>(std::sqrt(meanSquare));
+            features.channelLevels[ch] = level;
+
+            switch (m_channelRoles[ch]) {
+                case ChannelRole::Left:
+                    sidePower[0] += meanSquare;
+                    ++sideCount[0];
+                    break;
+                case ChannelRole::Right:
+                    sidePower[1] += meanSquare;
+                    ++sideCount[1];
+                    break;
+                case ChannelRole::Centre:
+                    sidePower[0] += meanSquare;
+                    sidePower[1] += meanSquare;
+                    ++sideCount[0];
+                    ++sideCount[1];
+                    break;
+                case ChannelRole::Lfe:
+                    features.lfe = std::max(features.lfe, level);
+                    break;
+            }
+        }
+
+        features.left = sideCount[0] ? static_cast<float>(std::sqrt(sidePower[0] / sideCount[0])) : 0.0f;
+        features.right = sideCount[1] ? static_cast<float>(std::sqrt(sidePower[1] / sideCount[1])) : 0.0f;
+        const float sides = features.left + features.right;
+        features.balance = sides > 1e-6f ? (features.right - features.left) / sides : 0.0f;
+    }
+
     // Dynamic range: difference between peak and RMS
     features.dynamic_range = features.peak - features.volume;
-    
-    // Apply sensitivity scaling
-    features.volume *= m_sensitivity;
-    features.bass *= m_sensitivity;
-    features.midrange *= m_sensitivity;
-    features.treble *= m_sensitivity;
-    features.peak *= m_sensitivity;
-    features.dynamic_range *= m_sensitivity;
+
+    // Gain per feature: the automatic gain trimmed by the sensitivity, or the
+    // sensitivity alone
+    float gains[GAIN_CHANNELS];
+    const size_t gainCount = GAIN_FIRST_BAND + features.bandCount;
+    if (m_autoGain.GetSettings().enabled) {
+        float levels[GAIN_CHANNELS];
+        levels[GAIN_VOLUME] = features.volume;
+        levels[GAIN_BASS] = features.bass;
+        levels[GAIN_MIDRANGE] = features.midrange;
+        levels[GAIN_TREBLE] = features.treble;
+        levels[GAIN_LFE] = features.lfe;
+        std::copy(features.bands, features.bands + features.bandCount, levels + GAIN_FIRST_BAND);
+        m_autoGain.Process(levels, gainCount, blockSeconds, gains);
+
+        const float trim = m_sensitivity / DEFAULT_SENSITIVITY;
+        for (size_t i = 0; i < gainCount; ++i) {
+            gains[i] *= trim;
+        }
+    } else {
+        std::fill(gains, gains + gainCount, m_sensitivity);
+    }
+
+    features.volume *= gains[GAIN_VOLUME];
+    features.bass *= gains[GAIN_BASS];
+    features.midrange *= gains[GAIN_MIDRANGE];
+    features.treble *= gains[GAIN_TREBLE];
+    features.peak *= gains[GAIN_VOLUME];
+    features.dynamic_range *= gains[GAIN_VOLUME];
+    features.left *= gains[GAIN_VOLUME];
+    features.right *= gains[GAIN_VOLUME];
+    features.lfe *= gains[GAIN_LFE];
+    for (uint32_t b = 0; b < features.bandCount; ++b) {
+        features.bands[b] = std::clamp(features.bands[b] * gains[GAIN_FIRST_BAND + b], 0.0f, 1.0f);
+    }
+    for (uint32_t ch = 0; ch < features.channelCount; ++ch) {
+        features.channelLevels[ch] = std::clamp(features.channelLevels[ch] * gains[GAIN_VOLUME], 0.0f, 1.0f);
+    }
     
     // Clamp all values to [0, 1]
     features.volume = std::clamp(features.volume, 0.0f, 1.0f);
@@ -83,77 +282,16 @@ AudioProcessor::AudioFeatures AudioProcessor::ProcessAudio(const float* samples,
     features.treble = std::clamp(features.treble, 0.0f, 1.0f);
     features.peak = std::clamp(features.peak, 0.0f, 1.0f);
     features.dynamic_range = std::clamp(features.dynamic_range, 0.0f, 1.0f);
+    features.left = std::clamp(features.left, 0.0f, 1.0f);
+    features.right = std::clamp(features.right, 0.0f, 1.0f);
+    features.lfe = std::clamp(features.lfe, 0.0f, 1.0f);
     
-    // Update history for smoothing
-    m_volumeHistory[m_historyIndex] = features.volume;
-    m_bassHistory[m_historyIndex] = features.bass;
-    m_trebleHistory[m_historyIndex] = features.treble;
-    m_historyIndex = (m_historyIndex + 1) % HISTORY_SIZE;
-    
-    return features;
-}
+    // Windowed statistics, O(1) per block
+    const float smoothing = m_trendSmoothingSeconds > 0.0f ? 1.0f - std::exp(-blockSeconds / m_trendSmoothingSeconds) : 1.0f;
+    features.volumeTrend = m_volumeHistory.Push(features.volume, smoothing, blockSeconds);
+    features.bassTrend = m_bassHistory.Push(features.bass, smoothing, blockSeconds);
+    features.midrangeTrend = m_midrangeHistory.Push(features.midrange, smoothing, blockSeconds);
+    features.trebleTrend = m_trebleHistory.Push(features.treble, smoothing, blockSeconds);
 
-float AudioProcessor::CalculateRMS(const float* samples, size_t count) {
-    if (count == 0) return 0.0f;
-    
-    float sum = 0.0f;
-    for (size_t i = 0; i < count; ++i) {
-        sum += samples[i] * samples[i];
-    }
-    return std::sqrt(sum / static_cast<float>(count));
-}
-
-float AudioProcessor::CalculatePeak(const float* samples, size_t count) {
-    if (count == 0) return 0.0f;
-    
-    float peak = 0.0f;
-    for (size_t i = 0; i < count; ++i) {
-        peak = std::max(peak, std::abs(samples[i]));
-    }
-    return peak;
-}
-
-float AudioProcessor::CalculateBassEnergy(const float* samples, size_t count) {
-    if (count == 0) return 0.0f;
-    
-    float energy = 0.0f;
-    
-    // Simple low-pass filter to isolate bass frequencies
-    for (size_t i = 0; i < count; ++i) {
-        float filtered = ApplyLowPass(samples[i], m_bassFilterState, m_bassCutoff);
-        energy += filtered * filtered;
-    }
-    
-    return std::sqrt(energy / static_cast<float>(count));
-}
-
-float AudioProcessor::CalculateTrebleEnergy(const float* samples, size_t count) {
-    if (count == 0) return 0.0f;
-    
-    float energy = 0.0f;
-    
-    // Simple high-pass filter to isolate treble frequencies
-    for (size_t i = 0; i < count; ++i) {
-        float filtered = ApplyHighPass(samples[i], m_trebleFilterPrevSample, 
-                                     m_trebleFilterPrevOutput, m_trebleCutoff);
-        energy += filtered * filtered;
-    }
-    
-    return std::sqrt(energy / static_cast<float>(count));
-}
-
-float AudioProcessor::ApplyLowPass(float sample, float& state, float cutoff) {
-    // Simple first-order low-pass filter
-    float alpha = cutoff;
-    state = alpha * sample + (1.0f - alpha) * state;
-    return state;
+    return features;
 }
-
-float AudioProcessor::ApplyHighPass(float sample, float& prevSample, float& prevOutput, float cutoff) {
-    // Simple first-order high-pass filter
-    float alpha = 1.0f - cutoff;
-    float output = alpha * (prevOutput + sample - prevSample);
-    prevSample = sample;
-    prevOutput = output;
-    return output;
-}
\ No newline at end of file
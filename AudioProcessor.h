@@ -3,9 +3,26 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include "AudioKernels.h"
+#include "AutoGain.h"
+#include "SpectralAnalyzer.h"
+#include "Decimator.h"
+#include "FeatureHistory.h"
+#include "OnsetDetector.h"
 
 class AudioProcessor {
 public:
+    static constexpr size_t MAX_BANDS = SpectralAnalyzer::MAX_BANDS;
+    static constexpr size_t MAX_CHANNELS = AudioKernels::MAX_CHANNELS;
+    static constexpr size_t MAX_ONSETS = 4;
+    static constexpr float DEFAULT_SENSITIVITY = 4.0f;
+
+    struct Onset {
+        float time;             // Seconds from the block's first frame (negative: began in an earlier block)
+        float strength;         // 0.0 to 1.0
+    };
+
     struct AudioFeatures {
         float volume;           // RMS volume (0.0 to 1.0)
         float bass;            // Low frequency energy (0.0 to 1.0)
@@ -13,6 +30,27 @@ public:
         float treble;          // High frequency energy (0.0 to 1.0)
         float peak;            // Peak amplitude (0.0 to 1.0)
         float dynamic_range;   // Dynamic range indicator (0.0 to 1.0)
+        float bands[MAX_BANDS]; // Log-spaced spectrum bands, low to high (0.0 to 1.0)
+        uint32_t bandCount;    // Valid entries in bands
+
+        // Spatial features (layouts up to MAX_CHANNELS; zero for wider ones)
+        float left;            // Left-side level (0.0 to 1.0); centre channels count for both sides
+        float right;           // Right-side level (0.0 to 1.0)
+        float balance;         // -1.0 (all left) to 1.0 (all right), 0 when centred or silent
+        float lfe;             // LFE channel level (0.0 to 1.0), 0 without an LFE channel
+        float channelLevels[MAX_CHANNELS]; // Per-channel RMS in input order (0.0 to 1.0)
+        uint32_t channelCount; // Valid entries in channelLevels
+
+        // Transients (beats, hits, impacts) detected in this block, oldest first
+        Onset onsets[MAX_ONSETS];
+        uint32_t onsetCount;   // Valid entries in onsets
+
+        // Statistics of the levels above over the last FeatureHistory::WINDOW
+        // blocks, this one included
+        FeatureHistory::Trend volumeTrend;
+        FeatureHistory::Trend bassTrend;
+        FeatureHistory::Trend midrangeTrend;
+        FeatureHistory::Trend trebleTrend;
     };
 
     AudioProcessor();
@@ -21,38 +59,104 @@ public:
     // Process audio samples and extract features for haptic feedback
     AudioFeatures ProcessAudio(const float* samples, size_t sampleCount, size_t channels);
 
-    // Configuration
+    // Configuration. A sample rate change starts a new stream: the automatic
+    // gain starts over from the default sensitivity, and the trends from empty.
     void SetSampleRate(uint32_t sampleRate);
+
+    // Fixed gain on every level. With automatic gain it trims the target
+    // instead: DEFAULT_SENSITIVITY aims each feature at the target level.
     void SetSensitivity(float sensitivity) { m_sensitivity = std::clamp(sensitivity, 0.1f, 6.0f); }
-    void SetFrequencyBands(float bassCutoff, float trebleCutoff);
+
+    // Per-feature loudness normalization (volume, bass, midrange, treble, LFE
+    // and each spectrum band) in place of the fixed sensitivity. Spatial
+    // levels, peak and dynamic range follow the volume gain so balance is
+    // kept. Safe to call mid-stream; the loudness estimates carry over.
+    void SetAutoGainSettings(const AutoGain::Settings& settings) { m_autoGain.SetSettings(settings); }
+    const AutoGain::Settings& GetAutoGainSettings() const { return m_autoGain.GetSettings(); }
+    void SetFrequencyBands(float bassCutoff, float trebleCutoff);   // Hz
+
+    // Speaker positions of the input channels, as a WAVEFORMATEXTENSIBLE
+    // dwChannelMask. 0 uses the Windows default layout for the channel count.
+    void SetChannelMask(uint32_t channelMask);
+    void SetSpectralSettings(const SpectralAnalyzer::Settings& settings);
+    const SpectralAnalyzer::Settings& GetSpectralSettings() const { return m_spectralSettings; }
+
+    // Run the spectrum at a decimated rate (the largest power-of-two division
+    // of the device rate that stays at or above targetRate). The FFT shrinks
+    // with the rate so the window keeps its duration (64 points minimum). Bands and midrange then
+    // stop at the decimated Nyquist; treble becomes everything above it,
+    // measured as the energy the decimator removed.
+    void SetDecimatedAnalysis(bool enabled, uint32_t targetRate = 2000);
+    bool IsDecimatedAnalysis() const { return m_decimatedAnalysis; }
+    uint32_t GetAnalysisRate() const { return m_spectrum.GetSampleRate(); }
+
+    // Time constant of the trends' exponential moving average
+    void SetTrendSmoothing(float seconds) { m_trendSmoothingSeconds = (std::max)(seconds, 0.0f); }
+    float GetTrendSmoothing() const { return m_trendSmoothingSeconds; }
+    static constexpr float DEFAULT_TREND_SMOOTHING = 0.03f;
+
+    // Onset detection runs on every spectrum frame of the analysis above
+    void SetOnsetSettings(const OnsetDetector::Settings& settings);
+    const OnsetDetector::Settings& GetOnsetSettings() const { return m_onsets.GetSettings(); }
 
 private:
-    // Simple frequency analysis using time-domain filtering
-    float CalculateRMS(const float* samples, size_t count);
-    float CalculatePeak(const float* samples, size_t count);
-    float CalculateBassEnergy(const float* samples, size_t count);
-    float CalculateTrebleEnergy(const float* samples, size_t count);
-    
-    // Simple low-pass and high-pass filters
-    float ApplyLowPass(float sample, float& state, float cutoff);
-    float ApplyHighPass(float sample, float& prevSample, float& prevOutput, float cutoff);
+    enum class ChannelRole : uint8_t {
+        Left,
+        Right,
+        Centre,
+        Lfe
+    };
+
+    // AutoGain channels: the summary levels, then the spectrum bands
+    enum GainChannel : size_t {
+        GAIN_VOLUME,
+        GAIN_BASS,
+        GAIN_MIDRANGE,
+        GAIN_TREBLE,
+        GAIN_LFE,
+        GAIN_FIRST_BAND,
+        GAIN_CHANNELS = GAIN_FIRST_BAND + MAX_BANDS
+    };
+
+    void ConfigureAnalysis();
+    void UpdateChannelRoles(size_t channels);
+    // Analyzer samples [0, count) map to block frames firstFrame + i * frameStep
+    void PushSpectrum(const float* mono, size_t count, size_t firstFrame, size_t frameStep, AudioFeatures& features);
+
+    // Single-pass downmix + RMS/peak kernel (SIMD, picked at runtime), the
+    // one compiled for the stream's channel count where there is one
+    AudioKernels::AnalyzeFn m_analyzeKernel;
+    size_t m_kernelChannels;    // Count m_analyzeKernel was picked for, 0 = generic
 
     uint32_t m_sampleRate;
     float m_sensitivity;
+    AutoGain m_autoGain;
     
-    // Frequency band cutoffs (normalized 0-1)
-    float m_bassCutoff;
-    float m_trebleCutoff;
-    
-    // Filter states for frequency analysis
-    float m_bassFilterState;
-    float m_trebleFilterPrevSample;
-    float m_trebleFilterPrevOutput;
+    // Windowed FFT band analysis of the downmixed signal
+    SpectralAnalyzer m_spectrum;
+    SpectralAnalyzer::Settings m_spectralSettings;  // As requested, at the device rate
+    std::vector<float> m_mono;  // Downmix scratch, MONO_CHUNK_FRAMES
+    static constexpr size_t MONO_CHUNK_FRAMES = 1024;
+
+    // Input layout; roles are rebuilt when the channel count changes
+    uint32_t m_channelMask;
+    size_t m_roleChannels;
+    ChannelRole m_channelRoles[MAX_CHANNELS];
+
+    // Optional halfband decimation ahead of the analyzer
+    Decimator m_decimator;
+    std::vector<float> m_decimated;  // MONO_CHUNK_FRAMES / 2 + 1
+    bool m_decimatedAnalysis;
+    uint32_t m_analysisTargetRate;
+
+    // Onsets from the spectral flux, fed hop by hop
+    OnsetDetector m_onsets;
+    float m_onsetLagFrames;     // Frame completion -> onset position, in device frames
     
-    // Running averages for smoothing
-    std::vector<float> m_volumeHistory;
-    std::vector<float> m_bassHistory;
-    std::vector<float> m_trebleHistory;
-    size_t m_historyIndex;
-    static const size_t HISTORY_SIZE = 10;
+    // Windowed statistics and smoothing of the final levels
+    FeatureHistory m_volumeHistory;
+    FeatureHistory m_bassHistory;
+    FeatureHistory m_midrangeHistory;
+    FeatureHistory m_trebleHistory;
+    float m_trendSmoothingSeconds;
 };
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "AutoGain.h"
+#include <algorithm>
+#include <cmath>
+
+AutoGain::AutoGain(size_t channels)
+    : m_power(channels, 0.0f)
+    , m_primed(channels, false)
+{
+    Reset(1.0f);
+}
+
+void AutoGain::Reset(float initialGain) {
+    const float level = m_settings.targetLevel / std::max(initialGain, 1e-3f);
+    std::fill(m_power.begin(), m_power.end(), level * level);
+    std::fill(m_primed.begin(), m_primed.end(), false);
+}
+
+void AutoGain::Process(const float* levels, size_t count, float blockSeconds, float* gains) {
+    count = std::min(count, m_power.size());
+    blockSeconds = std::max(blockSeconds, 0.0f);
+
+    // Per-block smoothing factors; blocks vary in length with the device
+    const float attack = 1.0f - std::exp(-blockSeconds / std::max(m_settings.attackSeconds, 1e-3f));
+    const float release = 1.0f - std::exp(-blockSeconds / std::max(m_settings.releaseSeconds, 1e-3f));
+    const float target = m_settings.targetLevel;
+    const float minGain = std::min(m_settings.minGain, m_settings.maxGain);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (levels[i] >= m_settings.gateLevel) {
+            const float power = levels[i] * levels[i];
+            if (!m_primed[i]) {
+                m_power[i] = power;
+                m_primed[i] = true;
+            } else {
+                m_power[i] += (power > m_power[i] ? attack : release) * (power - m_power[i]);
+            }
+        }
+        const float loudness = std::sqrt(m_power[i]);
+        gains[i] = loudness > 0.0f ? std::clamp(target / loudness, minGain, m_settings.maxGain) : m_settings.maxGain;
+    }
+}
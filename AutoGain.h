@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Streaming automatic gain control for a bank of feature levels (volume, each
+// frequency band, ...), so loud and quiet content both land in the motors'
+// useful range without retuning a fixed sensitivity. Each channel keeps a
+// loudness estimate in the style of LUFS momentary/short-term loudness: its
+// mean square, smoothed with a short attack when it rises and a long release
+// when it falls, and seeded by the first block above the gate. The gain
+// brings that estimate to the target level, within [minGain, maxGain]; blocks
+// below the gate leave it untouched, so silence is not boosted into noise.
+// O(1) per channel per block, no allocation after construction.
+class AutoGain {
+public:
+    struct Settings {
+        bool enabled = true;
+        float targetLevel = 0.35f;      // Long-term level a channel is normalized to; peaks go above
+        float attackSeconds = 0.4f;     // Loudness rising (gain backing off): the momentary loudness window
+        float releaseSeconds = 3.0f;    // Loudness falling (gain recovering): the short-term window, so quiet passages stay quieter
+        float minGain = 0.5f;
+        float maxGain = 100.0f;         // 40 dB
+        float gateLevel = 0.0003f;      // ~-70 dBFS, the LUFS absolute gate; quieter blocks hold the gain
+    };
+
+    explicit AutoGain(size_t channels);
+
+    // Keeps the loudness estimates, so settings can change mid-stream
+    void SetSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& GetSettings() const { return m_settings; }
+
+    // Applies initialGain to every channel until its first block above the gate
+    void Reset(float initialGain);
+
+    // Updates the estimates with this block's raw levels (one per channel, at
+    // most GetChannelCount) and writes each channel's gain to gains.
+    // blockSeconds is the audio duration the levels cover.
+    void Process(const float* levels, size_t count, float blockSeconds, float* gains);
+
+    size_t GetChannelCount() const { return m_power.size(); }
+
+private:
+    Settings m_settings;
+    std::vector<float> m_power;     // Smoothed mean square per channel
+    std::vector<bool> m_primed;     // m_power holds a measurement, not the initial gain
+};
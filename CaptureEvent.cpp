@@ -0,0 +1,98 @@
+#include "CaptureEvent.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+
+CaptureEvent::CaptureEvent()
+    : m_handle(CreateEventW(nullptr, FALSE, FALSE, nullptr))
+{
+}
+
+CaptureEvent::~CaptureEvent() {
+    if (m_handle) {
+        CloseHandle(m_handle);
+        m_handle = nullptr;
+    }
+}
+
+bool CaptureEvent::IsValid() const {
+    return m_handle != nullptr;
+}
+
+void CaptureEvent::Signal() {
+    if (m_handle) {
+        SetEvent(m_handle);
+    }
+}
+
+void CaptureEvent::Reset() {
+    if (m_handle) {
+        ResetEvent(m_handle);
+    }
+}
+
+CaptureEvent::WaitResult CaptureEvent::Wait(uint32_t timeoutMs) {
+    if (!m_handle) {
+        return WaitResult::Failed;
+    }
+
+    DWORD result = WaitForSingleObject(m_handle, timeoutMs == INFINITE_WAIT ? INFINITE : timeoutMs);
+    switch (result) {
+        case WAIT_OBJECT_0: return WaitResult::Signaled;
+        case WAIT_TIMEOUT: return WaitResult::Timeout;
+        default: return WaitResult::Failed;
+    }
+}
+
+void* CaptureEvent::GetNativeHandle() const {
+    return m_handle;
+}
+
+#else
+
+#include <chrono>
+
+CaptureEvent::CaptureEvent()
+    : m_signaled(false)
+{
+}
+
+CaptureEvent::~CaptureEvent() = default;
+
+bool CaptureEvent::IsValid() const {
+    return true;
+}
+
+void CaptureEvent::Signal() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_signaled = true;
+    }
+    m_condition.notify_one();
+}
+
+void CaptureEvent::Reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_signaled = false;
+}
+
+CaptureEvent::WaitResult CaptureEvent::Wait(uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (timeoutMs == INFINITE_WAIT) {
+        m_condition.wait(lock, [this] { return m_signaled; });
+    }
+    else if (!m_condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return m_signaled; })) {
+        return WaitResult::Timeout;
+    }
+
+    // Auto-reset, like a Win32 event created with bManualReset = FALSE
+    m_signaled = false;
+    return WaitResult::Signaled;
+}
+
+void* CaptureEvent::GetNativeHandle() const {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#ifndef _WIN32
+#include <condition_variable>
+#include <mutex>
+#endif
+
+// Auto-reset "data ready" event that capture loops block on.
+// On Windows this wraps a Win32 event so it can be handed to
+// IAudioClient::SetEventHandle / IDirectSoundNotify. Elsewhere it is a
+// condition-variable stand-in driven by the synthetic/file sources.
+// Signal() is also used by StopCapture to wake a blocked loop immediately.
+class CaptureEvent {
+public:
+    enum class WaitResult {
+        Signaled,
+        Timeout,
+        Failed
+    };
+
+    static constexpr uint32_t INFINITE_WAIT = 0xFFFFFFFF;
+
+    CaptureEvent();
+    ~CaptureEvent();
+
+    CaptureEvent(const CaptureEvent&) = delete;
+    CaptureEvent& operator=(const CaptureEvent&) = delete;
+
+    bool IsValid() const;
+    void Signal();
+    void Reset();
+    WaitResult Wait(uint32_t timeoutMs);
+
+    // Win32 HANDLE of the underlying event (nullptr on other platforms)
+    void* GetNativeHandle() const;
+
+private:
+#ifdef _WIN32
+    void* m_handle;
+#else
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_signaled;
+#endif
+};
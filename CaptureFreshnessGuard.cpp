@@ -0,0 +1,47 @@
+#include "CaptureFreshnessGuard.h"
+#include <algorithm>
+#include <cmath>
+
+CaptureFreshnessGuard::CaptureFreshnessGuard(std::chrono::milliseconds maxAge)
+    : m_maxAge(maxAge)
+    , m_stalled(false)
+    , m_staleFrames(0)
+    , m_stalls(0)
+{
+}
+
+size_t CaptureFreshnessGuard::GetStaleFrames(Clock::time_point captureTime, size_t frameCount, uint32_t sampleRate,
+                                             Clock::time_point now) {
+    if (m_maxAge.count() <= 0 || sampleRate == 0) {
+        return 0;
+    }
+
+    // Frame i was captured at captureTime + i / sampleRate; it is stale while
+    // i / sampleRate is less than the packet's age beyond the limit
+    const std::chrono::duration<double> excess = now - captureTime - m_maxAge;
+    if (excess.count() <= 0.0) {
+        m_stalled = false;
+        return 0;
+    }
+
+    const size_t stale = static_cast<size_t>((std::min)(std::ceil(excess.count() * sampleRate), static_cast<double>(frameCount)));
+    if (!m_stalled) {
+        m_stalled = true;
+        m_stalls.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_staleFrames.fetch_add(stale, std::memory_order_relaxed);
+    return stale;
+}
+
+CaptureFreshnessGuard::Stats CaptureFreshnessGuard::GetStats() const {
+    Stats stats;
+    stats.staleFrames = m_staleFrames.load(std::memory_order_relaxed);
+    stats.stalls = m_stalls.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void CaptureFreshnessGuard::Reset() {
+    m_stalled = false;
+    m_staleFrames.store(0, std::memory_order_relaxed);
+    m_stalls.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Stall recovery for live capture. When the capture thread stalls (a busy
+// CPU, a long page fault, a debugger break) the device keeps recording, and
+// the next read hands over the whole backlog at once. Rendering that would
+// play haptics for audio heard long ago, so frames older than the freshness
+// limit are skipped and the stream resumes at the newest audio. Portable; the
+// capture manager applies it to every real-time source.
+class CaptureFreshnessGuard {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Several shared-mode periods of jitter, well below a noticeable delay
+    static constexpr std::chrono::milliseconds DEFAULT_MAX_AGE{ 100 };
+
+    struct Stats {
+        uint64_t staleFrames = 0;   // Frames skipped for being too old
+        uint64_t stalls = 0;        // Runs of packets that needed skipping
+    };
+
+    explicit CaptureFreshnessGuard(std::chrono::milliseconds maxAge = DEFAULT_MAX_AGE);
+
+    // 0 disables the guard. Call while capture is stopped.
+    void SetMaxAge(std::chrono::milliseconds maxAge) { m_maxAge = maxAge; }
+    std::chrono::milliseconds GetMaxAge() const { return m_maxAge; }
+
+    // Number of leading frames of a packet to skip: those captured more than
+    // the max age before now. captureTime is when its first frame was
+    // captured; a time in the future (look-ahead input) is never stale.
+    // Capture thread only.
+    size_t GetStaleFrames(Clock::time_point captureTime, size_t frameCount, uint32_t sampleRate, Clock::time_point now);
+
+    // Any thread
+    Stats GetStats() const;
+
+    // Clears the stats; call while capture is stopped
+    void Reset();
+
+private:
+    std::chrono::milliseconds m_maxAge;
+    bool m_stalled;     // The previous packet was (partly) skipped
+
+    std::atomic<uint64_t> m_staleFrames;
+    std::atomic<uint64_t> m_stalls;
+};
@@ -0,0 +1,47 @@
+#include "CaptureRingReader.h"
+#include <algorithm>
+
+CaptureRingReader::CaptureRingReader()
+    : m_bufferBytes(0)
+    , m_blockAlign(1)
+    , m_chunkBytes(1)
+    , m_readPosition(0)
+{
+}
+
+void CaptureRingReader::Configure(uint32_t bufferBytes, uint32_t blockAlign, uint32_t chunkBytes) {
+    m_blockAlign = std::max(blockAlign, 1u);
+    m_chunkBytes = std::max(chunkBytes / m_blockAlign, 1u) * m_blockAlign;
+    m_bufferBytes = std::max(bufferBytes / m_chunkBytes, 2u) * m_chunkBytes;
+    m_readPosition = 0;
+}
+
+void CaptureRingReader::Reset(uint32_t position) {
+    m_readPosition = m_bufferBytes > 0 ? position % m_bufferBytes / m_blockAlign * m_blockAlign : 0;
+}
+
+uint32_t CaptureRingReader::GetAvailable(uint32_t writePosition) const {
+    if (m_bufferBytes == 0) {
+        return 0;
+    }
+    writePosition %= m_bufferBytes;
+    const uint32_t written = writePosition >= m_readPosition ? writePosition - m_readPosition
+                                                             : m_bufferBytes - m_readPosition + writePosition;
+    return written / m_blockAlign * m_blockAlign;
+}
+
+CaptureRingReader::Region CaptureRingReader::GetReadable(uint32_t writePosition, uint32_t maxBytes) const {
+    Region region;
+    region.offset = m_readPosition;
+
+    const uint32_t bytes = std::min(GetAvailable(writePosition), maxBytes / m_blockAlign * m_blockAlign);
+    region.bytes1 = std::min(bytes, m_bufferBytes - m_readPosition);
+    region.bytes2 = bytes - region.bytes1;
+    return region;
+}
+
+void CaptureRingReader::Advance(uint32_t bytes) {
+    if (m_bufferBytes > 0) {
+        m_readPosition = (m_readPosition + bytes) % m_bufferBytes;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+// Read side of a circular capture buffer that a device writes into (a
+// DirectSound capture buffer, or a plain byte array in benchmarks and
+// tests). Tracks the read cursor, turns the device's write cursor into whole
+// frames available, and splits a read into the span up to the buffer end and
+// the wrapped span from its start. The buffer is divided into equal chunks with
+// a notification at the end of each, so a reader woken by one finds about a
+// chunk of new audio. Portable; no allocation.
+class CaptureRingReader {
+public:
+    // A read of bytes1 + bytes2 bytes starting at offset; bytes2 is the part
+    // that wrapped to the buffer start. Both are whole frames.
+    struct Region {
+        uint32_t offset = 0;
+        uint32_t bytes1 = 0;
+        uint32_t bytes2 = 0;
+
+        uint32_t GetBytes() const { return bytes1 + bytes2; }
+    };
+
+    CaptureRingReader();
+
+    // chunkBytes is rounded down to whole frames (at least one), bufferBytes
+    // down to whole chunks (at least two). Resets the cursor to 0.
+    void Configure(uint32_t bufferBytes, uint32_t blockAlign, uint32_t chunkBytes);
+    void Reset(uint32_t position = 0);
+
+    uint32_t GetBufferBytes() const { return m_bufferBytes; }
+    uint32_t GetChunkBytes() const { return m_chunkBytes; }
+    uint32_t GetChunkCount() const { return m_bufferBytes / m_chunkBytes; }
+    uint32_t GetReadPosition() const { return m_readPosition; }
+
+    // Last byte of chunk i: where the device should signal its notification
+    uint32_t GetNotifyOffset(uint32_t chunk) const { return (chunk + 1) * m_chunkBytes - 1; }
+
+    // Whole frames written between the read cursor and writePosition (the
+    // device's safe-to-read cursor), in bytes. A write cursor on the read
+    // cursor is an empty buffer: a device that wrote a full lap during a
+    // stall reads as 0, since the cursors alone cannot tell the two apart.
+    uint32_t GetAvailable(uint32_t writePosition) const;
+
+    // Everything available, capped at maxBytes (rounded down to whole frames)
+    Region GetReadable(uint32_t writePosition, uint32_t maxBytes) const;
+
+    // Moves the read cursor past a region that has been consumed
+    void Advance(uint32_t bytes);
+
+private:
+    uint32_t m_bufferBytes;
+    uint32_t m_blockAlign;
+    uint32_t m_chunkBytes;
+    uint32_t m_readPosition;
+};
@@ -0,0 +1,411 @@
+#include "ConfigFile.h"
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+using HapticSettings = HapticMapper::HapticSettings;
+using HapticMode = HapticMapper::HapticMode;
+
+template <typename Owner, typename Value>
+struct Key {
+    const char* name;
+    Value Owner::* member;
+};
+
+// One table per section and value type; Save writes them in this order
+const Key<HapticSettings, float> HAPTIC_FLOATS[] = {
+    { "bass_intensity", &HapticSettings::bassIntensity },
+    { "treble_intensity", &HapticSettings::trebleIntensity },
+    { "volume_intensity", &HapticSettings::volumeIntensity },
+    { "dynamic_intensity", &HapticSettings::dynamicIntensity },
+    { "lfe_intensity", &HapticSettings::lfeIntensity },
+    { "response_curve", &HapticSettings::responseCurve },
+    { "write_threshold", &HapticSettings::writeThreshold },
+    { "emulation_burst_duration", &HapticSettings::emulationBurstDuration },
+    { "emulation_min_interval", &HapticSettings::emulationMinInterval },
+    { "emulation_intensity", &HapticSettings::emulationIntensity },
+    { "emulation_volume_threshold", &HapticSettings::emulationVolumeThreshold },
+    { "emulation_onset_delay", &HapticSettings::emulationOnsetDelay },
+};
+
+const Key<HapticSettings, uint32_t> HAPTIC_UINTS[] = {
+    { "update_rate_ms", &HapticSettings::updateRateMs },
+    { "fade_time_ms", &HapticSettings::fadeTimeMs },
+    { "rise_time_ms", &HapticSettings::riseTimeMs },
+    { "device_latency_ms", &HapticSettings::deviceLatencyMs },
+    { "max_writes_per_second", &HapticSettings::maxWritesPerSecond },
+};
+
+const Key<HapticSettings, bool> HAPTIC_BOOLS[] = {
+    { "use_low_frequency_motor", &HapticSettings::useLowFrequencyMotor },
+    { "use_high_frequency_motor", &HapticSettings::useHighFrequencyMotor },
+    { "use_impulse_motor", &HapticSettings::useImpulseMotor },
+    { "use_rumble_motors", &HapticSettings::useRumbleMotors },
+    { "use_spatial_mapping", &HapticSettings::useSpatialMapping },
+    { "emulation_onsets", &HapticSettings::emulationOnsets },
+};
+
+const Key<ConfigFile::AudioSettings, float> AUDIO_FLOATS[] = {
+    { "sensitivity", &ConfigFile::AudioSettings::sensitivity },
+    { "bass_cutoff", &ConfigFile::AudioSettings::bassCutoff },
+    { "treble_cutoff", &ConfigFile::AudioSettings::trebleCutoff },
+};
+
+const Key<OnsetDetector::Settings, float> ONSET_FLOATS[] = {
+    { "sensitivity", &OnsetDetector::Settings::sensitivity },
+    { "min_flux", &OnsetDetector::Settings::minFlux },
+    { "adapt_seconds", &OnsetDetector::Settings::adaptSeconds },
+    { "min_interval", &OnsetDetector::Settings::minIntervalSeconds },
+};
+
+const Key<AutoGain::Settings, float> GAIN_FLOATS[] = {
+    { "target_level", &AutoGain::Settings::targetLevel },
+    { "attack_seconds", &AutoGain::Settings::attackSeconds },
+    { "release_seconds", &AutoGain::Settings::releaseSeconds },
+    { "min_gain", &AutoGain::Settings::minGain },
+    { "max_gain", &AutoGain::Settings::maxGain },
+    { "gate_level", &AutoGain::Settings::gateLevel },
+};
+
+const Key<AutoGain::Settings, bool> GAIN_BOOLS[] = {
+    { "enabled", &AutoGain::Settings::enabled },
+};
+
+const std::pair<const char*, HapticMode> MODES[] = {
+    { "auto", HapticMode::Auto },
+    { "rumble", HapticMode::Rumble },
+    { "haptic", HapticMode::Haptic },
+    { "hybrid", HapticMode::Hybrid },
+    { "emulation", HapticMode::HapticEmulation },
+};
+
+std::string Trim(const std::string& text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+        ++begin;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        --end;
+    }
+    return text.substr(begin, end - begin);
+}
+
+bool ParseValue(const std::string& text, float& value) {
+    char* end = nullptr;
+    const float parsed = std::strtof(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !std::isfinite(parsed) || parsed < 0.0f) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool ParseValue(const std::string& text, uint32_t& value) {
+    char* end = nullptr;
+    const unsigned long parsed = std::strtoul(text.c_str(), &end, 10);
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0])) || *end != '\0' || parsed > UINT32_MAX) {
+        return false;
+    }
+    value = static_cast<uint32_t>(parsed);
+    return true;
+}
+
+bool ParseValue(const std::string& text, bool& value) {
+    if (text == "true" || text == "1" || text == "on" || text == "yes") {
+        value = true;
+    } else if (text == "false" || text == "0" || text == "off" || text == "no") {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseValue(const std::string& text, HapticMode& value) {
+    for (const auto& mode : MODES) {
+        if (text == mode.first) {
+            value = mode.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 1 = set, 0 = no such key, -1 = bad value
+template <typename Owner, typename Value, size_t N>
+int SetKey(const Key<Owner, Value> (&keys)[N], Owner& owner, const std::string& key, const std::string& value) {
+    for (const auto& entry : keys) {
+        if (key == entry.name) {
+            return ParseValue(value, owner.*entry.member) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+int SetHapticKey(HapticSettings& settings, const std::string& key, const std::string& value) {
+    if (key == "mode") {
+        return ParseValue(value, settings.preferredMode) ? 1 : -1;
+    }
+    int result = SetKey(HAPTIC_FLOATS, settings, key, value);
+    if (result == 0) {
+        result = SetKey(HAPTIC_UINTS, settings, key, value);
+    }
+    if (result == 0) {
+        result = SetKey(HAPTIC_BOOLS, settings, key, value);
+    }
+    return result;
+}
+
+template <typename Owner, typename Value, size_t N>
+void WriteKeys(std::ostream& out, const Key<Owner, Value> (&keys)[N], const Owner& owner) {
+    for (const auto& entry : keys) {
+        out << entry.name << " = " << owner.*entry.member << "\n";
+    }
+}
+
+const char* ModeName(HapticMode mode) {
+    for (const auto& entry : MODES) {
+        if (entry.second == mode) {
+            return entry.first;
+        }
+    }
+    return "auto";
+}
+
+void WriteHaptics(std::ostream& out, const HapticSettings& settings) {
+    out << "mode = " << ModeName(settings.preferredMode) << "\n";
+    WriteKeys(out, HAPTIC_FLOATS, settings);
+    WriteKeys(out, HAPTIC_UINTS, settings);
+    WriteKeys(out, HAPTIC_BOOLS, settings);
+}
+}
+
+ConfigFile::ConfigFile(const std::string& path)
+    : m_path(path)
+    , m_loadedSize(0)
+    , m_changePending(false)
+    , m_pendingSize(0)
+{
+}
+
+bool ConfigFile::Exists() const {
+    std::error_code error;
+    return std::filesystem::exists(m_path, error);
+}
+
+bool ConfigFile::Load() {
+    std::error_code error;
+    m_loadedTime = std::filesystem::last_write_time(m_path, error);
+    m_loadedSize = std::filesystem::file_size(m_path, error);
+    m_changePending = false;
+
+    std::ifstream in(m_path);
+    if (!in) {
+        std::cerr << "Failed to open config file: " << m_path << std::endl;
+        return false;
+    }
+
+    Config config;
+    if (!Parse(in, m_path, config)) {
+        return false;
+    }
+    m_config = std::move(config);
+    return true;
+}
+
+bool ConfigFile::ReloadIfChanged() {
+    std::error_code error;
+    const auto modified = std::filesystem::last_write_time(m_path, error);
+    const std::uintmax_t size = error ? 0 : std::filesystem::file_size(m_path, error);
+    if (error || (modified == m_loadedTime && size == m_loadedSize)) {
+        m_changePending = false;
+        return false;
+    }
+
+    // First sight of this change, or still changing: wait for the next poll
+    if (!m_changePending || modified != m_pendingTime || size != m_pendingSize) {
+        m_changePending = true;
+        m_pendingTime = modified;
+        m_pendingSize = size;
+        return false;
+    }
+    return Load();
+}
+
+bool ConfigFile::Parse(std::istream& in, const std::string& name, Config& config) {
+    // Profiles start from the final [haptics], so their overrides are applied last
+    struct Override {
+        std::string device;
+        std::string key;
+        std::string value;
+        int line;
+    };
+    std::vector<Override> overrides;
+
+    enum class Section { None, Audio, Onsets, Gain, Haptics, Device };
+    Section section = Section::None;
+    std::string device;
+    bool sawSection = false;
+    bool ok = true;
+    auto fail = [&](int line, const std::string& message) {
+        std::cerr << name << ":" << line << ": " << message << std::endl;
+        ok = false;
+    };
+
+    std::string text;
+    for (int line = 1; std::getline(in, text); ++line) {
+        const size_t comment = text.find_first_of("#;");
+        text = Trim(comment == std::string::npos ? text : text.substr(0, comment));
+        if (text.empty()) {
+            continue;
+        }
+
+        if (text.front() == '[') {
+            if (text.back() != ']') {
+                fail(line, "unterminated section header");
+                continue;
+            }
+            const std::string header = Trim(text.substr(1, text.size() - 2));
+            sawSection = true;
+            if (header == "audio") {
+                section = Section::Audio;
+            } else if (header == "onsets") {
+                section = Section::Onsets;
+            } else if (header == "gain") {
+                section = Section::Gain;
+            } else if (header == "haptics") {
+                section = Section::Haptics;
+            } else if (header.rfind("device ", 0) == 0 && !Trim(header.substr(7)).empty()) {
+                section = Section::Device;
+                device = Trim(header.substr(7));
+                config.profiles[device] = {};
+            } else {
+                fail(line, "unknown section [" + header + "]");
+                section = Section::None;
+            }
+            continue;
+        }
+
+        const size_t equals = text.find('=');
+        if (equals == std::string::npos) {
+            fail(line, "expected key = value");
+            continue;
+        }
+        const std::string key = Trim(text.substr(0, equals));
+        const std::string value = Trim(text.substr(equals + 1));
+
+        int result = 0;
+        switch (section) {
+            case Section::Audio:
+                result = SetKey(AUDIO_FLOATS, config.audio, key, value);
+                break;
+            case Section::Onsets:
+                result = SetKey(ONSET_FLOATS, config.audio.onsets, key, value);
+                break;
+            case Section::Gain:
+                result = SetKey(GAIN_BOOLS, config.audio.gain, key, value);
+                if (result == 0) {
+                    result = SetKey(GAIN_FLOATS, config.audio.gain, key, value);
+                }
+                break;
+            case Section::Haptics:
+                result = SetHapticKey(config.haptics, key, value);
+                break;
+            case Section::Device:
+                overrides.push_back({ device, key, value, line });
+                continue;
+            case Section::None:
+                fail(line, "key outside a section");
+                continue;
+        }
+        if (result == 0) {
+            fail(line, "unknown key '" + key + "'");
+        } else if (result < 0) {
+            fail(line, "bad value '" + value + "' for " + key);
+        }
+    }
+
+    for (auto& profile : config.profiles) {
+        profile.second = config.haptics;
+    }
+    for (const Override& entry : overrides) {
+        const int result = SetHapticKey(config.profiles[entry.device], entry.key, entry.value);
+        if (result == 0) {
+            fail(entry.line, "unknown key '" + entry.key + "'");
+        } else if (result < 0) {
+            fail(entry.line, "bad value '" + entry.value + "' for " + entry.key);
+        }
+    }
+
+    // An empty file (or one cut off before its first section) is a save in
+    // progress, not a request to reset everything to the defaults
+    if (!sawSection) {
+        std::cerr << name << ": no sections (empty or partly written file)" << std::endl;
+        ok = false;
+    }
+
+    // Values that parse but mean nothing, checked once every key is in
+    auto invalid = [&](const std::string& message) {
+        std::cerr << name << ": " << message << std::endl;
+        ok = false;
+    };
+    if (config.audio.bassCutoff >= config.audio.trebleCutoff) {
+        invalid("bass_cutoff must be below treble_cutoff");
+    }
+    if (config.audio.gain.minGain > config.audio.gain.maxGain) {
+        invalid("min_gain must not exceed max_gain");
+    }
+    if (config.haptics.responseCurve <= 0.0f) {
+        invalid("response_curve must be above 0");
+    }
+    for (const auto& profile : config.profiles) {
+        if (profile.second.responseCurve <= 0.0f) {
+            invalid("response_curve must be above 0 in [device " + profile.first + "]");
+        }
+    }
+    return ok;
+}
+
+bool ConfigFile::Save(const std::string& path, const Config& config) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to create config file: " << path << std::endl;
+        return false;
+    }
+
+    out << std::boolalpha;
+    out << "# Audio-to-Haptics configuration. Changes apply to a running session\n"
+           "# as soon as the file is saved.\n\n";
+    out << "[audio]\n";
+    WriteKeys(out, AUDIO_FLOATS, config.audio);
+    out << "\n[onsets]\n";
+    WriteKeys(out, ONSET_FLOATS, config.audio.onsets);
+    out << "\n[gain]\n";
+    out << "# Automatic gain per feature; sensitivity then trims the target (4 = as is)\n";
+    WriteKeys(out, GAIN_BOOLS, config.audio.gain);
+    WriteKeys(out, GAIN_FLOATS, config.audio.gain);
+    out << "\n[haptics]\n";
+    out << "# mode: auto, rumble, haptic, hybrid or emulation\n";
+    WriteHaptics(out, config.haptics);
+    for (const auto& profile : config.profiles) {
+        out << "\n[device " << profile.first << "]\n";
+        WriteHaptics(out, profile.second);
+    }
+    out << "\n# Per-device profile: [haptics] with the keys listed overridden, e.g.\n"
+           "# [device <id>]      (the app lists device ids when it finds them)\n"
+           "# mode = rumble\n";
+
+    if (!out) {
+        std::cerr << "Failed to write config file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
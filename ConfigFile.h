@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include "AutoGain.h"
+#include "HapticMapper.h"
+#include "OnsetDetector.h"
+
+// Tuning loaded from an INI-style file, so a running session (including the
+// service, which has no UI) can be retuned by editing it. Every key is
+// optional and defaults to the built-in value:
+//
+//   [audio]            sensitivity, bass_cutoff, treble_cutoff
+//   [onsets]           sensitivity, min_flux, adapt_seconds, min_interval
+//   [gain]             enabled, target_level, attack_seconds, release_seconds,
+//                      min_gain, max_gain, gate_level (AutoGain::Settings)
+//   [haptics]          the HapticSettings fields in snake_case, and
+//                      mode = auto | rumble | haptic | hybrid | emulation
+//   [device <id>]      a per-device profile (see
+//                      HapticController::SetDeviceProfile): [haptics] with
+//                      the keys listed here overridden
+//
+// '#' and ';' start comments. A file with any error, or with no section at
+// all, is rejected as a whole. Together with ReloadIfChanged waiting for the
+// file to settle, this keeps a half-saved edit from applying.
+class ConfigFile {
+public:
+    struct AudioSettings {
+        float sensitivity = 4.0f;       // AudioProcessor::SetSensitivity
+        float bassCutoff = 250.0f;      // Hz
+        float trebleCutoff = 4000.0f;   // Hz
+        OnsetDetector::Settings onsets;
+        AutoGain::Settings gain;
+    };
+
+    struct Config {
+        AudioSettings audio;
+        HapticMapper::HapticSettings haptics;
+        std::map<std::string, HapticMapper::HapticSettings> profiles;   // By device id
+    };
+
+    explicit ConfigFile(const std::string& path);
+
+    // Loads the file; on failure reports why and keeps the previous config
+    bool Load();
+    // Loads again if the file was modified since the last attempt and its
+    // time and size have then stayed the same for one more poll, so an editor
+    // still writing it is not read mid-save. Cheap (two stats), so it can be
+    // polled from a UI or service loop.
+    bool ReloadIfChanged();
+    bool Exists() const;
+    const Config& Get() const { return m_config; }
+    const std::string& GetPath() const { return m_path; }
+
+    // Writes config as a complete, commented file (e.g. the defaults, as a starting point)
+    static bool Save(const std::string& path, const Config& config);
+
+    // name is only used in error messages
+    static bool Parse(std::istream& in, const std::string& name, Config& config);
+
+private:
+    std::string m_path;
+    Config m_config;
+    std::filesystem::file_time_type m_loadedTime;   // Of the last load attempt
+    std::uintmax_t m_loadedSize;
+
+    // A change seen by the last poll, loaded if the next one sees it unchanged
+    bool m_changePending;
+    std::filesystem::file_time_type m_pendingTime;
+    std::uintmax_t m_pendingSize;
+};
@@ -0,0 +1,210 @@
+#include "Decimator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+    #define DECIMATOR_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define DECIMATOR_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+
+// Tap pairs per stage: 15-tap filters while the rate is still well above the
+// final band, 31 taps for the last stage, which sets the output passband
+constexpr size_t EARLY_STAGE_PAIRS = 4;
+constexpr size_t FINAL_STAGE_PAIRS = 8;
+}
+
+Decimator::Stage::Stage(size_t pairCount, size_t maxBlock)
+    : m_pairs(pairCount)
+    , m_pending(0.0f)
+    , m_hasPending(false)
+    , m_highSumSquares(0.0)
+    , m_highCount(0)
+{
+    // Blackman-windowed halfband sinc of length 4P - 1, centre tap 0.5. The
+    // non-zero side taps all land on even indices; keep the first half of them.
+    const size_t length = 4 * m_pairs - 1;
+    const double centre = static_cast<double>(2 * m_pairs - 1);
+    std::vector<double> side(2 * m_pairs);
+    double sum = 0.0;
+    for (size_t i = 0; i < 2 * m_pairs; ++i) {
+        const double n = static_cast<double>(2 * i);
+        const double x = (n - centre) / 2.0;
+        const double window = 0.42 - 0.5 * std::cos(2.0 * PI * n / (length - 1)) + 0.08 * std::cos(4.0 * PI * n / (length - 1));
+        side[i] = 0.5 * std::sin(PI * x) / (PI * x) * window;
+        sum += side[i];
+    }
+
+    // Unity DC gain: side taps sum to 0.5, the centre tap supplies the rest
+    m_taps.resize(m_pairs);
+    for (size_t i = 0; i < m_pairs; ++i) {
+        m_taps[i] = static_cast<float>(side[i] * 0.5 / sum);
+    }
+
+    const size_t maxPairs = maxBlock / 2 + 1;
+    m_even.assign(2 * m_pairs - 1 + maxPairs, 0.0f);
+    m_odd.assign(m_pairs + maxPairs, 0.0f);
+}
+
+void Decimator::Stage::Reset() {
+    std::fill(m_even.begin(), m_even.end(), 0.0f);
+    std::fill(m_odd.begin(), m_odd.end(), 0.0f);
+    m_pending = 0.0f;
+    m_hasPending = false;
+    m_highSumSquares = 0.0;
+    m_highCount = 0;
+}
+
+size_t Decimator::Stage::Process(const float* in, size_t count, float* out) {
+    const size_t evenHistory = 2 * m_pairs - 1;
+    const size_t oddHistory = m_pairs;
+    float* even = m_even.data() + evenHistory;
+    float* odd = m_odd.data() + oddHistory;
+
+    // Split into even/odd phases after the history
+    size_t pairs = 0;
+    size_t i = 0;
+    if (m_hasPending && count > 0) {
+        even[0] = m_pending;
+        odd[0] = in[0];
+        pairs = 1;
+        i = 1;
+        m_hasPending = false;
+    }
+    for (; i + 2 <= count; i += 2, ++pairs) {
+        even[pairs] = in[i];
+        odd[pairs] = in[i + 1];
+    }
+    if (i < count) {
+        m_pending = in[i];
+        m_hasPending = true;
+    }
+
+    // y[m] = 0.5 * odd[m - P] + sum_i g[i] * (even[m - i] + even[m - (2P - 1) + i]).
+    // With E = m_even (history first): even[m - i] = E[m + 2P - 1 - i] and
+    // even[m - (2P - 1) + i] = E[m + i]; odd[m - P] = m_odd[m].
+    // odd[m - P] is also the input delayed to line up with y[m], so the energy
+    // the stage removes is the difference of their squares at the same instants.
+    const float* taps = m_taps.data();
+    const float* centre = m_odd.data();
+    const float* base = m_even.data();
+
+    size_t m = 0;
+    float highSumSquares = 0.0f;
+#if DECIMATOR_SSE2
+    const __m128 half = _mm_set1_ps(0.5f);
+    __m128 highAcc = _mm_setzero_ps();
+    for (; m + 4 <= pairs; m += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (size_t t = 0; t < m_pairs; ++t) {
+            __m128 folded = _mm_add_ps(_mm_loadu_ps(base + m + evenHistory - t), _mm_loadu_ps(base + m + t));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[t]), folded));
+        }
+        const __m128 delayed = _mm_loadu_ps(centre + m);
+        const __m128 y = _mm_add_ps(_mm_mul_ps(half, delayed), acc);
+        _mm_storeu_ps(out + m, y);
+        highAcc = _mm_add_ps(highAcc, _mm_sub_ps(_mm_mul_ps(delayed, delayed), _mm_mul_ps(y, y)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, highAcc);
+    highSumSquares = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif DECIMATOR_NEON
+    float32x4_t highAcc = vdupq_n_f32(0.0f);
+    for (; m + 4 <= pairs; m += 4) {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (size_t t = 0; t < m_pairs; ++t) {
+            float32x4_t folded = vaddq_f32(vld1q_f32(base + m + evenHistory - t), vld1q_f32(base + m + t));
+            acc = vmlaq_n_f32(acc, folded, taps[t]);
+        }
+        const float32x4_t delayed = vld1q_f32(centre + m);
+        const float32x4_t y = vmlaq_n_f32(acc, delayed, 0.5f);
+        vst1q_f32(out + m, y);
+        highAcc = vaddq_f32(highAcc, vsubq_f32(vmulq_f32(delayed, delayed), vmulq_f32(y, y)));
+    }
+    highSumSquares = (vgetq_lane_f32(highAcc, 0) + vgetq_lane_f32(highAcc, 1)) + (vgetq_lane_f32(highAcc, 2) + vgetq_lane_f32(highAcc, 3));
+#endif
+    for (; m < pairs; ++m) {
+        float acc = 0.5f * centre[m];
+        for (size_t t = 0; t < m_pairs; ++t) {
+            acc += taps[t] * (base[m + evenHistory - t] + base[m + t]);
+        }
+        out[m] = acc;
+        highSumSquares += centre[m] * centre[m] - acc * acc;
+    }
+    m_highSumSquares += highSumSquares;
+    m_highCount += pairs;
+
+    // Keep the newest samples as history for the next block
+    std::memmove(m_even.data(), m_even.data() + pairs, evenHistory * sizeof(float));
+    std::memmove(m_odd.data(), m_odd.data() + pairs, oddHistory * sizeof(float));
+    return pairs;
+}
+
+Decimator::Decimator()
+    : m_outputRate(0)
+{
+}
+
+void Decimator::Configure(uint32_t inputRate, uint32_t targetRate, size_t maxBlock) {
+    size_t stageCount = 0;
+    uint32_t rate = inputRate;
+    while (targetRate > 0 && rate / 2 >= targetRate) {
+        rate /= 2;
+        ++stageCount;
+    }
+
+    m_stages.clear();
+    size_t block = maxBlock;
+    for (size_t s = 0; s < stageCount; ++s) {
+        const bool last = (s + 1 == stageCount);
+        m_stages.emplace_back(last ? FINAL_STAGE_PAIRS : EARLY_STAGE_PAIRS, block);
+        block = block / 2 + 1;
+    }
+
+    m_scratch[0].assign(maxBlock / 2 + 1, 0.0f);
+    m_scratch[1].assign(maxBlock / 2 + 1, 0.0f);
+    m_outputRate = rate;
+}
+
+void Decimator::Reset() {
+    for (Stage& stage : m_stages) {
+        stage.Reset();
+    }
+}
+
+double Decimator::Stage::ConsumeHighBandPower() {
+    const double power = m_highCount ? std::max(m_highSumSquares, 0.0) / static_cast<double>(m_highCount) : 0.0;
+    m_highSumSquares = 0.0;
+    m_highCount = 0;
+    return power;
+}
+
+double Decimator::ConsumeHighBandPower() {
+    // Each stage removes a disjoint band (its top octave); their powers add
+    double power = 0.0;
+    for (Stage& stage : m_stages) {
+        power += stage.ConsumeHighBandPower();
+    }
+    return power;
+}
+
+size_t Decimator::Process(const float* in, size_t count, float* out) {
+    if (m_stages.empty()) {
+        std::memcpy(out, in, count * sizeof(float));
+        return count;
+    }
+
+    const float* src = in;
+    for (size_t s = 0; s < m_stages.size(); ++s) {
+        float* dst = (s + 1 == m_stages.size()) ? out : m_scratch[s & 1].data();
+        count = m_stages[s].Process(src, count, dst);
+        src = dst;
+    }
+    return count;
+}
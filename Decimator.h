@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Cascade of polyphase halfband FIR decimators (each stage halves the rate).
+// Halfband filters have every other tap zero, so a stage splits its input into
+// even/odd phases and needs only the symmetric even taps plus one centre tap
+// per output. Early stages only have to keep aliases out of the final
+// passband, so they use short filters; the last stage is the sharp one.
+// Storage is sized in Configure; Process never allocates.
+class Decimator {
+public:
+    Decimator();
+
+    // Picks the largest power-of-two factor that keeps the output rate at or
+    // above targetRate. maxBlock is the largest input count passed to Process.
+    void Configure(uint32_t inputRate, uint32_t targetRate, size_t maxBlock);
+    void Reset();
+
+    // Returns the number of samples written to out (at most maxBlock / factor + 1)
+    size_t Process(const float* in, size_t count, float* out);
+
+    // Mean square of everything the stages filtered out (the band above the
+    // output Nyquist) since the last call: per stage, input power minus output
+    // power at the same instants. Resets the accumulators.
+    double ConsumeHighBandPower();
+
+    uint32_t GetOutputRate() const { return m_outputRate; }
+    size_t GetFactor() const { return size_t(1) << m_stages.size(); }
+    size_t GetStageCount() const { return m_stages.size(); }
+
+private:
+    class Stage {
+    public:
+        // pairCount symmetric tap pairs; filter length is 4 * pairCount - 1
+        Stage(size_t pairCount, size_t maxBlock);
+        void Reset();
+        size_t Process(const float* in, size_t count, float* out);
+        double ConsumeHighBandPower();
+
+    private:
+        size_t m_pairs;
+        std::vector<float> m_taps;      // Even-phase taps, first half (symmetric)
+        std::vector<float> m_even;      // History (2P - 1) + new even samples
+        std::vector<float> m_odd;       // History (P) + new odd samples
+        float m_pending;                // Even sample waiting for its odd partner
+        bool m_hasPending;
+        double m_highSumSquares;        // Removed energy: input^2 - output^2
+        size_t m_highCount;
+    };
+
+    std::vector<Stage> m_stages;
+    std::vector<float> m_scratch[2];    // Ping-pong buffers between stages
+    uint32_t m_outputRate;
+};
@@ -0,0 +1,197 @@
+#include "DirectSoundCaptureSource.h"
+#include <iostream>
+
+namespace {
+// Event-driven capture wakes at least this often to notice device errors
+constexpr uint32_t CAPTURE_WATCHDOG_MS = 2000;
+// Fallback when the buffer has no notify interface
+constexpr uint32_t CAPTURE_POLL_INTERVAL_MS = 10;
+}
+
+DirectSoundCaptureSource::DirectSoundCaptureSource()
+    : m_dsCapture(nullptr)
+    , m_dsCaptureBuffer(nullptr)
+    , m_sampleRate(44100)
+    , m_channelCount(2)
+    , m_chunkDuration(DEFAULT_CHUNK)
+    , m_eventDriven(false)
+{
+    ZeroMemory(&m_dsBufferDesc, sizeof(m_dsBufferDesc));
+    ZeroMemory(&m_dsWaveFormat, sizeof(m_dsWaveFormat));
+}
+
+DirectSoundCaptureSource::~DirectSoundCaptureSource() {
+    Stop();
+    Cleanup();
+}
+
+bool DirectSoundCaptureSource::Initialize() {
+    try {
+        // Create DirectSound capture object
+        HRESULT hr = DirectSoundCaptureCreate(nullptr, &m_dsCapture, nullptr);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to create DirectSound capture: " << std::hex << hr << std::endl;
+            return false;
+        }
+
+        // Set up wave format
+        m_dsWaveFormat.wFormatTag = WAVE_FORMAT_PCM;
+        m_dsWaveFormat.nChannels = 2;
+        m_dsWaveFormat.nSamplesPerSec = 44100;
+        m_dsWaveFormat.wBitsPerSample = 16;
+        m_dsWaveFormat.nBlockAlign = (m_dsWaveFormat.nChannels * m_dsWaveFormat.wBitsPerSample) / 8;
+        m_dsWaveFormat.nAvgBytesPerSec = m_dsWaveFormat.nSamplesPerSec * m_dsWaveFormat.nBlockAlign;
+        m_dsWaveFormat.cbSize = 0;
+
+        m_sampleRate = m_dsWaveFormat.nSamplesPerSec;
+        m_channelCount = m_dsWaveFormat.nChannels;
+
+        // 1 second buffer in whole chunks
+        const uint32_t chunkBytes = static_cast<uint32_t>(
+            static_cast<uint64_t>(m_dsWaveFormat.nAvgBytesPerSec) * m_chunkDuration.count() / 1000);
+        m_ring.Configure(m_dsWaveFormat.nAvgBytesPerSec, m_dsWaveFormat.nBlockAlign, chunkBytes);
+
+        // Set up buffer description
+        m_dsBufferDesc.dwSize = sizeof(DSCBUFFERDESC);
+        m_dsBufferDesc.dwFlags = 0;
+        m_dsBufferDesc.dwBufferBytes = m_ring.GetBufferBytes();
+        m_dsBufferDesc.dwReserved = 0;
+        m_dsBufferDesc.lpwfxFormat = &m_dsWaveFormat;
+
+        // Create capture buffer
+        hr = m_dsCapture->CreateCaptureBuffer(&m_dsBufferDesc, &m_dsCaptureBuffer, nullptr);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to create DirectSound capture buffer: " << std::hex << hr << std::endl;
+            return false;
+        }
+
+        // Get notified at the end of each chunk so Capture can block on the
+        // event instead of polling the cursor
+        m_eventDriven = false;
+        IDirectSoundNotify* notify = nullptr;
+        hr = m_dsCaptureBuffer->QueryInterface(IID_IDirectSoundNotify, (void**)&notify);
+        if (SUCCEEDED(hr) && notify) {
+            std::vector<DSBPOSITIONNOTIFY> positions(m_ring.GetChunkCount());
+            for (uint32_t i = 0; i < positions.size(); ++i) {
+                positions[i].dwOffset = m_ring.GetNotifyOffset(i);
+                positions[i].hEventNotify = static_cast<HANDLE>(m_captureEvent.GetNativeHandle());
+            }
+
+            hr = notify->SetNotificationPositions(static_cast<DWORD>(positions.size()), positions.data());
+            notify->Release();
+            m_eventDriven = SUCCEEDED(hr);
+        }
+        if (!m_eventDriven) {
+            std::cout << "DirectSound notifications unavailable, falling back to polling" << std::endl;
+        }
+
+        SampleConverter::Format format;
+        if (!SampleConverter::ParseWaveFormat(&m_dsWaveFormat, sizeof(m_dsWaveFormat), format) ||
+            !m_converter.SetFormat(format)) {
+            return false;
+        }
+        m_samples.resize(m_ring.GetBufferBytes() / format.blockAlign * m_channelCount);
+
+        std::cout << "DirectSound format: " << m_sampleRate << " Hz, " << m_channelCount << " channels, "
+                  << m_chunkDuration.count() << " ms chunks" << std::endl;
+        return true;
+    }
+    catch (...) {
+        std::cerr << "Exception in DirectSoundCaptureSource::Initialize" << std::endl;
+        return false;
+    }
+}
+
+bool DirectSoundCaptureSource::Start() {
+    if (!m_dsCaptureBuffer) {
+        return false;
+    }
+
+    m_ring.Reset();
+    m_captureEvent.Reset();
+    HRESULT hr = m_dsCaptureBuffer->Start(DSCBSTART_LOOPING);
+    if (FAILED(hr)) {
+        std::cerr << "Failed to start DirectSound capture: " << std::hex << hr << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DirectSoundCaptureSource::Stop() {
+    if (m_dsCaptureBuffer) {
+        m_dsCaptureBuffer->Stop();
+    }
+}
+
+void DirectSoundCaptureSource::Interrupt() {
+    m_captureEvent.Signal();
+}
+
+bool DirectSoundCaptureSource::Capture(const DataSink& sink) {
+    // Wait for a chunk notification (or Interrupt)
+    auto wait = m_captureEvent.Wait(m_eventDriven ? CAPTURE_WATCHDOG_MS : CAPTURE_POLL_INTERVAL_MS);
+    if (wait == CaptureEvent::WaitResult::Failed) {
+        std::cerr << "Failed to wait for DirectSound notification" << std::endl;
+        return false;
+    }
+
+    // Data is complete up to the read cursor; the capture cursor runs ahead of it
+    DWORD capturePos, readCursor;
+    HRESULT hr = m_dsCaptureBuffer->GetCurrentPosition(&capturePos, &readCursor);
+    if (FAILED(hr)) {
+        std::cerr << "Failed to get DirectSound position: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    const CaptureRingReader::Region region = m_ring.GetReadable(readCursor, m_ring.GetBufferBytes());
+    if (region.GetBytes() == 0) {
+        return true;
+    }
+
+    // The oldest unread frame was captured region.GetBytes() ago
+    const auto captureTime = std::chrono::steady_clock::now() -
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(region.GetBytes()) / m_dsWaveFormat.nAvgBytesPerSec));
+
+    void* ptr1, *ptr2;
+    DWORD bytes1, bytes2;
+    hr = m_dsCaptureBuffer->Lock(region.offset, region.GetBytes(), &ptr1, &bytes1, &ptr2, &bytes2, 0);
+    if (FAILED(hr)) {
+        std::cerr << "Failed to lock DirectSound buffer: " << std::hex << hr << std::endl;
+        return true;    // Retry on the next notification
+    }
+
+    // Convert both spans straight out of the device buffer, back to back
+    const size_t blockAlign = m_dsWaveFormat.nBlockAlign;
+    const size_t frames1 = bytes1 / blockAlign;
+    const size_t frames2 = ptr2 ? bytes2 / blockAlign : 0;
+    m_converter.ConvertTo(ptr1, frames1, m_samples.data());
+    m_converter.ConvertTo(ptr2, frames2, m_samples.data() + frames1 * m_channelCount);
+    m_dsCaptureBuffer->Unlock(ptr1, bytes1, ptr2, bytes2);
+
+    m_ring.Advance(static_cast<uint32_t>((frames1 + frames2) * blockAlign));
+    sink(m_samples.data(), (frames1 + frames2) * m_channelCount, m_channelCount, captureTime);
+    return true;
+}
+
+void DirectSoundCaptureSource::Cleanup() {
+    if (m_dsCaptureBuffer) {
+        m_dsCaptureBuffer->Release();
+        m_dsCaptureBuffer = nullptr;
+    }
+    if (m_dsCapture) {
+        m_dsCapture->Release();
+        m_dsCapture = nullptr;
+    }
+}
+
+bool DirectSoundCaptureSource::IsAvailable() {
+    LPDIRECTSOUNDCAPTURE dsCapture = nullptr;
+    HRESULT hr = DirectSoundCaptureCreate(nullptr, &dsCapture, nullptr);
+
+    if (SUCCEEDED(hr) && dsCapture) {
+        dsCapture->Release();
+        return true;
+    }
+    return false;
+}
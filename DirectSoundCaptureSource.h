@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Windows.h>
+#include <dsound.h>
+#include <chrono>
+#include <vector>
+#include "ICaptureSource.h"
+#include "CaptureEvent.h"
+#include "CaptureRingReader.h"
+#include "SampleConverter.h"
+
+// DirectSound capture from the default recording device (fallback backend).
+// The one-second capture buffer signals every chunk; each wake-up converts
+// whatever is readable straight from the locked buffer spans into a
+// persistent float buffer, so latency is about one chunk and nothing is
+// staged or allocated per packet.
+class DirectSoundCaptureSource : public ICaptureSource {
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_CHUNK{ 10 };
+
+    DirectSoundCaptureSource();
+    ~DirectSoundCaptureSource() override;
+
+    // Notification interval (rounded to whole frames). Call before Initialize.
+    void SetChunkDuration(std::chrono::milliseconds chunk) { m_chunkDuration = chunk; }
+
+    bool Initialize() override;
+    bool Start() override;
+    void Stop() override;
+    bool Capture(const DataSink& sink) override;
+    void Interrupt() override;
+
+    uint32_t GetSampleRate() const override { return m_sampleRate; }
+    uint32_t GetChannelCount() const override { return m_channelCount; }
+    bool IsEventDriven() const override { return m_eventDriven; }
+
+    static bool IsAvailable();
+
+private:
+    void Cleanup();
+
+    LPDIRECTSOUNDCAPTURE m_dsCapture;
+    LPDIRECTSOUNDCAPTUREBUFFER m_dsCaptureBuffer;
+    DSCBUFFERDESC m_dsBufferDesc;
+    WAVEFORMATEX m_dsWaveFormat;
+
+    // Audio format
+    UINT32 m_sampleRate;
+    UINT32 m_channelCount;
+
+    // Read cursor over the device buffer, and the converted samples of one
+    // read (sized for the whole buffer, allocated once)
+    CaptureRingReader m_ring;
+    std::vector<float> m_samples;
+    SampleConverter m_converter;
+    std::chrono::milliseconds m_chunkDuration;
+
+    // Per-chunk notifications, and Interrupt
+    CaptureEvent m_captureEvent;
+    bool m_eventDriven;
+};
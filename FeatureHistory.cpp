@@ -0,0 +1,52 @@
+#include "FeatureHistory.h"
+#include <algorithm>
+#include <cmath>
+
+FeatureHistory::FeatureHistory() {
+    Reset();
+}
+
+void FeatureHistory::Reset() {
+    std::fill(m_values, m_values + WINDOW, 0.0f);
+    m_next = 0;
+    m_count = 0;
+    m_sum = 0.0;
+    m_sumSquares = 0.0;
+    m_sumIndexed = 0.0;
+    m_smoothed = 0.0f;
+}
+
+FeatureHistory::Trend FeatureHistory::Push(float value, float smoothing, float blockSeconds) {
+    if (m_count == WINDOW) {
+        // Dropping the oldest shifts every other index down by one
+        const double oldest = m_values[m_next];
+        m_sum -= oldest;
+        m_sumSquares -= oldest * oldest;
+        m_sumIndexed -= m_sum;
+        --m_count;
+    }
+    m_sumIndexed += static_cast<double>(m_count) * value;
+    m_sum += value;
+    m_sumSquares += static_cast<double>(value) * value;
+    m_values[m_next] = value;
+    m_next = (m_next + 1) % WINDOW;
+    ++m_count;
+
+    m_smoothed = m_count == 1 ? value : m_smoothed + std::clamp(smoothing, 0.0f, 1.0f) * (value - m_smoothed);
+
+    Trend trend;
+    const double n = static_cast<double>(m_count);
+    const double mean = m_sum / n;
+    trend.average = static_cast<float>(mean);
+    trend.deviation = static_cast<float>(std::sqrt(std::max(m_sumSquares / n - mean * mean, 0.0)));
+    trend.smoothed = m_smoothed;
+
+    // Over x = 0..n-1: sum x = n(n-1)/2, n * sum x^2 - (sum x)^2 = n^2 (n^2 - 1) / 12
+    trend.slope = 0.0f;
+    if (m_count > 1 && blockSeconds > 0.0f) {
+        const double sumX = n * (n - 1.0) / 2.0;
+        const double perBlock = (n * m_sumIndexed - sumX * m_sum) / (n * n * (n * n - 1.0) / 12.0);
+        trend.slope = static_cast<float>(perBlock / blockSeconds);
+    }
+    return trend;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+// Running statistics of one feature level over the last WINDOW blocks:
+// moving average and standard deviation from running sums, an exponential
+// moving average, and the least-squares slope over the window. Each Push
+// updates the sums with the value entering and the one leaving the window,
+// so it is O(1) with no rescans and no allocation.
+class FeatureHistory {
+public:
+    static constexpr size_t WINDOW = 10;
+
+    struct Trend {
+        float average;      // Mean over the window
+        float deviation;    // Standard deviation over the window
+        float smoothed;     // Exponential moving average
+        float slope;        // Least-squares slope over the window, per second (> 0 rising)
+    };
+
+    FeatureHistory();
+
+    void Reset();
+
+    // Adds one block's level. smoothing is the EMA weight of the new value
+    // (0-1]; blockSeconds converts the per-block slope to per second.
+    Trend Push(float value, float smoothing, float blockSeconds);
+
+private:
+    float m_values[WINDOW];     // Ring, oldest at m_next once full
+    size_t m_next;
+    size_t m_count;
+
+    // Over the values in the window, oldest at index 0. Doubles, so the
+    // add/subtract updates do not drift over a long session.
+    double m_sum;               // sum y
+    double m_sumSquares;        // sum y^2
+    double m_sumIndexed;        // sum i * y
+    float m_smoothed;
+};
@@ -0,0 +1,157 @@
+#include "FileCaptureSource.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+constexpr size_t FRAMES_PER_CALLBACK = 512; // Process in chunks
+}
+
+FileCaptureSource::FileCaptureSource(const std::string& path, PlaybackMode mode)
+    : m_path(path)
+    , m_mode(mode)
+    , m_sampleRate(44100)
+    , m_channelCount(2)
+    , m_channelMask(0)
+    , m_frameCount(0)
+    , m_position(0)
+    , m_finished(false)
+    , m_lookAhead(0)
+{
+}
+
+bool FileCaptureSource::Initialize() {
+    m_position = 0;
+    m_finished = false;
+
+    if (m_path.empty()) {
+        GenerateTestTone();
+        return true;
+    }
+
+    if (!m_wavFile.Open(m_path)) {
+        std::cerr << "Failed to open input file: " << m_path << std::endl;
+        return false;
+    }
+
+    const WavFile::Format& format = m_wavFile.GetFormat();
+    m_sampleRate = format.sampleRate;
+    m_channelCount = format.channels;
+    m_channelMask = format.channelMask;
+    m_frameCount = m_wavFile.GetFrameCount();
+
+    if (m_frameCount == 0) {
+        std::cerr << "Input file contains no audio: " << m_path << std::endl;
+        m_wavFile.Close();
+        return false;
+    }
+
+    // Allocated once; Capture never allocates
+    m_scratch.assign(FRAMES_PER_CALLBACK * m_channelCount, 0.0f);
+    return true;
+}
+
+void FileCaptureSource::GenerateTestTone() {
+    // Generate a simple test tone for demonstration
+    m_sampleRate = 44100;
+    m_channelCount = 2;
+
+    // Generate 5 seconds of test audio (sine waves at different frequencies)
+    size_t sampleCount = m_sampleRate * 5; // 5 seconds
+    m_audioData.resize(sampleCount * m_channelCount);
+
+    for (size_t i = 0; i < sampleCount; ++i) {
+        float time = static_cast<float>(i) / m_sampleRate;
+
+        // Left channel: 440 Hz sine wave (A note)
+        float leftSample = 0.3f * sinf(2.0f * 3.14159f * 440.0f * time);
+
+        // Right channel: 880 Hz sine wave (A note, one octave higher)
+        float rightSample = 0.3f * sinf(2.0f * 3.14159f * 880.0f * time);
+
+        // Add some variation to make it more interesting for haptics
+        float modulation = 0.5f + 0.5f * sinf(2.0f * 3.14159f * 2.0f * time); // 2 Hz modulation
+
+        m_audioData[i * 2] = leftSample * modulation;
+        m_audioData[i * 2 + 1] = rightSample * modulation;
+    }
+
+    m_frameCount = sampleCount;
+
+    std::cout << "Test audio generated: " << m_sampleRate << " Hz, " << m_channelCount << " channels, "
+              << (m_audioData.size() / m_channelCount / m_sampleRate) << " seconds" << std::endl;
+}
+
+bool FileCaptureSource::Start() {
+    m_captureEvent.Reset();
+    m_nextDeadline = std::chrono::steady_clock::now();
+    return true;
+}
+
+void FileCaptureSource::Stop() {
+}
+
+void FileCaptureSource::Interrupt() {
+    m_captureEvent.Signal();
+}
+
+bool FileCaptureSource::Capture(const DataSink& sink) {
+    if (m_finished) {
+        return true;
+    }
+
+    if (m_mode == PlaybackMode::AsFastAsPossible) {
+        // No pacing: the sink applies backpressure
+        DeliverChunk(sink, std::chrono::steady_clock::now());
+        if (m_position >= m_frameCount) {
+            m_finished = true;
+        }
+        return true;
+    }
+
+    // Simulate real-time playback. Deadlines accumulate so rounding never
+    // drifts, and waiting on the event lets Interrupt cut the wait short.
+    // Round up, so a chunk is never delivered before its deadline (its
+    // playback time, less the look-ahead)
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(m_nextDeadline - m_lookAhead - std::chrono::steady_clock::now());
+    if (remaining.count() > 0) {
+        if (m_captureEvent.Wait(static_cast<uint32_t>(remaining.count())) == CaptureEvent::WaitResult::Signaled) {
+            return true;
+        }
+    }
+
+    // The simulated device captured the chunk at its scheduled time (with
+    // look-ahead: the chunk will play then)
+    DeliverChunk(sink, m_nextDeadline);
+
+    // Loop the audio
+    if (m_position >= m_frameCount) {
+        m_position = 0;
+    }
+
+    m_nextDeadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(FRAMES_PER_CALLBACK) / m_sampleRate));
+    return true;
+}
+
+void FileCaptureSource::DeliverChunk(const DataSink& sink, std::chrono::steady_clock::time_point captureTime) {
+    if (m_position >= m_frameCount) {
+        return;
+    }
+
+    size_t framesToRead = static_cast<size_t>((std::min)(static_cast<uint64_t>(FRAMES_PER_CALLBACK), m_frameCount - m_position));
+
+    if (!m_wavFile.IsOpen()) {
+        sink(&m_audioData[m_position * m_channelCount], framesToRead * m_channelCount, m_channelCount, captureTime);
+    }
+    else if (const float* frames = m_wavFile.GetFloatFrames(m_position)) {
+        // Float files are handed over straight from the mapping
+        sink(frames, framesToRead * m_channelCount, m_channelCount, captureTime);
+    }
+    else {
+        framesToRead = m_wavFile.ReadFrames(m_position, framesToRead, m_scratch.data());
+        sink(m_scratch.data(), framesToRead * m_channelCount, m_channelCount, captureTime);
+    }
+
+    m_position += framesToRead;
+}
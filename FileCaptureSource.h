@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "ICaptureSource.h"
+#include "CaptureEvent.h"
+#include "WavFile.h"
+
+// File-based input. Streams a WAV file from a memory mapping, or plays a
+// generated test tone when no path is given. Portable, so the whole pipeline
+// can run without audio hardware.
+class FileCaptureSource : public ICaptureSource {
+public:
+    enum class PlaybackMode {
+        RealTime,           // Paced to the file's sample rate, loops forever
+        AsFastAsPossible    // Plays once, limited only by the consumer (offline analysis)
+    };
+
+    explicit FileCaptureSource(const std::string& path = "", PlaybackMode mode = PlaybackMode::RealTime);
+    ~FileCaptureSource() override = default;
+
+    // Real-time mode only: deliver each chunk this long before its playback
+    // time, stamped with that playback time (so its captureTime lies in the
+    // future). Playback starts at Start(). Call before Start.
+    void SetLookAhead(std::chrono::milliseconds lead) { m_lookAhead = lead; }
+
+    bool Initialize() override;
+    bool Start() override;
+    void Stop() override;
+    bool Capture(const DataSink& sink) override;
+    void Interrupt() override;
+
+    uint32_t GetSampleRate() const override { return m_sampleRate; }
+    uint32_t GetChannelCount() const override { return m_channelCount; }
+    uint32_t GetChannelMask() const override { return m_channelMask; }
+    bool IsEventDriven() const override { return true; }
+    bool IsRealTime() const override { return m_mode == PlaybackMode::RealTime; }
+    bool IsFinished() const override { return m_finished; }
+
+private:
+    void GenerateTestTone();
+    void DeliverChunk(const DataSink& sink, std::chrono::steady_clock::time_point captureTime);
+
+    std::string m_path;
+    PlaybackMode m_mode;
+
+    uint32_t m_sampleRate;
+    uint32_t m_channelCount;
+    uint32_t m_channelMask;
+
+    // WAV input: frames are read straight from the mapping
+    WavFile m_wavFile;
+    std::vector<float> m_scratch;   // Conversion buffer for non-float formats
+
+    // Synthetic fallback
+    std::vector<float> m_audioData;
+
+    uint64_t m_frameCount;
+    uint64_t m_position;            // In frames
+    bool m_finished;
+
+    // Real-time pacing; the event lets Interrupt cut a wait short
+    std::chrono::steady_clock::time_point m_nextDeadline;   // Playback time of the next chunk
+    std::chrono::milliseconds m_lookAhead;
+    CaptureEvent m_captureEvent;
+};
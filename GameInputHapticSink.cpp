@@ -0,0 +1,157 @@
+#include "GameInputHapticSink.h"
+#include <iostream>
+
+GameInputHapticSink::GameInputHapticSink()
+    : m_gameInput(nullptr)
+    , m_initialScanDone(false)
+{
+}
+
+GameInputHapticSink::~GameInputHapticSink() {
+    Shutdown();
+}
+
+bool GameInputHapticSink::Initialize() {
+    HRESULT hr = GameInputCreate(&m_gameInput);
+    if (FAILED(hr)) {
+        std::cerr << "Failed to create GameInput: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    std::cout << "GameInput initialized successfully" << std::endl;
+    return true;
+}
+
+void GameInputHapticSink::Shutdown() {
+    for (auto& gamepad : m_gamepads) {
+        if (gamepad.device) {
+            // Stop all haptic feedback before cleanup
+            GameInputRumbleParams params = {};
+            gamepad.device->SetRumbleState(&params);
+            gamepad.device->Release();
+        }
+    }
+    m_gamepads.clear();
+
+    if (m_gameInput) {
+        m_gameInput->Release();
+        m_gameInput = nullptr;
+    }
+}
+
+size_t GameInputHapticSink::FindDevices() {
+    if (!m_gameInput) {
+        return 0;
+    }
+
+    // Enumerate gamepad devices without cleaning up existing ones
+    IGameInputReading* reading = nullptr;
+    HRESULT hr = m_gameInput->GetCurrentReading(GameInputKindGamepad, nullptr, &reading);
+
+    if (SUCCEEDED(hr) && reading) {
+        IGameInputDevice* device = nullptr;
+        reading->GetDevice(&device);
+        if (device) {
+            // Check if we already have this device
+            bool found = false;
+            for (const auto& gamepad : m_gamepads) {
+                if (gamepad.device == device) {
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found) {
+                GamepadInfo info;
+                info.device = device;
+                info.device->AddRef(); // Keep reference
+
+                // Detect device capabilities
+                DetectDeviceCapabilities(info);
+
+                m_gamepads.push_back(info);
+
+                std::cout << "Found new gamepad device - " << DescribeDevice(m_gamepads.size() - 1) << std::endl;
+                std::cout << "Total gamepads found: " << m_gamepads.size() << std::endl;
+            }
+        }
+        reading->Release();
+    }
+
+    // Only print total if this is the initial scan or we found a new device
+    if (!m_initialScanDone) {
+        std::cout << "Total gamepads found: " << m_gamepads.size() << std::endl;
+        m_initialScanDone = true;
+    }
+
+    return m_gamepads.size();
+}
+
+bool GameInputHapticSink::Write(size_t device, const HapticMapper::MotorLevels& levels) {
+    if (device >= m_gamepads.size() || !m_gamepads[device].device) {
+        return false;
+    }
+
+    GameInputRumbleParams params = {};
+    params.lowFrequency = levels.leftMotor;
+    params.highFrequency = levels.rightMotor;
+    params.leftTrigger = levels.leftTrigger;
+    params.rightTrigger = levels.rightTrigger;
+
+    m_gamepads[device].device->SetRumbleState(&params);
+    return true;
+}
+
+std::string GameInputHapticSink::GetDeviceId(size_t device) const {
+    return device < m_gamepads.size() ? m_gamepads[device].id : std::string();
+}
+
+std::string GameInputHapticSink::DescribeDevice(size_t device) const {
+    if (device >= m_gamepads.size()) {
+        return "Unknown device";
+    }
+    const GamepadInfo& gamepad = m_gamepads[device];
+    return std::string("Rumble: ") + (gamepad.supportsRumble ? "Yes" : "No") +
+           ", Haptics: " + (gamepad.supportsHaptics ? "Yes" : "No");
+}
+
+void GameInputHapticSink::DetectDeviceCapabilities(GamepadInfo& gamepad) {
+    if (!gamepad.device) return;
+
+    const GameInputDeviceInfo* deviceInfo = nullptr;
+    HRESULT hr = gamepad.device->GetDeviceInfo(&deviceInfo);
+
+    if (SUCCEEDED(hr) && deviceInfo) {
+        // Stable per device and machine, so profiles survive reconnects
+        static const char HEX[] = "0123456789abcdef";
+        gamepad.id.clear();
+        for (uint8_t byte : deviceInfo->deviceId.value) {
+            gamepad.id += HEX[byte >> 4];
+            gamepad.id += HEX[byte & 0xF];
+        }
+
+        // GameInput 2.0 supports rumble via SetRumbleState
+        gamepad.supportsRumble = true;
+        gamepad.rumbleMotorCount = 4; // Low/High frequency + Left/Right triggers
+        
+        // Check for haptic support
+        GameInputHapticInfo hapticInfo = {};
+        hr = gamepad.device->GetHapticInfo(&hapticInfo);
+        if (SUCCEEDED(hr)) {
+            gamepad.supportsHaptics = true;
+            gamepad.hapticMotorCount = hapticInfo.locationCount;
+        } else {
+            gamepad.supportsHaptics = false;
+            gamepad.hapticMotorCount = 0;
+        }
+        
+        // Device capabilities detected (details shown in device discovery)
+    } else {
+        std::cerr << "Failed to get device info: " << std::hex << hr << std::endl;
+        // Default to basic rumble support
+        gamepad.supportsRumble = true;
+        gamepad.rumbleMotorCount = 4;
+        gamepad.supportsHaptics = false;
+        gamepad.hapticMotorCount = 0;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "GameInputConfig.h"
+#include <GameInput.h>
+#include <string>
+#include <vector>
+#include "IHapticSink.h"
+
+// Use appropriate GameInput namespace
+#if GAMEINPUT_API_VERSION >= 2
+using namespace GameInput::v2;
+#elif GAMEINPUT_API_VERSION >= 1
+using namespace GameInput::v1;
+#endif
+
+// Gamepads through GameInput; every write is one SetRumbleState call
+// (low/high-frequency motors and impulse triggers).
+class GameInputHapticSink : public IHapticSink {
+public:
+    GameInputHapticSink();
+    ~GameInputHapticSink() override;
+
+    bool Initialize() override;
+    void Shutdown() override;
+
+    size_t FindDevices() override;
+    size_t GetDeviceCount() const override { return m_gamepads.size(); }
+
+    bool Write(size_t device, const HapticMapper::MotorLevels& levels) override;
+
+    std::string GetDeviceId(size_t device) const override;
+    std::string DescribeDevice(size_t device) const override;
+    const char* GetName() const override { return "GameInput"; }
+
+private:
+    struct GamepadInfo {
+        IGameInputDevice* device;
+        std::string id;     // GameInput deviceId, hex
+
+        // Device capabilities
+        bool supportsRumble;
+        bool supportsHaptics;
+        uint32_t hapticMotorCount;
+        uint32_t rumbleMotorCount;
+
+        GamepadInfo() : device(nullptr), supportsRumble(false), supportsHaptics(false),
+                       hapticMotorCount(0), rumbleMotorCount(0) {}
+    };
+
+    // Device capability detection
+    void DetectDeviceCapabilities(GamepadInfo& gamepad);
+
+    IGameInput* m_gameInput;
+    std::vector<GamepadInfo> m_gamepads;
+    bool m_initialScanDone;
+};
@@ -1,15 +1,53 @@
 #include "HapticController.h"
+#include "GameInputConfig.h"
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+#include "GameInputHapticSink.h"
+#endif
+
+namespace {
+// Without new audio for this long (e.g. WASAPI loopback delivers nothing
+// while the system is silent) the output fades to zero instead of holding
+constexpr auto STALE_FEATURES = std::chrono::milliseconds(200);
+
+HapticMapper::MotorLevels Lerp(const HapticMapper::MotorLevels& from, const HapticMapper::MotorLevels& to, float t) {
+    HapticMapper::MotorLevels result;
+    result.leftMotor = from.leftMotor + (to.leftMotor - from.leftMotor) * t;
+    result.rightMotor = from.rightMotor + (to.rightMotor - from.rightMotor) * t;
+    result.leftTrigger = from.leftTrigger + (to.leftTrigger - from.leftTrigger) * t;
+    result.rightTrigger = from.rightTrigger + (to.rightTrigger - from.rightTrigger) * t;
+    return result;
+}
+
+// A level is worth sending if it moved by more than the threshold, or
+// reached zero (so a pad never keeps a sub-threshold residual hum)
+bool LevelChanged(float level, float written, float threshold) {
+    return std::abs(level - written) > threshold || (level == 0.0f && written != 0.0f);
+}
+
+bool NeedsWrite(const HapticMapper::MotorLevels& levels, const HapticMapper::MotorLevels& written, float threshold) {
+    return LevelChanged(levels.leftMotor, written.leftMotor, threshold) ||
+           LevelChanged(levels.rightMotor, written.rightMotor, threshold) ||
+           LevelChanged(levels.leftTrigger, written.leftTrigger, threshold) ||
+           LevelChanged(levels.rightTrigger, written.rightTrigger, threshold);
+}
+}
 
 HapticController::HapticController()
-    : m_gameInput(nullptr)
-    , m_activeMode(HapticMode::Auto)
-    , m_lastUpdate(std::chrono::steady_clock::now())
-    , m_lastHapticBurst(std::chrono::steady_clock::now())
-    , m_hapticBurstActive(false)
-    , m_hapticBurstStart(std::chrono::steady_clock::now())
-    , m_leftMotorTurn(true)
+    : m_activeMode(HapticMode::Auto)
+    , m_timeBase(std::chrono::steady_clock::now())
+    , m_nextSequence(1)
+    , m_onsetsTaken(0)
+    , m_lookAhead(false)
+    , m_timelineFirst(0)
+    , m_timelineCount(0)
+    , m_latencyTracker(nullptr)
+    , m_reportedSequence(0)
+    , m_outputRunning(false)
+    , m_manualOverride(false)
 {
 }
 
@@ -18,114 +56,108 @@ HapticController::~HapticController() {
 }
 
 bool HapticController::Initialize() {
-    HRESULT hr = GameInputCreate(&m_gameInput);
-    if (FAILED(hr)) {
-        std::cerr << "Failed to create GameInput: " << std::hex << hr << std::endl;
+#ifdef _WIN32
+    return Initialize(std::make_shared<GameInputHapticSink>());
+#else
+    std::cerr << "No haptic output backend on this platform" << std::endl;
+    return false;
+#endif
+}
+
+bool HapticController::Initialize(std::shared_ptr<IHapticSink> sink, bool startOutputThread) {
+    if (!sink || !sink->Initialize()) {
+        std::cerr << "Failed to initialize haptic output" << std::endl;
         return false;
     }
-
-    std::cout << "GameInput initialized successfully" << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(m_deviceMutex);
+        m_sink = std::move(sink);
+    }
     
     // Determine the best haptic mode based on API version and settings
-    switch (m_settings.preferredMode) {
-        case HapticMode::Auto:
-            // Try haptic first (GameInput 2.0), fall back to rumble (GameInput 1.0)
-            #if GAMEINPUT_API_VERSION >= 2
-                m_activeMode = HapticMode::Haptic;
-                std::cout << "Using GameInput 2.0 Haptic API (auto-detected)" << std::endl;
-            #else
-                m_activeMode = HapticMode::Rumble;
-                std::cout << "Using GameInput 1.0 Rumble API (auto-detected)" << std::endl;
-            #endif
-            break;
-        case HapticMode::Haptic:
-            m_activeMode = HapticMode::Haptic;
-            std::cout << "Using GameInput 2.0 Haptic API (forced)" << std::endl;
-            break;
-        case HapticMode::Rumble:
-            m_activeMode = HapticMode::Rumble;
-            std::cout << "Using GameInput 1.0 Rumble API (forced)" << std::endl;
-            break;
-        case HapticMode::Hybrid:
-            m_activeMode = HapticMode::Hybrid;
-            std::cout << "Using Hybrid mode (both APIs)" << std::endl;
-            break;
-        case HapticMode::HapticEmulation:
-            m_activeMode = HapticMode::HapticEmulation;
-            std::cout << "Using Haptic Emulation mode (strong bursts)" << std::endl;
-            break;
+    HapticMode preferred;
+    {
+        std::lock_guard<std::mutex> lock(m_mapperMutex);
+        preferred = m_mapper.GetSettings().preferredMode;
+        m_activeMode = ResolveMode(preferred);
+        PublishSettings();
     }
+    std::cout << "Using " << GetHapticModeString() << (preferred == HapticMode::Auto ? " (auto-detected)" : "") << std::endl;
     
     // Find initial gamepads
     FindGamepads();
+
+    // Start the fixed-rate output thread
+    if (startOutputThread) {
+        m_outputTimer.ClearInterrupt();
+        m_outputRunning = true;
+        m_outputThread = std::thread(&HapticController::OutputLoop, this);
+    }
     
     return true;
 }
 
 void HapticController::Shutdown() {
+    StopOutputThread();
     StopAllHaptics();
     CleanupDevices();
-    
-    if (m_gameInput) {
-        m_gameInput->Release();
-        m_gameInput = nullptr;
-    }
 }
 
 bool HapticController::FindGamepads() {
-    if (!m_gameInput) {
+    // Lock order: mapper (settings, profiles), then devices
+    std::lock_guard<std::mutex> mapperLock(m_mapperMutex);
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    if (!m_sink) {
         return false;
     }
 
-    // Enumerate gamepad devices without cleaning up existing ones
-    IGameInputReading* reading = nullptr;
-    HRESULT hr = m_gameInput->GetCurrentReading(GameInputKindGamepad, nullptr, &reading);
-    
-    bool foundNewDevice = false;
-    
-    if (SUCCEEDED(hr) && reading) {
-        IGameInputDevice* device = nullptr;
-        reading->GetDevice(&device);
-        if (device) {
-            // Check if we already have this device
-            bool found = false;
-            for (const auto& gamepad : m_gamepads) {
-                if (gamepad.device == device) {
-                    found = true;
-                    break;
-                }
-            }
-            
-            if (!found) {
-                GamepadInfo info;
-                info.device = device;
-                info.device->AddRef(); // Keep reference
-                info.lastUpdate = std::chrono::steady_clock::now();
-                
-                // Detect device capabilities
-                DetectDeviceCapabilities(info);
-                
-                m_gamepads.push_back(info);
-                foundNewDevice = true;
-                
-                std::cout << "Found new gamepad device - Rumble: " << (info.supportsRumble ? "Yes" : "No") 
-                         << ", Haptics: " << (info.supportsHaptics ? "Yes" : "No") << std::endl;
-                std::cout << "Total gamepads found: " << m_gamepads.size() << std::endl;
-            }
-        }
-        reading->Release();
+    // Devices are only ever appended, so existing state keeps its index
+    const size_t known = m_gamepads.size();
+    m_gamepads.resize(m_sink->FindDevices());
+    for (size_t i = known; i < m_gamepads.size(); ++i) {
+        m_gamepads[i].id = m_sink->GetDeviceId(i);
+        ConfigureGamepad(m_gamepads[i], m_mapper.GetSettings(), m_activeMode, m_profiles);
     }
+    m_writeList.reserve(m_gamepads.size());
 
-    // Only print total if this is the initial scan or we found a new device
-    static bool initialScanDone = false;
-    if (!initialScanDone) {
-        std::cout << "Total gamepads found: " << m_gamepads.size() << std::endl;
-        initialScanDone = true;
+    // One writer per extra device (up to MAX_WRITE_WORKERS); the output
+    // thread writes too
+    const size_t workers = (std::min)(m_gamepads.size() > 0 ? m_gamepads.size() - 1 : 0, MAX_WRITE_WORKERS);
+    if (workers != m_writePool.GetWorkerCount()) {
+        m_writePool.Start(workers);
     }
-    
     return !m_gamepads.empty();
 }
 
+HapticController::HapticMode HapticController::ResolveMode(HapticMode preferred) {
+    if (preferred != HapticMode::Auto) {
+        return preferred;
+    }
+    // Try haptic first (GameInput 2.0), fall back to rumble (GameInput 1.0)
+#if GAMEINPUT_API_VERSION >= 2
+    return HapticMode::Haptic;
+#else
+    return HapticMode::Rumble;
+#endif
+}
+
+void HapticController::PublishSettings() {
+    OutputSettings published;
+    published.settings = m_mapper.GetSettings();
+    published.activeMode = m_activeMode;
+    published.profiles = m_profiles;
+    m_outputSettings.Publish(published);
+}
+
+void HapticController::ConfigureGamepad(GamepadInfo& gamepad, const HapticSettings& settings, HapticMode activeMode,
+                                        const std::map<std::string, HapticSettings>& profiles) {
+    const auto profile = gamepad.id.empty() ? profiles.end() : profiles.find(gamepad.id);
+    gamepad.hasProfile = profile != profiles.end();
+    const HapticSettings& applied = gamepad.hasProfile ? profile->second : settings;
+    gamepad.mapper.SetSettings(applied);
+    gamepad.emulation = (gamepad.hasProfile ? applied.preferredMode : activeMode) == HapticMode::HapticEmulation;
+}
+
 void HapticController::UpdateDevices() {
     // Periodically check for new devices (less frequently)
     auto now = std::chrono::steady_clock::now();
@@ -138,100 +170,378 @@ void HapticController::UpdateDevices() {
     }
 }
 
-void HapticController::ProcessAudioFeatures(const AudioProcessor::AudioFeatures& features) {
-    if (m_gamepads.empty()) {
+HapticController::WriteStats HapticController::GetWriteStats() const {
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    WriteStats stats;
+    for (const auto& gamepad : m_gamepads) {
+        stats.issued += gamepad.writesIssued;
+        stats.suppressed += gamepad.writesSuppressed;
+    }
+    return stats;
+}
+
+size_t HapticController::GetGamepadCount() const {
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    return m_gamepads.size();
+}
+
+void HapticController::SetHapticSettings(const HapticSettings& settings) {
+    std::lock_guard<std::mutex> lock(m_mapperMutex);
+    m_mapper.SetSettings(settings);
+    m_activeMode = ResolveMode(settings.preferredMode);
+    PublishSettings();
+}
+
+void HapticController::SetDeviceProfile(const std::string& deviceId, const HapticSettings& settings) {
+    std::lock_guard<std::mutex> lock(m_mapperMutex);
+    m_profiles[deviceId] = settings;
+    PublishSettings();
+}
+
+void HapticController::ClearDeviceProfile(const std::string& deviceId) {
+    std::lock_guard<std::mutex> lock(m_mapperMutex);
+    m_profiles.erase(deviceId);
+    PublishSettings();
+}
+
+void HapticController::SetDeviceProfiles(const std::map<std::string, HapticSettings>& profiles) {
+    std::lock_guard<std::mutex> lock(m_mapperMutex);
+    m_profiles = profiles;
+    PublishSettings();
+}
+
+std::string HapticController::GetDeviceId(size_t index) const {
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    return index < m_gamepads.size() ? m_gamepads[index].id : std::string();
+}
+
+HapticController::HapticSettings HapticController::GetHapticSettings() const {
+    std::lock_guard<std::mutex> lock(m_mapperMutex);
+    return m_mapper.GetSettings();
+}
+
+void HapticController::SetLookAhead(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_featureMutex);
+    m_timeline.assign(enabled ? LOOKAHEAD_BLOCKS : 0, FeatureSample{});
+    m_timelineFirst = 0;
+    m_timelineCount = 0;
+    m_lookAhead = enabled;
+}
+
+void HapticController::ProcessAudioFeatures(const AudioProcessor::AudioFeatures& features, const BlockTimestamps& timestamps) {
+    const auto now = std::chrono::steady_clock::now();
+    const auto blockStart = timestamps.capture != BlockTimestamps::Clock::time_point{} ? timestamps.capture : now;
+
+    FeatureState& state = m_featureState;
+
+    // Onset times are relative to the block's first frame; the output thread
+    // hands them to each bursting device with that device's delay
+    const double blockTime = std::chrono::duration<double>(blockStart - m_timeBase).count();
+    for (uint32_t i = 0; i < features.onsetCount; ++i) {
+        state.onsets[state.onsetTotal++ % MAX_PENDING_ONSETS] = { blockTime + features.onsets[i].time, features.onsets[i].strength };
+    }
+
+    if (m_lookAhead) {
+        std::lock_guard<std::mutex> lock(m_featureMutex);
+        // A source that runs further ahead than the buffer loses its oldest blocks
+        if (m_timelineCount == m_timeline.size()) {
+            m_timelineFirst = (m_timelineFirst + 1) % m_timeline.size();
+            --m_timelineCount;
+        }
+        FeatureSample& sample = m_timeline[(m_timelineFirst + m_timelineCount) % m_timeline.size()];
+        ++m_timelineCount;
+        sample.features = features;
+        sample.time = blockStart;
+        sample.timestamps = timestamps;
+        sample.sequence = m_nextSequence++;
+    } else {
+        state.previous = state.latest;
+        state.latest.features = features;
+        state.latest.time = now;
+        state.latest.timestamps = timestamps;
+        state.latest.sequence = m_nextSequence++;
+    }
+
+    m_features.Publish(state);
+}
+
+void HapticController::StopOutputThread() {
+    if (!m_outputThread.joinable()) {
         return;
     }
+    m_outputRunning = false;
+    m_outputTimer.Interrupt();
+    m_outputThread.join();
+}
 
-    auto now = std::chrono::steady_clock::now();
-    float deltaTime = std::chrono::duration<float>(now - m_lastUpdate).count();
-    m_lastUpdate = now;
+void HapticController::OutputLoop() {
+    uint32_t periodMs = 0;
+    while (m_outputRunning) {
+        // Re-anchor the schedule when the update rate is changed (the
+        // snapshot adopted by the last tick)
+        const uint32_t rateMs = (std::max)(m_outputSettings.Get().settings.updateRateMs, 1u);
+        if (rateMs != periodMs) {
+            periodMs = rateMs;
+            m_outputTimer.Start(std::chrono::milliseconds(periodMs));
+        }
+
+        const uint64_t ticks = m_outputTimer.Wait();
+        if (ticks == 0) {
+            break;
+        }
 
-    // Update haptics for all connected gamepads
-    for (auto& gamepad : m_gamepads) {
-        UpdateGamepadHaptics(gamepad, features);
+        // Smoothing runs on the schedule's clock, so it is independent of wake-up jitter
+        RunOutputTick(std::chrono::duration<float>(m_outputTimer.GetPeriod() * ticks).count());
     }
 }
 
-void HapticController::UpdateGamepadHaptics(GamepadInfo& gamepad, const AudioProcessor::AudioFeatures& features) {
-    if (!gamepad.device) {
+void HapticController::RunOutputTick(float deltaTime) {
+    if (m_manualOverride) {
         return;
     }
 
-    // Calculate target intensities based on audio features
-    float targetLeftMotor = 0.0f;
-    float targetRightMotor = 0.0f;
-    float targetLeftTrigger = 0.0f;
-    float targetRightTrigger = 0.0f;
+    const auto now = std::chrono::steady_clock::now();
+    FeatureState state;
+    m_features.Read(state);
+    FeatureSample previous;
+    FeatureSample latest;
+    if (!m_lookAhead) {
+        previous = state.previous;
+        latest = state.latest;
+    }
 
-    if (m_settings.useRumbleMotors) {
-        // Map bass to left motor, treble to right motor
-        if (m_settings.useLowFrequencyMotor) {
-            targetLeftMotor = features.bass * m_settings.bassIntensity;
+    // Onsets added since the last tick, oldest first
+    OnsetEvent onsets[MAX_PENDING_ONSETS];
+    size_t onsetCount = 0;
+    const uint64_t firstOnset = (std::max)(m_onsetsTaken, state.onsetTotal - (std::min<uint64_t>)(state.onsetTotal, MAX_PENDING_ONSETS));
+    for (uint64_t i = firstOnset; i < state.onsetTotal; ++i) {
+        onsets[onsetCount++] = state.onsets[i % MAX_PENDING_ONSETS];
+    }
+    m_onsetsTaken = state.onsetTotal;
+
+    // Each device maps with its own profile; the writes then go out in
+    // parallel, so the tick costs about one write however many pads there are
+    std::lock_guard<std::mutex> deviceLock(m_deviceMutex);
+    if (m_outputSettings.Update()) {
+        const OutputSettings& published = m_outputSettings.Get();
+        for (auto& gamepad : m_gamepads) {
+            ConfigureGamepad(gamepad, published.settings, published.activeMode, published.profiles);
         }
-        
-        if (m_settings.useHighFrequencyMotor) {
-            targetRightMotor = features.treble * m_settings.trebleIntensity;
+    }
+    m_writeList.clear();
+    for (size_t i = 0; i < m_gamepads.size(); ++i) {
+        if (UpdateGamepadHaptics(i, previous, latest, onsets, onsetCount, now, deltaTime)) {
+            m_writeList.push_back(i);
         }
-        
-        // Add overall volume contribution to both motors
-        float volumeContribution = features.volume * m_settings.volumeIntensity * 0.5f;
-        targetLeftMotor += volumeContribution;
-        targetRightMotor += volumeContribution;
-    }
-
-    if (m_settings.useImpulseMotor) {
-        // Use trigger motors for dynamic range and peaks
-        float dynamicContribution = features.dynamic_range * m_settings.dynamicIntensity;
-        targetLeftTrigger = dynamicContribution;
-        targetRightTrigger = dynamicContribution;
-        
-        // Add peak information to triggers
-        float peakContribution = features.peak * 0.3f;
-        targetLeftTrigger += peakContribution;
-        targetRightTrigger += peakContribution;
-    }
-
-    // Clamp values to valid range [0, 1]
-    targetLeftMotor = std::clamp(targetLeftMotor, 0.0f, 1.0f);
-    targetRightMotor = std::clamp(targetRightMotor, 0.0f, 1.0f);
-    targetLeftTrigger = std::clamp(targetLeftTrigger, 0.0f, 1.0f);
-    targetRightTrigger = std::clamp(targetRightTrigger, 0.0f, 1.0f);
-
-    // Apply smooth transitions
-    auto now = std::chrono::steady_clock::now();
-    float deltaTime = std::chrono::duration<float>(now - gamepad.lastUpdate).count();
-    gamepad.lastUpdate = now;
-
-    gamepad.currentLeftMotor = SmoothTransition(gamepad.currentLeftMotor, targetLeftMotor, deltaTime);
-    gamepad.currentRightMotor = SmoothTransition(gamepad.currentRightMotor, targetRightMotor, deltaTime);
-    gamepad.currentLeftTrigger = SmoothTransition(gamepad.currentLeftTrigger, targetLeftTrigger, deltaTime);
-    gamepad.currentRightTrigger = SmoothTransition(gamepad.currentRightTrigger, targetRightTrigger, deltaTime);
-
-    // Apply haptic feedback using GameInput 2.0 API
-    GameInputRumbleParams params = {};
-    params.lowFrequency = gamepad.currentLeftMotor;
-    params.highFrequency = gamepad.currentRightMotor;
-    params.leftTrigger = gamepad.currentLeftTrigger;
-    params.rightTrigger = gamepad.currentRightTrigger;
-    
-    gamepad.device->SetRumbleState(&params);
+    }
+
+    // Devices play the timeline at their own latencies; only blocks every
+    // one of them is done with can go
+    if (m_lookAhead) {
+        uint32_t minLatencyMs = m_gamepads.empty() ? 0 : UINT32_MAX;
+        for (const auto& gamepad : m_gamepads) {
+            minLatencyMs = (std::min)(minLatencyMs, gamepad.mapper.GetSettings().deviceLatencyMs);
+        }
+        PruneTimeline(now + std::chrono::milliseconds(minLatencyMs));
+    }
+
+    auto write = [this](size_t i) {
+        const size_t index = m_writeList[i];
+        m_gamepads[index].writeOk = ApplyLevels(index, m_gamepads[index].current);
+    };
+    m_writePool.Run(m_writeList.size(), write);
+
+    bool written = false;
+    for (size_t index : m_writeList) {
+        written |= m_gamepads[index].writeOk;
+    }
+    if (written) {
+        RecordOutputLatency(latest, std::chrono::steady_clock::now());
+    }
+}
+
+void HapticController::RecordOutputLatency(const FeatureSample& latest, std::chrono::steady_clock::time_point writeTime) {
+    // Once per block: its first write is when it reached the motors. Blocks
+    // superseded before any write, or whose change was filtered out, have no
+    // output latency.
+    LatencyTracker* tracker = m_latencyTracker;
+    if (!tracker || latest.sequence == 0 || latest.sequence == m_reportedSequence) {
+        return;
+    }
+    m_reportedSequence = latest.sequence;
+
+    const BlockTimestamps::Clock::time_point unset{};
+    if (latest.timestamps.analyzed != unset) {
+        tracker->Record(LatencyTracker::Stage::Output, writeTime - latest.timestamps.analyzed);
+    }
+    if (latest.timestamps.capture != unset) {
+        tracker->Record(LatencyTracker::Stage::EndToEnd, writeTime - latest.timestamps.capture);
+    }
 }
 
-float HapticController::SmoothTransition(float current, float target, float deltaTime) {
-    if (m_settings.fadeTimeMs == 0) {
+HapticMapper::MotorLevels HapticController::InterpolateTarget(const HapticMapper& mapper, const FeatureSample& previous,
+                                                              const FeatureSample& latest, std::chrono::steady_clock::time_point now) {
+    if (latest.sequence == 0 || now - latest.time > STALE_FEATURES) {
+        return {};
+    }
+
+    HapticMapper::MotorLevels target = mapper.MapFeatures(latest.features);
+    if (previous.sequence == 0) {
         return target;
     }
-    
-    float fadeRate = 1000.0f / static_cast<float>(m_settings.fadeTimeMs); // Convert ms to rate per second
-    float maxChange = fadeRate * deltaTime;
-    
-    float difference = target - current;
-    if (std::abs(difference) <= maxChange) {
+
+    // Blocks arrive at the capture cadence (10 ms periods, 1024-frame file
+    // chunks, ...), not the tick's. Play each block one block-interval late,
+    // ramping from the previous one, so ticks between arrivals see a line
+    // rather than a staircase.
+    const auto gap = latest.time - previous.time;
+    if (gap <= std::chrono::steady_clock::duration::zero() || gap > STALE_FEATURES) {
         return target;
     }
-    
-    return current + (difference > 0 ? maxChange : -maxChange);
+    const float interval = std::chrono::duration<float>(gap).count();
+    const float t = std::clamp(std::chrono::duration<float>(now - latest.time).count() / interval, 0.0f, 1.0f);
+    return Lerp(mapper.MapFeatures(previous.features), target, t);
+}
+
+void HapticController::TimelineTargets(const HapticMapper& mapper, std::chrono::steady_clock::time_point playTime,
+                                       std::chrono::steady_clock::duration step, HapticMapper::MotorLevels* targets, size_t count,
+                                       uint64_t& cursor, FeatureSample& latest) {
+    std::lock_guard<std::mutex> lock(m_featureMutex);
+    const size_t size = m_timeline.size();
+    auto block = [&](size_t i) -> const FeatureSample& { return m_timeline[(m_timelineFirst + i) % size]; };
+
+    // Sequences in the timeline are consecutive, so the cursor maps straight
+    // to an index. Start from the block played last tick and move to the one
+    // playing now (back as well, if this device's latency was lowered).
+    size_t b = 0;
+    if (m_timelineCount > 0 && cursor > block(0).sequence) {
+        b = static_cast<size_t>(std::min<uint64_t>(cursor - block(0).sequence, m_timelineCount - 1));
+    }
+    while (b > 0 && block(b).time > playTime) {
+        --b;
+    }
+    while (b + 1 < m_timelineCount && block(b + 1).time <= playTime) {
+        ++b;
+    }
+    if (m_timelineCount > 0 && block(b).time <= playTime) {
+        latest = block(b);
+        cursor = block(b).sequence;
+    }
+
+    // Sample the levels at playTime + i * step, ramping between consecutive
+    // blocks as if the features were taken at block starts
+    for (size_t i = 0; i < count; ++i) {
+        const auto time = playTime + step * static_cast<int>(i);
+        while (b + 1 < m_timelineCount && block(b + 1).time <= time) {
+            ++b;
+        }
+        if (m_timelineCount == 0 || block(b).time > time) {
+            targets[i] = {};    // Nothing playing yet
+            continue;
+        }
+
+        const FeatureSample& current = block(b);
+        if (b + 1 == m_timelineCount) {
+            // Past the end of what was delivered (source stopped or fell behind)
+            targets[i] = time - current.time > STALE_FEATURES ? HapticMapper::MotorLevels{} : mapper.MapFeatures(current.features);
+            continue;
+        }
+
+        const FeatureSample& next = block(b + 1);
+        const auto gap = next.time - current.time;
+        if (gap > STALE_FEATURES) {
+            targets[i] = mapper.MapFeatures(current.features);
+            continue;
+        }
+        const float t = std::chrono::duration<float>(time - current.time).count() / std::chrono::duration<float>(gap).count();
+        targets[i] = Lerp(mapper.MapFeatures(current.features), mapper.MapFeatures(next.features), std::clamp(t, 0.0f, 1.0f));
+    }
+}
+
+void HapticController::PruneTimeline(std::chrono::steady_clock::time_point playTime) {
+    std::lock_guard<std::mutex> lock(m_featureMutex);
+    const size_t size = m_timeline.size();
+    auto block = [&](size_t i) -> const FeatureSample& { return m_timeline[(m_timelineFirst + i) % size]; };
+
+    // Keep the block playing at playTime
+    while (m_timelineCount > 1 && block(1).time <= playTime) {
+        m_timelineFirst = (m_timelineFirst + 1) % size;
+        --m_timelineCount;
+    }
+}
+
+bool HapticController::UpdateGamepadHaptics(size_t index, const FeatureSample& previous, FeatureSample& latest,
+                                            const OnsetEvent* onsets, size_t onsetCount,
+                                            std::chrono::steady_clock::time_point now, float deltaTime) {
+    GamepadInfo& gamepad = m_gamepads[index];
+    HapticMapper& mapper = gamepad.mapper;
+    const HapticSettings& settings = mapper.GetSettings();
+
+    // Live, bursts play a fixed delay after the sound was captured, so every
+    // onset gets the same latency instead of whatever is left of the current
+    // output period. With look-ahead, onset times are playback times and
+    // bursts go out early by the device latency instead.
+    if (gamepad.emulation && settings.emulationOnsets) {
+        const double offset = m_lookAhead ? -static_cast<double>(settings.deviceLatencyMs) / 1000.0 : settings.emulationOnsetDelay;
+        for (size_t i = 0; i < onsetCount; ++i) {
+            mapper.ScheduleOnset(onsets[i].time + offset, onsets[i].strength);
+        }
+    }
+
+    // targets[0] is due now; with look-ahead the rest are the upcoming
+    // levels the fade has to ramp towards in time
+    HapticMapper::MotorLevels targets[HapticMapper::MAX_RAMP_STEPS];
+    size_t targetCount = 1;
+    if (m_lookAhead) {
+        // The motors respond deviceLatencyMs after a write, so they play the audio that far ahead
+        const auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(deltaTime));
+        targetCount = gamepad.emulation ? 1 : mapper.GetRampSteps(deltaTime);
+        TimelineTargets(mapper, now + std::chrono::milliseconds(settings.deviceLatencyMs), step, targets, targetCount,
+                        gamepad.timelineCursor, latest);
+    } else {
+        targets[0] = InterpolateTarget(mapper, previous, latest, now);
+    }
+
+    // Apply smooth transitions. The fade keeps running on skipped ticks, so a
+    // deferred write sends where the fade is now, not where it was. Emulated
+    // bursts go out as they are: a fade would flatten a 50 ms burst.
+    if (gamepad.emulation) {
+        gamepad.current = mapper.ProcessEmulation(targets[0], std::chrono::duration<double>(now - m_timeBase).count());
+    } else {
+        gamepad.current = mapper.SmoothAhead(gamepad.current, targets, targetCount, deltaTime);
+    }
+
+    // Refill the write budget. The bucket holds two writes: enough to carry
+    // the fractional refill between ticks (a 60/s budget on 62.5 ticks/s must
+    // not halve the rate), too little for a real burst.
+    const bool limited = settings.maxWritesPerSecond > 0;
+    if (limited) {
+        gamepad.writeBudget = (std::min)(gamepad.writeBudget + settings.maxWritesPerSecond * deltaTime, 2.0f);
+    }
+
+    // Skipped changes stay pending (written is untouched), so they go out on
+    // the next tick with budget
+    if (!NeedsWrite(gamepad.current, gamepad.written, settings.writeThreshold) ||
+        (limited && gamepad.writeBudget < 1.0f)) {
+        ++gamepad.writesSuppressed;
+        return false;
+    }
+    if (limited) {
+        gamepad.writeBudget -= 1.0f;
+    }
+    return true;
+}
+
+bool HapticController::ApplyLevels(size_t index, const HapticMapper::MotorLevels& levels) {
+    if (!m_sink->Write(index, levels)) {
+        return false;
+    }
+    GamepadInfo& gamepad = m_gamepads[index];
+    gamepad.lastUpdate = std::chrono::steady_clock::now();
+    gamepad.current = levels;
+    gamepad.written = levels;
+    ++gamepad.writesIssued;
+    return true;
 }
 
 void HapticController::SetRumble(float leftMotor, float rightMotor, float leftTrigger, float rightTrigger) {
@@ -240,58 +550,41 @@ void HapticController::SetRumble(float leftMotor, float rightMotor, float leftTr
     leftTrigger = std::clamp(leftTrigger, 0.0f, 1.0f);
     rightTrigger = std::clamp(rightTrigger, 0.0f, 1.0f);
 
-    // Handle haptic emulation mode
+    HapticMapper::MotorLevels levels;
+    levels.leftMotor = leftMotor;
+    levels.rightMotor = rightMotor;
+    levels.leftTrigger = leftTrigger;
+    levels.rightTrigger = rightTrigger;
+
+    // Handle haptic emulation mode. Nothing schedules onsets for manual
+    // levels, so they burst on the fixed cadence.
     if (m_activeMode == HapticMode::HapticEmulation) {
-        ProcessHapticEmulation(leftMotor, rightMotor, leftTrigger, rightTrigger);
-        return;
+        double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_timeBase).count();
+        std::lock_guard<std::mutex> lock(m_mapperMutex);
+        levels = m_mapper.ProcessEmulation(levels, now, false);
     }
 
-    // Standard rumble mode
-    for (auto& gamepad : m_gamepads) {
-        if (gamepad.device) {
-            GameInputRumbleParams params = {};
-            params.lowFrequency = leftMotor;
-            params.highFrequency = rightMotor;
-            params.leftTrigger = leftTrigger;
-            params.rightTrigger = rightTrigger;
-            
-            gamepad.device->SetRumbleState(&params);
-            
-            gamepad.currentLeftMotor = leftMotor;
-            gamepad.currentRightMotor = rightMotor;
-            gamepad.currentLeftTrigger = leftTrigger;
-            gamepad.currentRightTrigger = rightTrigger;
-        }
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    m_manualOverride = true;
+    for (size_t i = 0; i < m_gamepads.size(); ++i) {
+        ApplyLevels(i, levels);
     }
 }
 
 void HapticController::StopAllHaptics() {
-    for (auto& gamepad : m_gamepads) {
-        if (gamepad.device) {
-            GameInputRumbleParams params = {};
-            params.lowFrequency = 0.0f;
-            params.highFrequency = 0.0f;
-            params.leftTrigger = 0.0f;
-            params.rightTrigger = 0.0f;
-            
-            gamepad.device->SetRumbleState(&params);
-            
-            gamepad.currentLeftMotor = 0.0f;
-            gamepad.currentRightMotor = 0.0f;
-            gamepad.currentLeftTrigger = 0.0f;
-            gamepad.currentRightTrigger = 0.0f;
-        }
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    m_manualOverride = false;
+    for (size_t i = 0; i < m_gamepads.size(); ++i) {
+        ApplyLevels(i, HapticMapper::MotorLevels{});
     }
 }
 
 void HapticController::CleanupDevices() {
-    for (auto& gamepad : m_gamepads) {
-        if (gamepad.device) {
-            // Stop all haptic feedback before cleanup
-            GameInputRumbleParams params = {};
-            gamepad.device->SetRumbleState(&params);
-            gamepad.device->Release();
-        }
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    m_writePool.Stop();
+    if (m_sink) {
+        m_sink->Shutdown();
+        m_sink.reset();
     }
     m_gamepads.clear();
 }
@@ -306,110 +599,3 @@ const char* HapticController::GetHapticModeString() const {
         default: return "Unknown";
     }
 }
-
-void HapticController::ProcessHapticEmulation(float leftMotor, float rightMotor, float leftTrigger, float rightTrigger) {
-    auto now = std::chrono::steady_clock::now();
-    
-    // Calculate overall intensity from all inputs
-    float totalIntensity = (leftMotor + rightMotor + leftTrigger + rightTrigger) / 4.0f;
-    totalIntensity *= m_settings.emulationIntensity;
-    
-    // Check if we should trigger a new haptic burst
-    bool shouldTriggerBurst = false;
-    
-    // Only trigger if there's significant intensity AND volume is above threshold
-    if (totalIntensity > 0.1f && totalIntensity >= m_settings.emulationVolumeThreshold) {
-        auto timeSinceLastBurst = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastHapticBurst).count() / 1000.0f;
-        
-        if (timeSinceLastBurst >= m_settings.emulationMinInterval) {
-            shouldTriggerBurst = true;
-            m_lastHapticBurst = now;
-            m_hapticBurstActive = true;
-            m_hapticBurstStart = now;
-            
-            // Alternate between left and right motor
-            m_leftMotorTurn = !m_leftMotorTurn;
-        }
-    }
-    
-    // Check if current burst should end
-    if (m_hapticBurstActive) {
-        auto burstDuration = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_hapticBurstStart).count() / 1000.0f;
-        if (burstDuration >= m_settings.emulationBurstDuration) {
-            m_hapticBurstActive = false;
-        }
-    }
-    
-    // Apply haptic burst or stop
-    for (auto& gamepad : m_gamepads) {
-        if (gamepad.device) {
-            GameInputRumbleParams params = {};
-            
-            if (m_hapticBurstActive || shouldTriggerBurst) {
-                // Strong, short burst - 3x intensity, alternating left/right
-                float burstIntensity = std::clamp(totalIntensity, 0.0f, 1.0f);
-                
-                if (m_leftMotorTurn) {
-                    // Left motor burst
-                    params.lowFrequency = burstIntensity;    // Strong left motor
-                    params.highFrequency = 0.0f;             // Silent right motor
-                } else {
-                    // Right motor burst  
-                    params.lowFrequency = 0.0f;              // Silent left motor
-                    params.highFrequency = burstIntensity;   // Strong right motor
-                }
-                
-                // Light trigger feedback for both
-                params.leftTrigger = burstIntensity * 0.3f;
-                params.rightTrigger = burstIntensity * 0.3f;
-            } else {
-                // No haptic feedback - complete silence between bursts
-                params.lowFrequency = 0.0f;
-                params.highFrequency = 0.0f;
-                params.leftTrigger = 0.0f;
-                params.rightTrigger = 0.0f;
-            }
-            
-            gamepad.device->SetRumbleState(&params);
-            
-            gamepad.currentLeftMotor = params.lowFrequency;
-            gamepad.currentRightMotor = params.highFrequency;
-            gamepad.currentLeftTrigger = params.leftTrigger;
-            gamepad.currentRightTrigger = params.rightTrigger;
-        }
-    }
-}
-
-void HapticController::DetectDeviceCapabilities(GamepadInfo& gamepad) {
-    if (!gamepad.device) return;
-
-    const GameInputDeviceInfo* deviceInfo = nullptr;
-    HRESULT hr = gamepad.device->GetDeviceInfo(&deviceInfo);
-
-    if (SUCCEEDED(hr) && deviceInfo) {
-        // GameInput 2.0 supports rumble via SetRumbleState
-        gamepad.supportsRumble = true;
-        gamepad.rumbleMotorCount = 4; // Low/High frequency + Left/Right triggers
-        
-        // Check for haptic support
-        GameInputHapticInfo hapticInfo = {};
-        hr = gamepad.device->GetHapticInfo(&hapticInfo);
-        if (SUCCEEDED(hr)) {
-            gamepad.supportsHaptics = true;
-            gamepad.hapticMotorCount = hapticInfo.locationCount;
-        } else {
-            gamepad.supportsHaptics = false;
-            gamepad.hapticMotorCount = 0;
-        }
-        
-        // Device capabilities detected (details shown in device discovery)
-    } else {
-        std::cerr << "Failed to get device info: " << std::hex << hr << std::endl;
-        // Default to basic rumble support
-        gamepad.supportsRumble = true;
-        gamepad.rumbleMotorCount = 4;
-        gamepad.supportsHaptics = false;
-        gamepad.hapticMotorCount = 0;
-    }
-}
-
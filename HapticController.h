@@ -1,134 +1,246 @@
 #pragma once
 
-#include "GameInputConfig.h"
-#include <GameInput.h>
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 #include <chrono>
 #include "AudioProcessor.h"
+#include "HapticMapper.h"
+#include "IHapticSink.h"
+#include "LatencyTracker.h"
+#include "LatestValue.h"
+#include "PeriodicTimer.h"
+#include "SettingsSnapshot.h"
+#include "WorkerPool.h"
 
-
-// Use appropriate GameInput namespace
-#if GAMEINPUT_API_VERSION >= 2
-using namespace GameInput::v2;
-#elif GAMEINPUT_API_VERSION >= 1
-using namespace GameInput::v1;
-#endif
-
+// Maps audio features to haptic output and drives an IHapticSink
+// (GameInput gamepads, or a RecordingHapticSink in tests/benchmarks).
+// Every device maps with its own HapticMapper (global settings or a
+// per-device profile); each tick's writes go out in parallel on a small
+// worker pool, so a slow driver call on one pad does not delay the others.
 class HapticController {
 public:
-    enum class HapticMode {
-        Auto,           // Automatically detect best available mode
-        Rumble,         // Use traditional rumble API (GameInput 1.0)
-        Haptic,         // Use modern haptic API (GameInput 2.0)
-        Hybrid,         // Use both if available
-        HapticEmulation // Strong, short bursts to simulate haptics
-    };
-
-    struct HapticSettings {
-        float bassIntensity = 0.0f;      // Intensity multiplier for bass (0.0 - 2.0)
-        float trebleIntensity = 0.0f;    // Intensity multiplier for treble (0.0 - 2.0)
-        float volumeIntensity = 2.0f;    // Intensity multiplier for overall volume (0.0 - 2.0)
-        float dynamicIntensity = 2.0f;   // Intensity multiplier for dynamic range (0.0 - 2.0)
-        
-        // Motor assignments (which motors to use for different frequency ranges)
-        bool useLowFrequencyMotor = true;   // Use low-frequency motor for bass
-        bool useHighFrequencyMotor = true;  // Use high-frequency motor for treble
-        bool useImpulseMotor = true;        // Use impulse triggers for dynamics
-        bool useRumbleMotors = true;        // Use traditional rumble motors
-        
-        // Timing settings
-        uint32_t updateRateMs = 16;         // Update rate in milliseconds (~60 FPS)
-        uint32_t fadeTimeMs = 100;          // Fade time for smooth transitions
-        
-        // API preference
-        HapticMode preferredMode = HapticMode::HapticEmulation;  // Preferred haptic mode
-        
-        // Haptic emulation settings
-        float emulationBurstDuration = 0.05f;  // Duration of haptic bursts in seconds (0.01 - 0.2)
-        float emulationMinInterval = 0.1f;     // Minimum interval between bursts in seconds (0.05 - 0.5)
-        float emulationIntensity = 3.0f;       // Intensity multiplier for emulated haptics (3x stronger)
-        float emulationVolumeThreshold = 0.3f; // Volume threshold - no haptics below 30%
-    };
+    // Mapping math and settings live in the device-independent HapticMapper
+    using HapticMode = HapticMapper::HapticMode;
+    using HapticSettings = HapticMapper::HapticSettings;
 
     HapticController();
     ~HapticController();
 
+    // Opens the platform's default sink (GameInput on Windows)
     bool Initialize();
+    // Drives the given sink instead; shared, so a caller can keep inspecting
+    // e.g. a RecordingHapticSink after Shutdown. Without the output thread,
+    // the caller advances output with RunOutputTick (tests, benchmarks).
+    bool Initialize(std::shared_ptr<IHapticSink> sink, bool startOutputThread = true);
     void Shutdown();
 
     // Device management
     bool FindGamepads();
-    size_t GetGamepadCount() const { return m_gamepads.size(); }
+    size_t GetGamepadCount() const;
     std::string GetDeviceStatusString() const {
-        return "Connected gamepads: " + std::to_string(m_gamepads.size());
+        return "Connected gamepads: " + std::to_string(GetGamepadCount());
     }
     
-    // Haptic feedback
-    void ProcessAudioFeatures(const AudioProcessor::AudioFeatures& features);
-    void SetHapticSettings(const HapticSettings& settings) { m_settings = settings; }
-    const HapticSettings& GetHapticSettings() const { return m_settings; }
+    // Haptic feedback. Features are only recorded here (one producer thread,
+    // cheap, lock-free unless look-ahead is on); the output thread maps them and writes to the devices every
+    // updateRateMs, independent of how often or how irregularly they arrive.
+    // timestamps (optional) are the block's stages so far; the output thread
+    // adds the Output and EndToEnd stages on its first write after the block.
+    // In HapticEmulation mode the block's onsets are scheduled as bursts,
+    // emulationOnsetDelay after their capture time.
+    void ProcessAudioFeatures(const AudioProcessor::AudioFeatures& features, const BlockTimestamps& timestamps = {});
+
+    // Settings, profiles and mode changes reach the output thread as one
+    // snapshot, adopted at the start of its next tick; it never waits for
+    // them. A mode change needs no re-Initialize.
+    void SetHapticSettings(const HapticSettings& settings);
+    HapticSettings GetHapticSettings() const;
+
+    // Per-device profiles, keyed by IHapticSink::GetDeviceId. A device with a
+    // profile takes its mapping, motor assignments, smoothing, write
+    // filtering and mode (bursts if preferredMode is HapticEmulation,
+    // continuous otherwise) from it instead of the global settings. Profiles
+    // also apply to devices connected later.
+    void SetDeviceProfile(const std::string& deviceId, const HapticSettings& settings);
+    void ClearDeviceProfile(const std::string& deviceId);
+    // Replaces all profiles at once (e.g. from a reloaded config file)
+    void SetDeviceProfiles(const std::map<std::string, HapticSettings>& profiles);
+    std::string GetDeviceId(size_t index) const;     // Empty if unknown
     
-    // Manual control
+    // Manual control. SetRumble levels hold (the output thread pauses) until StopAllHaptics.
     void SetRumble(float leftMotor, float rightMotor, float leftTrigger = 0.0f, float rightTrigger = 0.0f);
     void StopAllHaptics();
+
+    // One output period: map the newest features, smooth (or, in
+    // HapticEmulation mode, turn into bursts) and write each device. The output thread calls this every updateRateMs.
+    void RunOutputTick(float deltaTime);
     
     // Status
-    bool IsInitialized() const { return m_gameInput != nullptr; }
+    bool IsInitialized() const { return m_sink != nullptr; }
     void UpdateDevices(); // Call periodically to detect new/removed devices
     HapticMode GetActiveHapticMode() const { return m_activeMode; }
     const char* GetHapticModeString() const;
 
+    // Device writes made vs. skipped (unchanged levels or over budget), summed over connected gamepads
+    struct WriteStats {
+        uint64_t issued = 0;
+        uint64_t suppressed = 0;
+    };
+    WriteStats GetWriteStats() const;
+
+    // Receives the Output and EndToEnd latency stages (nullptr = off). Not owned.
+    void SetLatencyTracker(LatencyTracker* tracker) { m_latencyTracker = tracker; }
+
+    // Look-ahead mode, for sources that deliver audio before it plays (e.g.
+    // FileCaptureSource::SetLookAhead). A block's capture timestamp is then
+    // its playback time: blocks are buffered (up to LOOKAHEAD_BLOCKS), each
+    // tick plays the audio deviceLatencyMs ahead of now, and fades start
+    // early enough to finish on time (HapticMapper::SmoothAhead), so ramps
+    // and bursts land when the sound does. The source has to run at least
+    // deviceLatencyMs + fadeTimeMs ahead. Writes precede playback, so no
+    // EndToEnd latency is recorded. Call before audio flows.
+    void SetLookAhead(bool enabled);
+    bool IsLookAhead() const { return m_lookAhead; }
+    static constexpr size_t LOOKAHEAD_BLOCKS = 512;
+
 private:
+    static constexpr size_t MAX_WRITE_WORKERS = 3;
+    static constexpr size_t MAX_PENDING_ONSETS = 16;
+
+    // Output state for one sink device (same index)
     struct GamepadInfo {
-        IGameInputDevice* device;
+        std::string id;             // IHapticSink::GetDeviceId
         std::chrono::steady_clock::time_point lastUpdate;
-        
-        // Device capabilities
-        bool supportsRumble;
-        bool supportsHaptics;
-        uint32_t hapticMotorCount;
-        uint32_t rumbleMotorCount;
+
+        // Mapping: profile or global settings, plus this device's burst state
+        HapticMapper mapper;
+        bool hasProfile;
+        bool emulation;             // Bursts instead of continuous output
         
         // Current haptic state
-        float currentLeftMotor;
-        float currentRightMotor;
-        float currentLeftTrigger;
-        float currentRightTrigger;
-        
-        GamepadInfo() : device(nullptr), supportsRumble(false), supportsHaptics(false),
-                       hapticMotorCount(0), rumbleMotorCount(0),
-                       currentLeftMotor(0), currentRightMotor(0),
-                       currentLeftTrigger(0), currentRightTrigger(0) {}
+        HapticMapper::MotorLevels current;  // Smoothed levels
+        HapticMapper::MotorLevels written;  // Last levels sent to the device
+
+        // Write filtering
+        float writeBudget;          // Token bucket, in writes
+        uint64_t writesIssued;
+        uint64_t writesSuppressed;
+        bool writeOk;               // Result of this tick's write
+
+        // Look-ahead: sequence of the block this device played last tick
+        uint64_t timelineCursor;
+
+        GamepadInfo() : hasProfile(false), emulation(false), writeBudget(1.0f), writesIssued(0), writesSuppressed(0),
+                        writeOk(false), timelineCursor(0) {}
     };
 
-    void CleanupDevices();
-    void UpdateGamepadHaptics(GamepadInfo& gamepad, const AudioProcessor::AudioFeatures& features);
-    float SmoothTransition(float current, float target, float deltaTime);
-    
-    // Device capability detection
-    void DetectDeviceCapabilities(GamepadInfo& gamepad);
-    
-    // Haptic emulation
-    void ProcessHapticEmulation(float leftMotor, float rightMotor, float leftTrigger, float rightTrigger);
+    // Everything the output thread maps with, published as one snapshot
+    struct OutputSettings {
+        HapticSettings settings;
+        HapticMode activeMode = HapticMode::Auto;
+        std::map<std::string, HapticSettings> profiles;
+    };
+
+    // An onset at seconds since m_timeBase, waiting for the output thread
+    struct OnsetEvent {
+        double time;
+        float strength;
+    };
+
+    struct FeatureSample {
+        AudioProcessor::AudioFeatures features{};
+        std::chrono::steady_clock::time_point time;
+        BlockTimestamps timestamps;
+        uint64_t sequence = 0;      // 0 = no block yet
+    };
 
+    // What the audio thread hands the output thread after every block
+    struct FeatureState {
+        FeatureSample previous;     // Two newest blocks (not used with look-ahead)
+        FeatureSample latest;
+        OnsetEvent onsets[MAX_PENDING_ONSETS];  // Ring of the newest onsets
+        uint64_t onsetTotal = 0;    // Onsets ever added; the next goes to onsetTotal % MAX_PENDING_ONSETS
+    };
+
+    void CleanupDevices();
+    void OutputLoop();
+    void StopOutputThread();
+    // The mode Auto and the others resolve to on this GameInput version
+    static HapticMode ResolveMode(HapticMode preferred);
+    // Publishes m_mapper's settings, m_activeMode and m_profiles (needs m_mapperMutex)
+    void PublishSettings();
+    // Applies the device's profile, or the global settings
+    static void ConfigureGamepad(GamepadInfo& gamepad, const HapticSettings& settings, HapticMode activeMode,
+                                 const std::map<std::string, HapticSettings>& profiles);
+    static HapticMapper::MotorLevels InterpolateTarget(const HapticMapper& mapper, const FeatureSample& previous,
+                                                       const FeatureSample& latest, std::chrono::steady_clock::time_point now);
+    // Look-ahead: levels of the buffered audio playing at playTime + i * step
+    // for i < count; latest receives the block playing at playTime. Leaves
+    // the timeline as it is, since devices play it at different latencies;
+    // cursor is the device's position in it, kept between ticks.
+    void TimelineTargets(const HapticMapper& mapper, std::chrono::steady_clock::time_point playTime,
+                         std::chrono::steady_clock::duration step, HapticMapper::MotorLevels* targets, size_t count,
+                         uint64_t& cursor, FeatureSample& latest);
+    // Drops the blocks that finished playing before playTime, the earliest
+    // any device plays
+    void PruneTimeline(std::chrono::steady_clock::time_point playTime);
+    // Maps, smooths (or bursts) and filters one device; true if its new
+    // levels (in current) should be written this tick
+    bool UpdateGamepadHaptics(size_t index, const FeatureSample& previous, FeatureSample& latest,
+                              const OnsetEvent* onsets, size_t onsetCount,
+                              std::chrono::steady_clock::time_point now, float deltaTime);
+    void RecordOutputLatency(const FeatureSample& latest, std::chrono::steady_clock::time_point writeTime);
+    bool ApplyLevels(size_t index, const HapticMapper::MotorLevels& levels);
     
-    // GameInput
-    IGameInput* m_gameInput;
+    // Output devices; m_deviceMutex guards the sink, m_gamepads and the write batch
+    std::shared_ptr<IHapticSink> m_sink;
     std::vector<GamepadInfo> m_gamepads;
-    
+    mutable std::mutex m_deviceMutex;
+    WorkerPool m_writePool;
+    std::vector<size_t> m_writeList;    // Devices written this tick
 
+    // Global settings and profiles as last set (m_mapperMutex); m_mapper also
+    // runs the bursts of manual SetRumble calls, on the fixed cadence since
+    // they have no onsets. The output thread maps with the published copy in
+    // m_outputSettings instead.
+    HapticMapper m_mapper;
+    std::map<std::string, HapticSettings> m_profiles;
+    mutable std::mutex m_mapperMutex;
+    std::atomic<HapticMode> m_activeMode;
+    SettingsSnapshot<OutputSettings> m_outputSettings;
     
-    // Settings
-    HapticSettings m_settings;
-    HapticMode m_activeMode;
-    
-    // Timing
-    std::chrono::steady_clock::time_point m_lastUpdate;
-    
-    // Haptic emulation state
-    std::chrono::steady_clock::time_point m_lastHapticBurst;
-    bool m_hapticBurstActive;
-    std::chrono::steady_clock::time_point m_hapticBurstStart;
-    bool m_leftMotorTurn;  // Alternates between left and right motor
+    // Timing; the mapper works in seconds since this point
+    std::chrono::steady_clock::time_point m_timeBase;
+
+    // Feature hand-off: the audio thread updates its m_featureState and
+    // publishes a copy; the output thread reads the newest copy without
+    // either side waiting. Onsets older than the last MAX_PENDING_ONSETS
+    // when a tick reads them are dropped.
+    FeatureState m_featureState;            // Audio thread
+    uint64_t m_nextSequence;                // Audio thread
+    LatestValue<FeatureState> m_features;
+    uint64_t m_onsetsTaken;                 // Output thread: onsetTotal already scheduled
+
+    // Look-ahead: blocks by playback time, oldest first (ring, allocated
+    // once). Both threads edit it, so it is guarded by m_featureMutex.
+    std::mutex m_featureMutex;
+    std::atomic<bool> m_lookAhead;
+    std::vector<FeatureSample> m_timeline;
+    size_t m_timelineFirst;
+    size_t m_timelineCount;
+
+    // Latency reporting; m_reportedSequence is output-thread only
+    std::atomic<LatencyTracker*> m_latencyTracker;
+    uint64_t m_reportedSequence;
+
+    // Fixed-rate output thread
+    std::thread m_outputThread;
+    std::atomic<bool> m_outputRunning;
+    std::atomic<bool> m_manualOverride;
+    PeriodicTimer m_outputTimer;
 };
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "HapticMapper.h"
+#include <algorithm>
+#include <cmath>
+
+HapticMapper::HapticMapper()
+    : m_lastHapticBurst(0.0)
+    , m_hapticBurstActive(false)
+    , m_hapticBurstStart(0.0)
+    , m_leftMotorTurn(true)
+    , m_burstStrength(1.0f)
+    , m_pendingOnsets{}
+    , m_pendingFirst(0)
+    , m_pendingCount(0)
+{
+}
+
+HapticMapper::MotorLevels HapticMapper::MapFeatures(const AudioProcessor::AudioFeatures& features) const {
+    // Calculate target intensities based on audio features
+    MotorLevels target;
+
+    if (m_settings.useRumbleMotors) {
+        // Map bass to left motor, treble to right motor
+        if (m_settings.useLowFrequencyMotor) {
+            target.leftMotor = features.bassTrend.smoothed * m_settings.bassIntensity;
+        }
+
+        if (m_settings.useHighFrequencyMotor) {
+            target.rightMotor = features.trebleTrend.smoothed * m_settings.trebleIntensity;
+        }
+
+        // Add overall volume contribution to both motors
+        float volumeContribution = features.volumeTrend.smoothed * m_settings.volumeIntensity * 0.5f;
+        target.leftMotor += volumeContribution;
+        target.rightMotor += volumeContribution;
+    }
+
+    if (m_settings.useImpulseMotor) {
+        // Use trigger motors for dynamic range and peaks
+        float dynamicContribution = features.dynamic_range * m_settings.dynamicIntensity;
+        target.leftTrigger = dynamicContribution;
+        target.rightTrigger = dynamicContribution;
+
+        // Add peak information to triggers
+        float peakContribution = features.peak * 0.3f;
+        target.leftTrigger += peakContribution;
+        target.rightTrigger += peakContribution;
+    }
+
+    if (m_settings.useSpatialMapping) {
+        // The louder side keeps its levels; the other is scaled down by its
+        // relative level, so a hard-panned source drives one side only
+        const float loudest = std::max(features.left, features.right);
+        if (loudest > 0.0f) {
+            const float leftGain = features.left / loudest;
+            const float rightGain = features.right / loudest;
+            target.leftMotor *= leftGain;
+            target.leftTrigger *= leftGain;
+            target.rightMotor *= rightGain;
+            target.rightTrigger *= rightGain;
+        }
+    }
+
+    // The LFE channel is non-directional low end: straight to the low-frequency motor
+    if (m_settings.useRumbleMotors && m_settings.useLowFrequencyMotor) {
+        target.leftMotor += features.lfe * m_settings.lfeIntensity;
+    }
+
+    // Clamp values to valid range [0, 1]
+    target.leftMotor = std::clamp(target.leftMotor, 0.0f, 1.0f);
+    target.rightMotor = std::clamp(target.rightMotor, 0.0f, 1.0f);
+    target.leftTrigger = std::clamp(target.leftTrigger, 0.0f, 1.0f);
+    target.rightTrigger = std::clamp(target.rightTrigger, 0.0f, 1.0f);
+
+    // Pads differ in how strongly they render low levels; the curve evens that out
+    if (m_settings.responseCurve != 1.0f) {
+        target.leftMotor = std::pow(target.leftMotor, m_settings.responseCurve);
+        target.rightMotor = std::pow(target.rightMotor, m_settings.responseCurve);
+        target.leftTrigger = std::pow(target.leftTrigger, m_settings.responseCurve);
+        target.rightTrigger = std::pow(target.rightTrigger, m_settings.responseCurve);
+    }
+    return target;
+}
+
+HapticMapper::MotorLevels HapticMapper::Smooth(const MotorLevels& current, const MotorLevels& target, float deltaTime) const {
+    MotorLevels result;
+    result.leftMotor = SmoothTransition(current.leftMotor, target.leftMotor, deltaTime);
+    result.rightMotor = SmoothTransition(current.rightMotor, target.rightMotor, deltaTime);
+    result.leftTrigger = SmoothTransition(current.leftTrigger, target.leftTrigger, deltaTime);
+    result.rightTrigger = SmoothTransition(current.rightTrigger, target.rightTrigger, deltaTime);
+    return result;
+}
+
+HapticMapper::MotorLevels HapticMapper::SmoothAhead(const MotorLevels& current, const MotorLevels* targets, size_t count, float deltaTime) const {
+    MotorLevels target;
+    target.leftMotor = RampTarget(current, targets, count, &MotorLevels::leftMotor, deltaTime);
+    target.rightMotor = RampTarget(current, targets, count, &MotorLevels::rightMotor, deltaTime);
+    target.leftTrigger = RampTarget(current, targets, count, &MotorLevels::leftTrigger, deltaTime);
+    target.rightTrigger = RampTarget(current, targets, count, &MotorLevels::rightTrigger, deltaTime);
+    return Smooth(current, target, deltaTime);
+}
+
+float HapticMapper::RampTarget(const MotorLevels& current, const MotorLevels* targets, size_t count,
+                               float MotorLevels::* level, float deltaTime) const {
+    // This step and the i after it can each move maxChange (the rise or fade
+    // rate). A level i steps ahead that the later steps alone cannot reach
+    // has to be ramped to now.
+    for (size_t i = 1; i < count; ++i) {
+        const float change = targets[i].*level - current.*level;
+        const uint32_t rampMs = change > 0.0f ? m_settings.riseTimeMs : m_settings.fadeTimeMs;
+        if (rampMs > 0 && std::abs(change) > 1000.0f / static_cast<float>(rampMs) * deltaTime * static_cast<float>(i)) {
+            return targets[i].*level;
+        }
+    }
+    return targets[0].*level;
+}
+
+size_t HapticMapper::GetRampSteps(float stepSeconds) const {
+    const float rampSeconds = static_cast<float>(std::max(m_settings.fadeTimeMs, m_settings.riseTimeMs)) / 1000.0f;
+    const size_t steps = static_cast<size_t>(std::ceil(rampSeconds / std::max(stepSeconds, 1e-3f))) + 1;
+    return std::min(steps, MAX_RAMP_STEPS);
+}
+
+float HapticMapper::SmoothTransition(float current, float target, float deltaTime) const {
+    const uint32_t rampMs = target > current ? m_settings.riseTimeMs : m_settings.fadeTimeMs;
+    if (rampMs == 0) {
+        return target;
+    }
+
+    float fadeRate = 1000.0f / static_cast<float>(rampMs); // Convert ms to rate per second
+    float maxChange = fadeRate * deltaTime;
+
+    float difference = target - current;
+    if (std::abs(difference) <= maxChange) {
+        return target;
+    }
+
+    return current + (difference > 0 ? maxChange : -maxChange);
+}
+
+void HapticMapper::ResetEmulation(double timeSeconds) {
+    m_lastHapticBurst = timeSeconds;
+    m_hapticBurstActive = false;
+    m_hapticBurstStart = timeSeconds;
+    m_leftMotorTurn = true;
+    m_burstStrength = 1.0f;
+    m_pendingFirst = 0;
+    m_pendingCount = 0;
+}
+
+void HapticMapper::ScheduleOnset(double timeSeconds, float strength) {
+    if (m_pendingCount == MAX_PENDING_ONSETS) {
+        m_pendingFirst = (m_pendingFirst + 1) % MAX_PENDING_ONSETS;
+        --m_pendingCount;
+    }
+    m_pendingOnsets[(m_pendingFirst + m_pendingCount) % MAX_PENDING_ONSETS] = { timeSeconds, strength };
+    ++m_pendingCount;
+}
+
+float HapticMapper::TakeDueOnsets(double timeSeconds) {
+    float strength = 0.0f;
+    while (m_pendingCount > 0 && m_pendingOnsets[m_pendingFirst].time <= timeSeconds) {
+        strength = std::max(strength, m_pendingOnsets[m_pendingFirst].strength);
+        m_pendingFirst = (m_pendingFirst + 1) % MAX_PENDING_ONSETS;
+        --m_pendingCount;
+    }
+    return strength;
+}
+
+HapticMapper::MotorLevels HapticMapper::ProcessEmulation(const MotorLevels& levels, double timeSeconds, bool onsetGated) {
+    // Calculate overall intensity from all inputs
+    float totalIntensity = (levels.leftMotor + levels.rightMotor + levels.leftTrigger + levels.rightTrigger) / 4.0f;
+    totalIntensity *= m_settings.emulationIntensity;
+
+    // Check if we should trigger a new haptic burst
+    bool shouldTriggerBurst = false;
+
+    // Onset mode: only a due onset can start a burst. Onsets that fall in a
+    // quiet passage or too close to the last burst are dropped, not deferred.
+    float onsetStrength = 1.0f;
+    bool burstWanted = true;
+    if (m_settings.emulationOnsets && onsetGated) {
+        onsetStrength = TakeDueOnsets(timeSeconds);
+        burstWanted = onsetStrength > 0.0f;
+    }
+
+    // Only trigger if there's significant intensity AND volume is above threshold
+    if (burstWanted && totalIntensity > 0.1f && totalIntensity >= m_settings.emulationVolumeThreshold) {
+        double timeSinceLastBurst = timeSeconds - m_lastHapticBurst;
+
+        if (timeSinceLastBurst >= m_settings.emulationMinInterval) {
+            // Weak onsets still give a half-strength burst; clear hits the full one
+            m_burstStrength = 0.5f + 0.5f * onsetStrength;
+            shouldTriggerBurst = true;
+            m_lastHapticBurst = timeSeconds;
+            m_hapticBurstActive = true;
+            m_hapticBurstStart = timeSeconds;
+
+            // Alternate between left and right motor
+            m_leftMotorTurn = !m_leftMotorTurn;
+        }
+    }
+
+    // Check if current burst should end
+    if (m_hapticBurstActive) {
+        double burstDuration = timeSeconds - m_hapticBurstStart;
+        if (burstDuration >= m_settings.emulationBurstDuration) {
+            m_hapticBurstActive = false;
+        }
+    }
+
+    // Apply haptic burst or stop (complete silence between bursts)
+    MotorLevels output;
+    if (m_hapticBurstActive || shouldTriggerBurst) {
+        // Strong, short burst - 3x intensity, alternating left/right
+        float burstIntensity = std::clamp(totalIntensity, 0.0f, 1.0f) * m_burstStrength;
+
+        if (m_leftMotorTurn) {
+            output.leftMotor = burstIntensity;    // Strong left motor
+        } else {
+            output.rightMotor = burstIntensity;   // Strong right motor
+        }
+
+        // Light trigger feedback for both
+        output.leftTrigger = burstIntensity * 0.3f;
+        output.rightTrigger = burstIntensity * 0.3f;
+    }
+    return output;
+}
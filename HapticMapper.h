@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "AudioProcessor.h"
+
+// Device-independent audio -> motor mapping. Shared by the live
+// HapticController and the offline renderer; time is always passed in, so the
+// same math runs against the wall clock or a file's sample clock.
+class HapticMapper {
+public:
+    enum class HapticMode {
+        Auto,           // Automatically detect best available mode
+        Rumble,         // Use traditional rumble API (GameInput 1.0)
+        Haptic,         // Use modern haptic API (GameInput 2.0)
+        Hybrid,         // Use both if available
+        HapticEmulation // Strong, short bursts to simulate haptics
+    };
+
+    struct HapticSettings {
+        float bassIntensity = 1.5f;      // Intensity multiplier for bass (0.0 - 2.0)
+        float trebleIntensity = 1.5f;    // Intensity multiplier for treble (0.0 - 2.0)
+        float volumeIntensity = 1.0f;    // Intensity multiplier for overall volume (0.0 - 2.0)
+        float dynamicIntensity = 2.0f;   // Intensity multiplier for dynamic range (0.0 - 2.0)
+        float lfeIntensity = 1.0f;       // LFE channel contribution to the low-frequency motor (0.0 - 2.0)
+        float responseCurve = 1.0f;      // Exponent on the final levels: < 1 lifts quiet passages, > 1 keeps them subtle (0.25 - 4.0)
+
+        // Motor assignments (which motors to use for different frequency ranges)
+        bool useLowFrequencyMotor = true;   // Use low-frequency motor for bass
+        bool useHighFrequencyMotor = true;  // Use high-frequency motor for treble
+        bool useImpulseMotor = true;        // Use impulse triggers for dynamics
+        bool useRumbleMotors = true;        // Use traditional rumble motors
+        bool useSpatialMapping = false;     // Left/right channel energy steers the left/right motor and trigger
+
+        // Timing settings
+        uint32_t updateRateMs = 16;         // Update rate in milliseconds (~60 FPS)
+        uint32_t fadeTimeMs = 100;          // Fade time for smooth transitions (full scale, falling)
+        uint32_t riseTimeMs = 30;           // Same, rising; short, as the mapped levels are already smoothed
+        uint32_t deviceLatencyMs = 0;       // Look-ahead only: delay from motor write to felt vibration
+
+        // Device write filtering (driver calls cost CPU, and radio time and battery on wireless pads)
+        float writeThreshold = 0.01f;       // Minimum level change before a device is written again
+        uint32_t maxWritesPerSecond = 60;   // Per-device write budget (0 = unlimited)
+
+        // API preference
+        HapticMode preferredMode = HapticMode::HapticEmulation;  // Preferred haptic mode
+
+        // Haptic emulation settings
+        float emulationBurstDuration = 0.05f;  // Duration of haptic bursts in seconds (0.01 - 0.2)
+        float emulationMinInterval = 0.1f;     // Minimum interval between bursts in seconds (0.05 - 0.5)
+        float emulationIntensity = 3.0f;       // Intensity multiplier for emulated haptics (3x stronger)
+        float emulationVolumeThreshold = 0.3f; // Volume threshold - no haptics below 30%
+        bool emulationOnsets = true;           // Bursts on detected onsets (beats, hits); false = fixed cadence while loud
+        float emulationOnsetDelay = 0.04f;     // Live only: bursts play this long after the onset was captured (0 - 0.2)
+    };
+
+    // One set of actuator levels, each in [0, 1]
+    struct MotorLevels {
+        float leftMotor = 0.0f;     // Low-frequency rumble
+        float rightMotor = 0.0f;    // High-frequency rumble
+        float leftTrigger = 0.0f;
+        float rightTrigger = 0.0f;
+    };
+
+    HapticMapper();
+
+    void SetSettings(const HapticSettings& settings) { m_settings = settings; }
+    const HapticSettings& GetSettings() const { return m_settings; }
+
+    // Target levels for a block of audio features. Volume, bass and treble
+    // come from their trends' smoothed levels, so block-to-block jitter is
+    // filtered before the motors instead of by a slow rise.
+    MotorLevels MapFeatures(const AudioProcessor::AudioFeatures& features) const;
+
+    // Move current towards target, limited by the rise and fade times
+    MotorLevels Smooth(const MotorLevels& current, const MotorLevels& target, float deltaTime) const;
+
+    // Look-ahead variant of Smooth, for audio known before it plays.
+    // targets[0] is the level due now, targets[i] the one due i * deltaTime
+    // later. Each level ramps towards the first upcoming target it would
+    // otherwise reach late, so ramps finish as the sound plays instead of a
+    // fade time after it. With count == 1 this is Smooth.
+    MotorLevels SmoothAhead(const MotorLevels& current, const MotorLevels* targets, size_t count, float deltaTime) const;
+
+    // Targets SmoothAhead should see at steps of stepSeconds: now plus the
+    // longer of the rise and fade times ahead, at most MAX_RAMP_STEPS
+    size_t GetRampSteps(float stepSeconds) const;
+    static constexpr size_t MAX_RAMP_STEPS = 32;
+
+    // Haptic emulation: turns levels into short alternating bursts. Stateful;
+    // timeSeconds must be monotonic. With emulationOnsets a burst starts on
+    // the first call at or after a scheduled onset, scaled by its strength;
+    // otherwise one starts whenever the levels are loud enough and
+    // emulationMinInterval has passed. onsetGated = false always uses that
+    // cadence, for levels that come with no onsets (manual rumble).
+    MotorLevels ProcessEmulation(const MotorLevels& levels, double timeSeconds, bool onsetGated = true);
+    void ResetEmulation(double timeSeconds);
+
+    // Queue an onset (same clock as ProcessEmulation). Onsets should arrive in
+    // time order; the oldest is dropped if MAX_PENDING_ONSETS are waiting.
+    void ScheduleOnset(double timeSeconds, float strength);
+
+private:
+    static constexpr size_t MAX_PENDING_ONSETS = 8;
+
+    struct PendingOnset {
+        double time;
+        float strength;
+    };
+
+    float SmoothTransition(float current, float target, float deltaTime) const;
+    // Next target for one level (e.g. &MotorLevels::leftMotor) in SmoothAhead
+    float RampTarget(const MotorLevels& current, const MotorLevels* targets, size_t count,
+                     float MotorLevels::* level, float deltaTime) const;
+    // Strongest onset due by timeSeconds (0 if none); consumes all due ones
+    float TakeDueOnsets(double timeSeconds);
+
+    HapticSettings m_settings;
+
+    // Haptic emulation state
+    double m_lastHapticBurst;
+    bool m_hapticBurstActive;
+    double m_hapticBurstStart;
+    bool m_leftMotorTurn;  // Alternates between left and right motor
+    float m_burstStrength; // Onset strength scaling the active burst
+
+    // Onsets waiting for their time, oldest first (ring)
+    PendingOnset m_pendingOnsets[MAX_PENDING_ONSETS];
+    size_t m_pendingFirst;
+    size_t m_pendingCount;
+};
@@ -0,0 +1,169 @@
+#include "HapticRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include "WavFile.h"
+
+namespace {
+constexpr char TIMELINE_MAGIC[4] = { 'A', 'H', 'T', 'L' };
+constexpr uint16_t TIMELINE_VERSION = 1;
+constexpr uint16_t VALUES_PER_TICK = 4;
+constexpr size_t TIMELINE_HEADER_SIZE = 24;
+
+uint8_t Quantize(float value) {
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+void PutU16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void PutU32(uint8_t* p, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void PutU64(uint8_t* p, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+}
+
+HapticRenderer::HapticRenderer()
+    : m_sensitivity(4.0f) // Same default as the live app
+    , m_burstEmulation(false)
+    , m_lookAhead(false)
+{
+}
+
+bool HapticRenderer::Render(const std::string& inputPath, const std::string& outputPath) {
+    auto startTime = std::chrono::steady_clock::now();
+    m_result = {};
+
+    WavFile wav;
+    if (!wav.Open(inputPath)) {
+        return false;
+    }
+
+    const WavFile::Format& format = wav.GetFormat();
+    const HapticMapper::HapticSettings& settings = m_mapper.GetSettings();
+    const uint32_t tickMs = (std::max)(settings.updateRateMs, 1u);
+    const uint64_t totalFrames = wav.GetFrameCount();
+
+    m_processor.SetSampleRate(format.sampleRate);
+    m_processor.SetChannelMask(format.channelMask);
+    m_processor.SetSensitivity(m_sensitivity);
+    m_mapper.ResetEmulation(0.0);
+
+    // Tick k covers frames [k * rate * ms / 1000, (k + 1) * rate * ms / 1000), so
+    // fractional tick lengths never accumulate drift
+    const uint64_t framesPerTickNum = static_cast<uint64_t>(format.sampleRate) * tickMs;
+    const uint64_t tickCount = (totalFrames * 1000 + framesPerTickNum - 1) / framesPerTickNum;
+    const size_t maxTickFrames = static_cast<size_t>(framesPerTickNum / 1000 + 1);
+
+    m_scratch.assign(maxTickFrames * format.channels, 0.0f);
+    m_ticks.clear();
+    m_ticks.reserve(static_cast<size_t>(tickCount) * VALUES_PER_TICK);
+
+    const float deltaTime = static_cast<float>(tickMs) / 1000.0f;
+    HapticMapper::MotorLevels current;
+
+    // Look-ahead: output tick k plays the audio deviceLatencyMs ahead (tick
+    // k + latencyTicks) and sees rampSteps - 1 ticks beyond it, so analysis
+    // runs leadTicks ahead of output. m_targets keeps the last rampSteps
+    // targets; ticks past the end of the audio are silent.
+    const size_t rampSteps = m_lookAhead ? m_mapper.GetRampSteps(deltaTime) : 1;
+    const uint64_t latencyTicks = m_lookAhead ? (settings.deviceLatencyMs + tickMs / 2) / tickMs : 0;
+    const uint64_t leadTicks = latencyTicks + rampSteps - 1;
+    const double latencySeconds = static_cast<double>(latencyTicks * tickMs) / 1000.0;
+    m_targets.assign(rampSteps, HapticMapper::MotorLevels{});
+    HapticMapper::MotorLevels upcoming[HapticMapper::MAX_RAMP_STEPS];
+
+    for (uint64_t tick = 0; tick < tickCount + leadTicks; ++tick) {
+        HapticMapper::MotorLevels& target = m_targets[tick % rampSteps];
+        target = {};
+        if (tick < tickCount) {
+            const uint64_t begin = tick * framesPerTickNum / 1000;
+            const uint64_t end = (std::min)((tick + 1) * framesPerTickNum / 1000, totalFrames);
+            size_t frames = static_cast<size_t>(end - begin);
+
+            const float* samples = wav.GetFloatFrames(begin);
+            if (!samples) {
+                frames = wav.ReadFrames(begin, frames, m_scratch.data());
+                samples = m_scratch.data();
+            }
+
+            AudioProcessor::AudioFeatures features = m_processor.ProcessAudio(samples, frames * format.channels, format.channels);
+
+            if (m_burstEmulation) {
+                // On the file clock an onset is known as soon as its block is
+                // analyzed, so it needs no delay: it fires on the first tick
+                // at or after it (the device latency earlier with look-ahead)
+                const double blockTime = static_cast<double>(begin) / format.sampleRate - latencySeconds;
+                for (uint32_t i = 0; i < features.onsetCount; ++i) {
+                    m_mapper.ScheduleOnset(blockTime + features.onsets[i].time, features.onsets[i].strength);
+                }
+            }
+            target = m_mapper.MapFeatures(features);
+        }
+
+        if (tick >= leadTicks) {
+            for (size_t i = 0; i < rampSteps; ++i) {
+                upcoming[i] = m_targets[(tick + 1 + i) % rampSteps];
+            }
+            EmitTick(current, upcoming, rampSteps, tick - leadTicks, tickMs, deltaTime);
+        }
+    }
+
+    if (!WriteTimeline(outputPath, tickMs * 1000, format.sampleRate)) {
+        return false;
+    }
+
+    m_result.tickCount = tickCount;
+    m_result.audioSeconds = wav.GetDurationSeconds();
+    m_result.renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
+
+void HapticRenderer::EmitTick(HapticMapper::MotorLevels& current, const HapticMapper::MotorLevels* targets, size_t targetCount,
+                              uint64_t tick, uint32_t tickMs, float deltaTime) {
+    current = m_mapper.SmoothAhead(current, targets, targetCount, deltaTime);
+    HapticMapper::MotorLevels output = current;
+    if (m_burstEmulation) {
+        output = m_mapper.ProcessEmulation(current, static_cast<double>(tick) * tickMs / 1000.0);
+    }
+
+    m_ticks.push_back(Quantize(output.leftMotor));
+    m_ticks.push_back(Quantize(output.rightMotor));
+    m_ticks.push_back(Quantize(output.leftTrigger));
+    m_ticks.push_back(Quantize(output.rightTrigger));
+}
+
+bool HapticRenderer::WriteTimeline(const std::string& outputPath, uint32_t tickIntervalUs, uint32_t sampleRate) const {
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to create haptic timeline: " << outputPath << std::endl;
+        return false;
+    }
+
+    uint8_t header[TIMELINE_HEADER_SIZE] = {};
+    std::copy(TIMELINE_MAGIC, TIMELINE_MAGIC + 4, header);
+    PutU16(header + 4, TIMELINE_VERSION);
+    PutU16(header + 6, VALUES_PER_TICK);
+    PutU32(header + 8, tickIntervalUs);
+    PutU32(header + 12, sampleRate);
+    PutU64(header + 16, m_ticks.size() / VALUES_PER_TICK);
+
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(m_ticks.data()), static_cast<std::streamsize>(m_ticks.size()));
+    if (!out) {
+        std::cerr << "Failed to write haptic timeline: " << outputPath << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AudioProcessor.h"
+#include "HapticMapper.h"
+
+// Offline batch render: runs AudioProcessor and the HapticMapper over a whole
+// WAV file on the file's own sample clock (no threads, no sleeps, no device)
+// and writes a haptic timeline.
+//
+// Timeline file layout (little-endian):
+//   char[4]  magic "AHTL"
+//   uint16   version (1)
+//   uint16   values per tick (4: left motor, right motor, left trigger, right trigger)
+//   uint32   tick interval in microseconds
+//   uint32   source sample rate
+//   uint64   tick count
+//   uint8[]  tick data, values quantized from [0, 1] to [0, 255]
+class HapticRenderer {
+public:
+    struct Result {
+        uint64_t tickCount = 0;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;
+    };
+
+    HapticRenderer();
+
+    void SetHapticSettings(const HapticMapper::HapticSettings& settings) { m_mapper.SetSettings(settings); }
+    void SetSensitivity(float sensitivity) { m_sensitivity = sensitivity; }
+
+    // Pass the mapped levels through the burst emulation as well
+    void SetBurstEmulation(bool enabled) { m_burstEmulation = enabled; }
+
+    // Shift the output earlier by deviceLatencyMs and start fades early
+    // enough to finish on time (HapticMapper::SmoothAhead), so a timeline
+    // started with its audio lands on the sound instead of trailing it
+    void SetLookAhead(bool enabled) { m_lookAhead = enabled; }
+
+    // See AudioProcessor::SetDecimatedAnalysis
+    void SetDecimatedAnalysis(bool enabled) { m_processor.SetDecimatedAnalysis(enabled); }
+    void SetFrequencyBands(float bassCutoff, float trebleCutoff) { m_processor.SetFrequencyBands(bassCutoff, trebleCutoff); }
+    void SetOnsetSettings(const OnsetDetector::Settings& settings) { m_processor.SetOnsetSettings(settings); }
+    void SetAutoGainSettings(const AutoGain::Settings& settings) { m_processor.SetAutoGainSettings(settings); }
+
+    bool Render(const std::string& inputPath, const std::string& outputPath);
+    const Result& GetResult() const { return m_result; }
+
+private:
+    // Smooth towards targets (see HapticMapper::SmoothAhead) and append output tick `tick`
+    void EmitTick(HapticMapper::MotorLevels& current, const HapticMapper::MotorLevels* targets, size_t targetCount,
+                  uint64_t tick, uint32_t tickMs, float deltaTime);
+    bool WriteTimeline(const std::string& outputPath, uint32_t tickIntervalUs, uint32_t sampleRate) const;
+
+    AudioProcessor m_processor;
+    HapticMapper m_mapper;
+    float m_sensitivity;
+    bool m_burstEmulation;
+    bool m_lookAhead;
+
+    std::vector<float> m_scratch;
+    std::vector<uint8_t> m_ticks;
+    std::vector<HapticMapper::MotorLevels> m_targets;   // Look-ahead: the newest ramp-steps targets
+    Result m_result;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// A capture backend (WASAPI, DirectSound, file/synthetic, ...).
+// AudioCaptureManager owns one source and drives it from its capture thread:
+// Start(), then Capture() in a loop until stopped, then Stop().
+class ICaptureSource {
+public:
+    // Receives interleaved float samples on the capture thread. Data is only
+    // valid for the duration of the call. captureTime is when the first frame
+    // was captured, from the device clock where the backend has one.
+    using DataSink = std::function<void(const float* samples, size_t sampleCount, size_t channels,
+                                        std::chrono::steady_clock::time_point captureTime)>;
+
+    virtual ~ICaptureSource() = default;
+
+    virtual bool Initialize() = 0;
+    virtual bool Start() = 0;
+    virtual void Stop() = 0;
+
+    // Block until data is ready (or Interrupt is called), then hand everything
+    // available to the sink. Returns false on an unrecoverable device error.
+    virtual bool Capture(const DataSink& sink) = 0;
+
+    // Wake a thread blocked in Capture; safe to call from any thread
+    virtual void Interrupt() = 0;
+
+    virtual uint32_t GetSampleRate() const = 0;
+    virtual uint32_t GetChannelCount() const = 0;
+
+    // Speaker positions as a WAVEFORMATEXTENSIBLE dwChannelMask; 0 if unknown
+    virtual uint32_t GetChannelMask() const { return 0; }
+    virtual bool IsEventDriven() const = 0;
+
+    // Sources not paced by a device clock (e.g. faster-than-real-time file
+    // playback) want lossless backpressure instead of drop-on-overflow
+    virtual bool IsRealTime() const { return true; }
+
+    // True once a finite source has delivered all of its data
+    virtual bool IsFinished() const { return false; }
+};
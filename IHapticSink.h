@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "HapticMapper.h"
+
+// A haptic output backend (GameInput gamepads, in-memory recorder, ...).
+// HapticController owns one sink. It may Write to different devices
+// concurrently (never to the same one); all other calls, FindDevices
+// included, are serialized with each other and with writes.
+class IHapticSink {
+public:
+    virtual ~IHapticSink() = default;
+
+    virtual bool Initialize() = 0;
+
+    // Silences and releases all devices
+    virtual void Shutdown() = 0;
+
+    // Looks for newly connected devices. Devices are only ever appended, so
+    // an index stays valid until Shutdown. Returns the total device count.
+    virtual size_t FindDevices() = 0;
+    virtual size_t GetDeviceCount() const = 0;
+
+    // Sets one device's actuator levels (each in [0, 1])
+    virtual bool Write(size_t device, const HapticMapper::MotorLevels& levels) = 0;
+
+    // Identity that survives reconnects and restarts where the backend has
+    // one (per-device profiles are keyed by it)
+    virtual std::string GetDeviceId(size_t device) const = 0;
+
+    // Capability summary for status output
+    virtual std::string DescribeDevice(size_t device) const = 0;
+    virtual const char* GetName() const = 0;
+};
@@ -0,0 +1,116 @@
+#include "LatencyTracker.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+LatencyTracker::LatencyTracker() {
+    Reset();
+}
+
+size_t LatencyTracker::BucketIndex(uint64_t micros) {
+    micros = (std::min)(micros, (uint64_t(1) << (MAX_EXPONENT + 1)) - 1);
+    if (micros < SUB_BUCKETS) {
+        return static_cast<size_t>(micros);
+    }
+
+    // Top SUB_BUCKET_BITS bits below the leading one pick the sub-bucket
+    const int exponent = std::bit_width(micros) - 1;
+    const size_t sub = static_cast<size_t>((micros >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+double LatencyTracker::BucketValue(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<double>(index);
+    }
+
+    // Midpoint of the bucket's range
+    const int exponent = static_cast<int>(index / SUB_BUCKETS) + SUB_BUCKET_BITS - 1;
+    const double width = std::ldexp(1.0, exponent - SUB_BUCKET_BITS);
+    const double lower = (SUB_BUCKETS + index % SUB_BUCKETS) * width;
+    return lower + width * 0.5;
+}
+
+void LatencyTracker::Record(Stage stage, BlockTimestamps::Clock::duration latency) {
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    if (micros < 0) {
+        return;     // Unset stamp, or a device clock slightly ahead of ours
+    }
+
+    const size_t s = static_cast<size_t>(stage);
+    const uint64_t value = static_cast<uint64_t>(micros);
+    m_buckets[s][BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = m_maxMicros[s].load(std::memory_order_relaxed);
+    while (value > max && !m_maxMicros[s].compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyTracker::RecordBlock(const BlockTimestamps& timestamps) {
+    const BlockTimestamps::Clock::time_point unset{};
+    if (timestamps.capture != unset && timestamps.queued != unset) {
+        Record(Stage::Capture, timestamps.queued - timestamps.capture);
+    }
+    if (timestamps.queued != unset && timestamps.dequeued != unset) {
+        Record(Stage::Queue, timestamps.dequeued - timestamps.queued);
+    }
+    if (timestamps.dequeued != unset && timestamps.analyzed != unset) {
+        Record(Stage::Analysis, timestamps.analyzed - timestamps.dequeued);
+    }
+}
+
+double LatencyTracker::Percentile(const std::array<uint64_t, BUCKET_COUNT>& counts, uint64_t total, double quantile) {
+    const uint64_t rank = (std::max)(static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(total))), uint64_t(1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return BucketValue(i) / 1000.0;
+        }
+    }
+    return BucketValue(BUCKET_COUNT - 1) / 1000.0;
+}
+
+LatencyTracker::Summary LatencyTracker::GetSummary(Stage stage) const {
+    const size_t s = static_cast<size_t>(stage);
+
+    // Snapshot first so all percentiles come from the same counts
+    std::array<uint64_t, BUCKET_COUNT> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] = m_buckets[s][i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Summary summary;
+    summary.count = total;
+    if (total == 0) {
+        return summary;
+    }
+    // Bucket midpoints can overshoot the largest sample; never report past it
+    summary.maxMs = static_cast<double>(m_maxMicros[s].load(std::memory_order_relaxed)) / 1000.0;
+    summary.p50Ms = (std::min)(Percentile(counts, total, 0.50), summary.maxMs);
+    summary.p99Ms = (std::min)(Percentile(counts, total, 0.99), summary.maxMs);
+    summary.p999Ms = (std::min)(Percentile(counts, total, 0.999), summary.maxMs);
+    return summary;
+}
+
+void LatencyTracker::Reset() {
+    for (size_t s = 0; s < STAGE_COUNT; ++s) {
+        for (auto& bucket : m_buckets[s]) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_maxMicros[s].store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* LatencyTracker::GetStageName(Stage stage) {
+    switch (stage) {
+        case Stage::Capture: return "Capture";
+        case Stage::Queue: return "Queue";
+        case Stage::Analysis: return "Analysis";
+        case Stage::Output: return "Output";
+        case Stage::EndToEnd: return "End-to-end";
+        default: return "Unknown";
+    }
+}
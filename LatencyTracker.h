@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// When one block of audio passed each stage on its way from the capture
+// device to the motors. Each stage stamps its own; unset stamps stay at the
+// clock's epoch.
+struct BlockTimestamps {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point capture;     // First frame captured (device clock where the backend has one)
+    Clock::time_point queued;      // Pushed into the pipeline ring
+    Clock::time_point dequeued;    // Handed to the processing callback
+    Clock::time_point analyzed;    // Features ready
+};
+
+// Per-stage latency histograms. Recording is one relaxed fetch_add (plus a
+// CAS for a new maximum), so any thread may record without locks; readers
+// see a slightly torn but monotonic view. Buckets are log-linear in
+// microseconds: exact below 16 us, then 16 per power of two (~6% wide).
+class LatencyTracker {
+public:
+    enum class Stage {
+        Capture,    // capture -> queued: device buffering and capture-thread wakeup
+        Queue,      // queued -> dequeued: waiting in the ring
+        Analysis,   // dequeued -> analyzed
+        Output,     // analyzed -> first motor write after the block arrived
+        EndToEnd,   // capture -> first motor write
+        Count
+    };
+
+    struct Summary {
+        uint64_t count = 0;
+        double p50Ms = 0.0;
+        double p99Ms = 0.0;
+        double p999Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    LatencyTracker();
+
+    LatencyTracker(const LatencyTracker&) = delete;
+    LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+    void Record(Stage stage, BlockTimestamps::Clock::duration latency);
+
+    // Records the capture, queue and analysis stages of a processed block
+    void RecordBlock(const BlockTimestamps& timestamps);
+
+    Summary GetSummary(Stage stage) const;
+
+    // Not atomic with respect to concurrent Records
+    void Reset();
+
+    static const char* GetStageName(Stage stage);
+
+private:
+    static constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::Count);
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 31;    // Clamps at ~71 minutes
+    static constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    static size_t BucketIndex(uint64_t micros);
+    static double BucketValue(size_t index);
+
+    static double Percentile(const std::array<uint64_t, BUCKET_COUNT>& counts, uint64_t total, double quantile);
+
+    std::array<std::array<std::atomic<uint64_t>, BUCKET_COUNT>, STAGE_COUNT> m_buckets;
+    std::array<std::atomic<uint64_t>, STAGE_COUNT> m_maxMicros;
+};
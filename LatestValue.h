@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Newest value of a small trivially copyable struct (features, telemetry),
+// published by one thread and readable by any number of others. Seqlock: the
+// writer never waits, blocks or allocates; a reader that overlaps a write
+// retries its copy, so it never sees a torn value. The payload is stored as
+// atomic words (plain moves on x86), so the copies are race-free and
+// ThreadSanitizer-clean without fences.
+template <typename T>
+class LatestValue {
+    static_assert(std::is_trivially_copyable_v<T>, "LatestValue copies T as raw words");
+
+public:
+    LatestValue() : m_sequence(0) { Store(T{}, std::memory_order_relaxed); }
+
+    LatestValue(const LatestValue&) = delete;
+    LatestValue& operator=(const LatestValue&) = delete;
+
+    // Writer side, one thread
+    void Publish(const T& value) {
+        const uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);  // Odd: write in progress
+        Store(value, std::memory_order_release);    // Release: no word lands before the odd count
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Any thread. Returns the newest complete value (T{} before the first Publish).
+    T Read() const {
+        T value;
+        Read(value);
+        return value;
+    }
+
+    // As above; returns the number of Publish calls the value reflects, so a
+    // poller can tell whether anything new arrived
+    uint64_t Read(T& value) const {
+        for (;;) {
+            const uint64_t before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;   // Writer mid-copy; it never blocks, so this is brief
+            }
+            Load(value);
+            if (m_sequence.load(std::memory_order_relaxed) == before) {
+                return before / 2;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    void Store(const T& value, std::memory_order order) {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; ++i) {
+            m_words[i].store(words[i], order);
+        }
+    }
+
+    // Acquire: the closing count check cannot move ahead of any word
+    void Load(T& value) const {
+        uint64_t words[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            words[i] = m_words[i].load(std::memory_order_acquire);
+        }
+        std::memcpy(&value, words, sizeof(T));
+    }
+
+    std::atomic<uint64_t> m_sequence;   // Twice the publish count; odd while a write is in progress
+    std::atomic<uint64_t> m_words[WORDS];
+};
@@ -0,0 +1,139 @@
+#include "MappedFile.h"
+#include <iostream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+    , m_fileHandle(INVALID_HANDLE_VALUE)
+    , m_mappingHandle(nullptr)
+{
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+    // Paths are UTF-8 throughout the app
+    int len = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    if (len <= 0) {
+        std::cerr << "Invalid file path: " << path << std::endl;
+        return false;
+    }
+    std::wstring widePath(len - 1, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], len);
+
+    m_fileHandle = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_fileHandle == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open file: " << path << " (" << GetLastError() << ")" << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_fileHandle, &size) || size.QuadPart == 0) {
+        std::cerr << "Failed to get file size (or file is empty): " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    m_mappingHandle = CreateFileMappingW(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mappingHandle) {
+        std::cerr << "Failed to create file mapping: " << path << " (" << GetLastError() << ")" << std::endl;
+        Close();
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) {
+        std::cerr << "Failed to map file: " << path << " (" << GetLastError() << ")" << std::endl;
+        Close();
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+    if (m_mappingHandle) {
+        CloseHandle(m_mappingHandle);
+        m_mappingHandle = nullptr;
+    }
+    if (m_fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_fileHandle);
+        m_fileHandle = INVALID_HANDLE_VALUE;
+    }
+    m_size = 0;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+    , m_fd(-1)
+{
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(m_fd, &info) != 0 || info.st_size == 0) {
+        std::cerr << "Failed to get file size (or file is empty): " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map file: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    // Playback reads front to back; let the kernel read ahead aggressively
+    madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = static_cast<uint64_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) {
+        munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+        m_data = nullptr;
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_size = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
@@ -0,0 +1,77 @@
+#include "OnsetDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// log(1 + C * x): roughly log(x) for audible levels, so the flux measures
+// relative (dB-like) rises and does not depend on overall loudness
+constexpr float LOG_COMPRESSION = 100.0f;
+}
+
+OnsetDetector::OnsetDetector()
+    : m_alpha(0.0f)
+    , m_refractoryHops(0)
+    , m_previous{}
+    , m_previousCount(0)
+    , m_mean(0.0f)
+    , m_deviation(0.0f)
+    , m_wasAbove(false)
+    , m_hopsSinceOnset(0)
+{
+    Configure(512.0f / 48000.0f, Settings{});
+}
+
+void OnsetDetector::Configure(float hopSeconds, const Settings& settings) {
+    m_settings = settings;
+    hopSeconds = std::max(hopSeconds, 1e-6f);
+    m_alpha = 1.0f - std::exp(-hopSeconds / std::max(settings.adaptSeconds, hopSeconds));
+    m_refractoryHops = static_cast<size_t>(std::ceil(settings.minIntervalSeconds / hopSeconds));
+    Reset();
+}
+
+void OnsetDetector::Reset() {
+    m_previousCount = 0;
+    m_mean = 0.0f;
+    m_deviation = 0.0f;
+    m_wasAbove = false;
+    m_hopsSinceOnset = m_refractoryHops;
+}
+
+float OnsetDetector::Process(const float* bands, size_t bandCount) {
+    bandCount = std::min(bandCount, SpectralAnalyzer::MAX_BANDS);
+
+    // The first frame (or a band layout change) only sets the reference
+    float flux = 0.0f;
+    const bool primed = m_previousCount == bandCount && bandCount > 0;
+    for (size_t b = 0; b < bandCount; ++b) {
+        const float magnitude = std::log1p(LOG_COMPRESSION * bands[b]);
+        if (primed) {
+            flux += std::max(magnitude - m_previous[b], 0.0f);
+        }
+        m_previous[b] = magnitude;
+    }
+    m_previousCount = bandCount;
+    if (!primed) {
+        return 0.0f;
+    }
+    flux /= static_cast<float>(bandCount);
+
+    // Decide against the statistics of the frames before this one, so an
+    // onset does not raise its own threshold
+    const float threshold = std::max(m_mean + m_settings.sensitivity * m_deviation, m_settings.minFlux);
+    const bool above = flux > threshold;
+    const bool onset = above && !m_wasAbove && m_hopsSinceOnset >= m_refractoryHops;
+    m_wasAbove = above;
+
+    m_mean += m_alpha * (flux - m_mean);
+    m_deviation += m_alpha * (std::abs(flux - m_mean) - m_deviation);
+
+    if (!onset) {
+        ++m_hopsSinceOnset;
+        return 0.0f;
+    }
+    m_hopsSinceOnset = 1;
+
+    // Share of the flux above the threshold: just over it is weak, several times over approaches 1
+    return std::clamp(1.0f - threshold / flux, 1e-3f, 1.0f);
+}
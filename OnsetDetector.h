@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include "SpectralAnalyzer.h"
+
+// Streaming onset (transient) detector fed one spectrum frame per hop.
+// Detection function: half-wave rectified flux of log-compressed band
+// magnitudes, i.e. how much energy appeared since the previous frame, averaged
+// over bands. An onset is a rising crossing of an adaptive threshold (running
+// mean plus a multiple of the running mean deviation of the flux), so steady
+// loud passages do not fire and quiet ones still can. O(bands) per hop, no
+// allocation.
+class OnsetDetector {
+public:
+    struct Settings {
+        float sensitivity = 4.0f;       // Threshold = mean + sensitivity * deviation; lower fires more often
+        float minFlux = 0.2f;           // Absolute flux floor (~1.7 dB average rise per band); ignores noise and slow swells
+        float adaptSeconds = 0.5f;      // Time constant of the running mean/deviation
+        float minIntervalSeconds = 0.05f; // Refractory period after an onset
+    };
+
+    OnsetDetector();
+
+    void Configure(float hopSeconds, const Settings& settings);
+    void Reset();
+
+    // Feed the next frame's band magnitudes (linear RMS). Returns the onset
+    // strength in (0, 1] if this frame starts an onset, otherwise 0.
+    float Process(const float* bands, size_t bandCount);
+
+    const Settings& GetSettings() const { return m_settings; }
+
+private:
+    Settings m_settings;
+    float m_alpha;              // Per-hop smoothing factor of the statistics
+    size_t m_refractoryHops;
+
+    float m_previous[SpectralAnalyzer::MAX_BANDS];   // Log magnitudes of the last frame
+    size_t m_previousCount;     // Bands in m_previous; 0 until the first frame
+    float m_mean;
+    float m_deviation;
+    bool m_wasAbove;            // Previous frame was over the threshold
+    size_t m_hopsSinceOnset;
+};
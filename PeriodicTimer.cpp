@@ -0,0 +1,124 @@
+#include "PeriodicTimer.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <Windows.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+PeriodicTimer::PeriodicTimer()
+    : m_period(std::chrono::milliseconds(16))
+    , m_deadline(Clock::now())
+    , m_timer(nullptr)
+    , m_interruptEvent(CreateEventW(nullptr, TRUE, FALSE, nullptr))
+{
+    // High-resolution timers need Windows 10 1803; older systems get the
+    // regular (scheduler-tick) timer
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!m_timer) {
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+}
+
+PeriodicTimer::~PeriodicTimer() {
+    if (m_timer) {
+        CloseHandle(m_timer);
+        m_timer = nullptr;
+    }
+    if (m_interruptEvent) {
+        CloseHandle(m_interruptEvent);
+        m_interruptEvent = nullptr;
+    }
+}
+
+void PeriodicTimer::Interrupt() {
+    if (m_interruptEvent) {
+        SetEvent(m_interruptEvent);
+    }
+}
+
+bool PeriodicTimer::WaitUntil(Clock::time_point deadline) {
+    const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - Clock::now());
+
+    if (m_timer && remaining.count() > 0) {
+        // Relative due time, in 100 ns units (negative = relative)
+        LARGE_INTEGER due;
+        due.QuadPart = -(std::max<long long>)(remaining.count() / 100, 1);
+        if (SetWaitableTimer(m_timer, &due, 0, nullptr, nullptr, FALSE)) {
+            HANDLE handles[2] = { m_interruptEvent, m_timer };
+            return WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0;
+        }
+    }
+
+    // No timer (or already due): only check for an interrupt, rounding up to whole milliseconds
+    const DWORD timeoutMs = remaining.count() > 0 ? static_cast<DWORD>((remaining.count() + 999999) / 1000000) : 0;
+    return WaitForSingleObject(m_interruptEvent, timeoutMs) != WAIT_OBJECT_0;
+}
+
+void PeriodicTimer::ClearInterrupt() {
+    if (m_interruptEvent) {
+        ResetEvent(m_interruptEvent);
+    }
+}
+
+void PeriodicTimer::Start(Clock::duration period) {
+    m_period = (std::max)(period, Clock::duration(1));
+    m_deadline = Clock::now();
+}
+
+#else
+
+PeriodicTimer::PeriodicTimer()
+    : m_period(std::chrono::milliseconds(16))
+    , m_deadline(Clock::now())
+    , m_interrupted(false)
+{
+}
+
+PeriodicTimer::~PeriodicTimer() = default;
+
+void PeriodicTimer::Interrupt() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_interrupted = true;
+    }
+    m_condition.notify_all();
+}
+
+bool PeriodicTimer::WaitUntil(Clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return !m_condition.wait_until(lock, deadline, [this] { return m_interrupted; });
+}
+
+void PeriodicTimer::ClearInterrupt() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_interrupted = false;
+}
+
+void PeriodicTimer::Start(Clock::duration period) {
+    m_period = std::max(period, Clock::duration(1));
+    m_deadline = Clock::now();
+}
+
+#endif
+
+uint64_t PeriodicTimer::Wait() {
+    const Clock::time_point next = m_deadline + m_period;
+    if (!WaitUntil(next)) {
+        return 0;
+    }
+
+    // The schedule advances from the deadline, not from when we woke up. If
+    // whole periods were lost, skip those deadlines and report them.
+    m_deadline = next;
+    uint64_t ticks = 1;
+    const Clock::duration late = Clock::now() - next;
+    if (late >= m_period) {
+        const auto missed = late / m_period;
+        m_deadline += missed * m_period;
+        ticks += static_cast<uint64_t>(missed);
+    }
+    return ticks;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#ifndef _WIN32
+#include <condition_variable>
+#include <mutex>
+#endif
+
+// Fixed-rate tick source for output loops. Deadlines are absolute (start time
+// plus n periods), so wake-up latency never accumulates into drift, and ticks
+// missed during a stall are skipped instead of being run late in a burst.
+// On Windows the wait uses a high-resolution waitable timer, since the default
+// ~15.6 ms scheduler tick would swallow a 16 ms period. Elsewhere it is a
+// condition variable waiting on a steady_clock deadline.
+class PeriodicTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PeriodicTimer();
+    ~PeriodicTimer();
+
+    PeriodicTimer(const PeriodicTimer&) = delete;
+    PeriodicTimer& operator=(const PeriodicTimer&) = delete;
+
+    // (Re)starts the schedule; the first tick is one period from now
+    void Start(Clock::duration period);
+
+    // Blocks until the next deadline. Returns the number of periods since the
+    // previous tick (more than 1 after a stall), or 0 if interrupted.
+    uint64_t Wait();
+
+    // Makes the current and all later Waits return 0 until ClearInterrupt;
+    // safe to call from any thread
+    void Interrupt();
+    void ClearInterrupt();
+
+    Clock::duration GetPeriod() const { return m_period; }
+    Clock::time_point GetDeadline() const { return m_deadline; }   // Scheduled time of the latest tick
+
+private:
+    // False if interrupted
+    bool WaitUntil(Clock::time_point deadline);
+
+    Clock::duration m_period;
+    Clock::time_point m_deadline;
+
+#ifdef _WIN32
+    void* m_timer;
+    void* m_interruptEvent;     // Manual-reset
+#else
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_interrupted;
+#endif
+};
@@ -0,0 +1,263 @@
+#include "RealFft.h"
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+    #define REALFFT_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define REALFFT_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 8;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Two radix-2 stages (spans h and 2h) fused into one radix-4 pass, so each
+// point is loaded and stored once instead of twice. For k < h:
+//   stage h:  (x0, x1) and (x2, x3) with twiddle wA
+//   stage 2h: (a0, a2) with wB and (a1, a3) with -i * wB
+// SSE2/NEON are baseline on the targets we build for, so no runtime dispatch.
+void Radix4Pass(float* re, float* im, size_t h,
+                const float* aRe, const float* aIm, const float* bRe, const float* bIm) {
+    float* r0 = re;
+    float* i0 = im;
+    float* r1 = re + h;
+    float* i1 = im + h;
+    float* r2 = re + 2 * h;
+    float* i2 = im + 2 * h;
+    float* r3 = re + 3 * h;
+    float* i3 = im + 3 * h;
+
+    size_t k = 0;
+#if REALFFT_SSE2
+    for (; k + 4 <= h; k += 4) {
+        const __m128 war = _mm_loadu_ps(aRe + k), wai = _mm_loadu_ps(aIm + k);
+        const __m128 wbr = _mm_loadu_ps(bRe + k), wbi = _mm_loadu_ps(bIm + k);
+        const __m128 x0r = _mm_loadu_ps(r0 + k), x0i = _mm_loadu_ps(i0 + k);
+        const __m128 x1r = _mm_loadu_ps(r1 + k), x1i = _mm_loadu_ps(i1 + k);
+        const __m128 x2r = _mm_loadu_ps(r2 + k), x2i = _mm_loadu_ps(i2 + k);
+        const __m128 x3r = _mm_loadu_ps(r3 + k), x3i = _mm_loadu_ps(i3 + k);
+
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(war, x1r), _mm_mul_ps(wai, x1i));
+        __m128 ti = _mm_add_ps(_mm_mul_ps(war, x1i), _mm_mul_ps(wai, x1r));
+        const __m128 a0r = _mm_add_ps(x0r, tr), a0i = _mm_add_ps(x0i, ti);
+        const __m128 a1r = _mm_sub_ps(x0r, tr), a1i = _mm_sub_ps(x0i, ti);
+
+        tr = _mm_sub_ps(_mm_mul_ps(war, x3r), _mm_mul_ps(wai, x3i));
+        ti = _mm_add_ps(_mm_mul_ps(war, x3i), _mm_mul_ps(wai, x3r));
+        const __m128 a2r = _mm_add_ps(x2r, tr), a2i = _mm_add_ps(x2i, ti);
+        const __m128 a3r = _mm_sub_ps(x2r, tr), a3i = _mm_sub_ps(x2i, ti);
+
+        const __m128 ur = _mm_sub_ps(_mm_mul_ps(wbr, a2r), _mm_mul_ps(wbi, a2i));
+        const __m128 ui = _mm_add_ps(_mm_mul_ps(wbr, a2i), _mm_mul_ps(wbi, a2r));
+        // v = -i * wB * a3, so v.re = (wB*a3).im and v.im = -(wB*a3).re
+        const __m128 vr = _mm_add_ps(_mm_mul_ps(wbr, a3i), _mm_mul_ps(wbi, a3r));
+        const __m128 vi = _mm_sub_ps(_mm_mul_ps(wbi, a3i), _mm_mul_ps(wbr, a3r));
+
+        _mm_storeu_ps(r0 + k, _mm_add_ps(a0r, ur)); _mm_storeu_ps(i0 + k, _mm_add_ps(a0i, ui));
+        _mm_storeu_ps(r2 + k, _mm_sub_ps(a0r, ur)); _mm_storeu_ps(i2 + k, _mm_sub_ps(a0i, ui));
+        _mm_storeu_ps(r1 + k, _mm_add_ps(a1r, vr)); _mm_storeu_ps(i1 + k, _mm_add_ps(a1i, vi));
+        _mm_storeu_ps(r3 + k, _mm_sub_ps(a1r, vr)); _mm_storeu_ps(i3 + k, _mm_sub_ps(a1i, vi));
+    }
+#elif REALFFT_NEON
+    for (; k + 4 <= h; k += 4) {
+        const float32x4_t war = vld1q_f32(aRe + k), wai = vld1q_f32(aIm + k);
+        const float32x4_t wbr = vld1q_f32(bRe + k), wbi = vld1q_f32(bIm + k);
+        const float32x4_t x0r = vld1q_f32(r0 + k), x0i = vld1q_f32(i0 + k);
+        const float32x4_t x1r = vld1q_f32(r1 + k), x1i = vld1q_f32(i1 + k);
+        const float32x4_t x2r = vld1q_f32(r2 + k), x2i = vld1q_f32(i2 + k);
+        const float32x4_t x3r = vld1q_f32(r3 + k), x3i = vld1q_f32(i3 + k);
+
+        float32x4_t tr = vmlsq_f32(vmulq_f32(war, x1r), wai, x1i);
+        float32x4_t ti = vmlaq_f32(vmulq_f32(war, x1i), wai, x1r);
+        const float32x4_t a0r = vaddq_f32(x0r, tr), a0i = vaddq_f32(x0i, ti);
+        const float32x4_t a1r = vsubq_f32(x0r, tr), a1i = vsubq_f32(x0i, ti);
+
+        tr = vmlsq_f32(vmulq_f32(war, x3r), wai, x3i);
+        ti = vmlaq_f32(vmulq_f32(war, x3i), wai, x3r);
+        const float32x4_t a2r = vaddq_f32(x2r, tr), a2i = vaddq_f32(x2i, ti);
+        const float32x4_t a3r = vsubq_f32(x2r, tr), a3i = vsubq_f32(x2i, ti);
+
+        const float32x4_t ur = vmlsq_f32(vmulq_f32(wbr, a2r), wbi, a2i);
+        const float32x4_t ui = vmlaq_f32(vmulq_f32(wbr, a2i), wbi, a2r);
+        const float32x4_t vr = vmlaq_f32(vmulq_f32(wbr, a3i), wbi, a3r);
+        const float32x4_t vi = vmlsq_f32(vmulq_f32(wbi, a3i), wbr, a3r);
+
+        vst1q_f32(r0 + k, vaddq_f32(a0r, ur)); vst1q_f32(i0 + k, vaddq_f32(a0i, ui));
+        vst1q_f32(r2 + k, vsubq_f32(a0r, ur)); vst1q_f32(i2 + k, vsubq_f32(a0i, ui));
+        vst1q_f32(r1 + k, vaddq_f32(a1r, vr)); vst1q_f32(i1 + k, vaddq_f32(a1i, vi));
+        vst1q_f32(r3 + k, vsubq_f32(a1r, vr)); vst1q_f32(i3 + k, vsubq_f32(a1i, vi));
+    }
+#endif
+    for (; k < h; ++k) {
+        float tr = aRe[k] * r1[k] - aIm[k] * i1[k];
+        float ti = aRe[k] * i1[k] + aIm[k] * r1[k];
+        const float a0r = r0[k] + tr, a0i = i0[k] + ti;
+        const float a1r = r0[k] - tr, a1i = i0[k] - ti;
+
+        tr = aRe[k] * r3[k] - aIm[k] * i3[k];
+        ti = aRe[k] * i3[k] + aIm[k] * r3[k];
+        const float a2r = r2[k] + tr, a2i = i2[k] + ti;
+        const float a3r = r2[k] - tr, a3i = i2[k] - ti;
+
+        const float ur = bRe[k] * a2r - bIm[k] * a2i;
+        const float ui = bRe[k] * a2i + bIm[k] * a2r;
+        const float vr = bRe[k] * a3i + bIm[k] * a3r;
+        const float vi = bIm[k] * a3i - bRe[k] * a3r;
+
+        r0[k] = a0r + ur; i0[k] = a0i + ui;
+        r2[k] = a0r - ur; i2[k] = a0i - ui;
+        r1[k] = a1r + vr; i1[k] = a1i + vi;
+        r3[k] = a1r - vr; i3[k] = a1i - vi;
+    }
+}
+
+// Single radix-2 stage, only needed when log2(N/2) is odd
+void Radix2Pass(float* re, float* im, size_t h, const float* wRe, const float* wIm) {
+    size_t k = 0;
+#if REALFFT_SSE2
+    for (; k + 4 <= h; k += 4) {
+        const __m128 wr = _mm_loadu_ps(wRe + k), wi = _mm_loadu_ps(wIm + k);
+        const __m128 br = _mm_loadu_ps(re + k + h), bi = _mm_loadu_ps(im + k + h);
+        const __m128 tr = _mm_sub_ps(_mm_mul_ps(wr, br), _mm_mul_ps(wi, bi));
+        const __m128 ti = _mm_add_ps(_mm_mul_ps(wr, bi), _mm_mul_ps(wi, br));
+        const __m128 ar = _mm_loadu_ps(re + k), ai = _mm_loadu_ps(im + k);
+        _mm_storeu_ps(re + k, _mm_add_ps(ar, tr)); _mm_storeu_ps(im + k, _mm_add_ps(ai, ti));
+        _mm_storeu_ps(re + k + h, _mm_sub_ps(ar, tr)); _mm_storeu_ps(im + k + h, _mm_sub_ps(ai, ti));
+    }
+#elif REALFFT_NEON
+    for (; k + 4 <= h; k += 4) {
+        const float32x4_t wr = vld1q_f32(wRe + k), wi = vld1q_f32(wIm + k);
+        const float32x4_t br = vld1q_f32(re + k + h), bi = vld1q_f32(im + k + h);
+        const float32x4_t tr = vmlsq_f32(vmulq_f32(wr, br), wi, bi);
+        const float32x4_t ti = vmlaq_f32(vmulq_f32(wr, bi), wi, br);
+        const float32x4_t ar = vld1q_f32(re + k), ai = vld1q_f32(im + k);
+        vst1q_f32(re + k, vaddq_f32(ar, tr)); vst1q_f32(im + k, vaddq_f32(ai, ti));
+        vst1q_f32(re + k + h, vsubq_f32(ar, tr)); vst1q_f32(im + k + h, vsubq_f32(ai, ti));
+    }
+#endif
+    for (; k < h; ++k) {
+        float tr = wRe[k] * re[k + h] - wIm[k] * im[k + h];
+        float ti = wRe[k] * im[k + h] + wIm[k] * re[k + h];
+        float ar = re[k];
+        float ai = im[k];
+        re[k] = ar + tr;
+        im[k] = ai + ti;
+        re[k + h] = ar - tr;
+        im[k + h] = ai - ti;
+    }
+}
+}
+
+RealFft::RealFft(size_t size)
+    : m_size(RoundUpToPowerOfTwo(size))
+    , m_half(m_size / 2)
+{
+    size_t bits = 0;
+    while ((size_t(1) << bits) < m_half) {
+        ++bits;
+    }
+
+    m_bitReverse.resize(m_half);
+    for (size_t i = 0; i < m_half; ++i) {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitReverse[i] = reversed;
+    }
+
+    m_stageCos.resize(m_half);
+    m_stageSin.resize(m_half);
+    for (size_t h = 1; h < m_half; h <<= 1) {
+        for (size_t k = 0; k < h; ++k) {
+            double angle = -PI * static_cast<double>(k) / static_cast<double>(h);
+            m_stageCos[h - 1 + k] = static_cast<float>(std::cos(angle));
+            m_stageSin[h - 1 + k] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    m_splitCos.resize(m_half + 1);
+    m_splitSin.resize(m_half + 1);
+    for (size_t k = 0; k <= m_half; ++k) {
+        double angle = -2.0 * PI * static_cast<double>(k) / static_cast<double>(m_size);
+        m_splitCos[k] = static_cast<float>(std::cos(angle));
+        m_splitSin[k] = static_cast<float>(std::sin(angle));
+    }
+
+    m_workRe.resize(m_half);
+    m_workIm.resize(m_half);
+}
+
+void RealFft::Forward(const float* in, float* re, float* im) {
+    float* zr = m_workRe.data();
+    float* zi = m_workIm.data();
+
+    // Pack even samples as real, odd samples as imaginary, in bit-reversed order
+    for (size_t i = 0; i < m_half; ++i) {
+        size_t j = m_bitReverse[i];
+        zr[j] = in[2 * i];
+        zi[j] = in[2 * i + 1];
+    }
+
+    // First two stages have trivial twiddles (1 and -i): do them together as
+    // one radix-4 pass instead of thousands of 1- and 2-wide butterfly spans
+    for (size_t start = 0; start + 4 <= m_half; start += 4) {
+        float* r = zr + start;
+        float* i = zi + start;
+        float r0 = r[0] + r[1], i0 = i[0] + i[1];
+        float r1 = r[0] - r[1], i1 = i[0] - i[1];
+        float r2 = r[2] + r[3], i2 = i[2] + i[3];
+        float r3 = r[2] - r[3], i3 = i[2] - i[3];
+        r[0] = r0 + r2; i[0] = i0 + i2;
+        r[2] = r0 - r2; i[2] = i0 - i2;
+        // (-i) * (r3 + i*i3) = i3 - i*r3
+        r[1] = r1 + i3; i[1] = i1 - r3;
+        r[3] = r1 - i3; i[3] = i1 + r3;
+    }
+
+    // Remaining stages two at a time, plus one radix-2 stage if the count is odd
+    size_t h = 4;
+    for (; 4 * h <= m_half; h <<= 2) {
+        const float* aRe = m_stageCos.data() + h - 1;
+        const float* aIm = m_stageSin.data() + h - 1;
+        const float* bRe = m_stageCos.data() + 2 * h - 1;
+        const float* bIm = m_stageSin.data() + 2 * h - 1;
+        for (size_t start = 0; start < m_half; start += 4 * h) {
+            Radix4Pass(zr + start, zi + start, h, aRe, aIm, bRe, bIm);
+        }
+    }
+    if (h < m_half) {
+        Radix2Pass(zr, zi, h, m_stageCos.data() + h - 1, m_stageSin.data() + h - 1);
+    }
+
+    // Unpack: X[k] = E[k] + W^k O[k], with E/O the spectra of the even/odd
+    // samples. X[M-k] = conj(E[k]) + W^(M-k) conj(O[k]), so each iteration
+    // produces a bin from both ends of the spectrum.
+    const size_t m = m_half;
+    re[0] = zr[0] + zi[0];
+    im[0] = 0.0f;
+    re[m] = zr[0] - zi[0];
+    im[m] = 0.0f;
+
+    for (size_t k = 1; k <= m / 2; ++k) {
+        const size_t j = m - k;
+        const float evenRe = 0.5f * (zr[k] + zr[j]);
+        const float evenIm = 0.5f * (zi[k] - zi[j]);
+        const float oddRe = 0.5f * (zi[k] + zi[j]);
+        const float oddIm = -0.5f * (zr[k] - zr[j]);
+
+        re[k] = evenRe + m_splitCos[k] * oddRe - m_splitSin[k] * oddIm;
+        im[k] = evenIm + m_splitCos[k] * oddIm + m_splitSin[k] * oddRe;
+        re[j] = evenRe + m_splitCos[j] * oddRe + m_splitSin[j] * oddIm;
+        im[j] = -evenIm - m_splitCos[j] * oddIm + m_splitSin[j] * oddRe;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Forward FFT of a real signal whose length is a power of two (rounded up).
+// The N real samples are packed into an N/2-point complex FFT (iterative
+// radix-2, split re/im arrays) and the spectrum is unpacked afterwards, so it
+// costs about half a complex FFT of the same size. Twiddles are precomputed
+// per stage so every butterfly loop walks memory contiguously (SSE2/NEON 4-wide).
+// All storage is allocated in the constructor; Forward never allocates.
+class RealFft {
+public:
+    explicit RealFft(size_t size);
+
+    size_t GetSize() const { return m_size; }
+    size_t GetBinCount() const { return m_size / 2 + 1; }
+
+    // in: m_size samples. re/im: GetBinCount() bins each (DC .. Nyquist).
+    void Forward(const float* in, float* re, float* im);
+
+private:
+    size_t m_size;      // Real input length N
+    size_t m_half;      // Complex FFT length N/2
+
+    std::vector<size_t> m_bitReverse;
+
+    // Stage twiddles, stage after stage: for a stage of span 2h, h entries
+    // starting at offset h - 1
+    std::vector<float> m_stageCos;
+    std::vector<float> m_stageSin;
+
+    // Unpacking twiddles e^(-2*pi*i*k/N), k = 0 .. N/2
+    std::vector<float> m_splitCos;
+    std::vector<float> m_splitSin;
+
+    // Complex work buffers (N/2)
+    std::vector<float> m_workRe;
+    std::vector<float> m_workIm;
+};
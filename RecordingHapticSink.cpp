@@ -0,0 +1,42 @@
+#include "RecordingHapticSink.h"
+
+RecordingHapticSink::RecordingHapticSink(size_t deviceCount)
+    : m_deviceCount(deviceCount)
+{
+}
+
+bool RecordingHapticSink::Write(size_t device, const HapticMapper::MotorLevels& levels) {
+    // Timestamp before taking the lock, so a reader holding it doesn't skew the record
+    const Clock::time_point now = Clock::now();
+    if (device >= m_deviceCount) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_writes.push_back({ now, device, levels });
+    return true;
+}
+
+std::string RecordingHapticSink::DescribeDevice(size_t device) const {
+    return "Recording device " + std::to_string(device);
+}
+
+void RecordingHapticSink::Reserve(size_t writes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_writes.reserve(writes);
+}
+
+std::vector<RecordingHapticSink::WriteRecord> RecordingHapticSink::GetWrites() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_writes;
+}
+
+size_t RecordingHapticSink::GetWriteCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_writes.size();
+}
+
+void RecordingHapticSink::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_writes.clear();
+}
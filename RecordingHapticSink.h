@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <ratio>
+#include <string>
+#include <vector>
+#include "IHapticSink.h"
+
+// In-memory sink for tests and benchmarks: a fixed number of fake devices
+// whose writes are recorded with steady_clock timestamps. No hardware, so
+// the controller's mapping, smoothing and write filtering run anywhere.
+class RecordingHapticSink : public IHapticSink {
+public:
+    using Clock = std::chrono::steady_clock;
+    static_assert(std::ratio_less_equal_v<Clock::period, std::nano>, "write timestamps need nanosecond resolution");
+
+    struct WriteRecord {
+        Clock::time_point time;
+        size_t device;
+        HapticMapper::MotorLevels levels;
+    };
+
+    explicit RecordingHapticSink(size_t deviceCount = 1);
+
+    bool Initialize() override { return true; }
+    void Shutdown() override {}     // Keeps the recording for inspection
+
+    size_t FindDevices() override { return m_deviceCount; }
+    size_t GetDeviceCount() const override { return m_deviceCount; }
+
+    bool Write(size_t device, const HapticMapper::MotorLevels& levels) override;
+
+    std::string GetDeviceId(size_t device) const override { return "recording:" + std::to_string(device); }
+    std::string DescribeDevice(size_t device) const override;
+    const char* GetName() const override { return "Recording"; }
+
+    // Pre-allocates room for this many writes, so timing runs don't measure
+    // vector growth
+    void Reserve(size_t writes);
+
+    // Snapshot of all writes so far, in order; safe while the controller is running
+    std::vector<WriteRecord> GetWrites() const;
+    size_t GetWriteCount() const;
+    void Clear();
+
+private:
+    size_t m_deviceCount;
+
+    mutable std::mutex m_mutex;
+    std::vector<WriteRecord> m_writes;
+};
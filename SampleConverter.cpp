@@ -0,0 +1,478 @@
+#include "SampleConverter.h"
+#include <cstring>
+#include <iostream>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+    #define SAMPLECONVERTER_X86 1
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define SAMPLECONVERTER_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// GCC/Clang need per-function target attributes to emit AVX2 without -mavx2;
+// MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+    #define SAMPLECONVERTER_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define SAMPLECONVERTER_TARGET(isa)
+#endif
+
+namespace {
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+// Full-scale factors; powers of two, so scaling after the int -> float
+// conversion rounds exactly like the SIMD fixed-point conversions
+constexpr float SCALE_8 = 1.0f / 128.0f;
+constexpr float SCALE_16 = 1.0f / 32768.0f;
+constexpr float SCALE_24 = 1.0f / 8388608.0f;
+constexpr float SCALE_32 = 1.0f / 2147483648.0f;
+
+uint16_t ReadU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// Reference kernels. Multi-byte samples are little-endian, like the host.
+struct ScalarOps {
+    static void UInt8(const uint8_t* in, size_t count, float* out) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = (static_cast<float>(in[i]) - 128.0f) * SCALE_8;
+        }
+    }
+
+    static void Int16(const uint8_t* in, size_t count, float* out) {
+        for (size_t i = 0; i < count; ++i) {
+            int16_t value;
+            std::memcpy(&value, in + i * 2, sizeof(value));
+            out[i] = static_cast<float>(value) * SCALE_16;
+        }
+    }
+
+    static void Int24(const uint8_t* in, size_t count, float* out) {
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* p = in + i * 3;
+            // Place the 24 bits at the top of an int32, then shift back down to sign-extend
+            int32_t value = static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 8) |
+                                                 (static_cast<uint32_t>(p[1]) << 16) |
+                                                 (static_cast<uint32_t>(p[2]) << 24)) >> 8;
+            out[i] = static_cast<float>(value) * SCALE_24;
+        }
+    }
+
+    static void Int32(const uint8_t* in, size_t count, float* out) {
+        for (size_t i = 0; i < count; ++i) {
+            int32_t value;
+            std::memcpy(&value, in + i * 4, sizeof(value));
+            out[i] = static_cast<float>(value) * SCALE_32;
+        }
+    }
+
+    static void Float32(const uint8_t* in, size_t count, float* out) {
+        std::memcpy(out, in, count * sizeof(float));
+    }
+
+    static void Float64(const uint8_t* in, size_t count, float* out) {
+        for (size_t i = 0; i < count; ++i) {
+            double value;
+            std::memcpy(&value, in + i * 8, sizeof(value));
+            out[i] = static_cast<float>(value);
+        }
+    }
+};
+
+#if SAMPLECONVERTER_X86
+
+struct SSE2Ops {
+    static void UInt8(const uint8_t* in, size_t count, float* out) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bias = _mm_set1_epi32(128);
+        const __m128 scale = _mm_set1_ps(SCALE_8);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            const __m128i words[2] = { _mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero) };
+            for (int w = 0; w < 2; ++w) {
+                const __m128i lo = _mm_sub_epi32(_mm_unpacklo_epi16(words[w], zero), bias);
+                const __m128i hi = _mm_sub_epi32(_mm_unpackhi_epi16(words[w], zero), bias);
+                _mm_storeu_ps(out + i + w * 8, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+                _mm_storeu_ps(out + i + w * 8 + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+            }
+        }
+        ScalarOps::UInt8(in + i, count - i, out + i);
+    }
+
+    static void Int16(const uint8_t* in, size_t count, float* out) {
+        const __m128 scale = _mm_set1_ps(SCALE_16);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+            // Duplicate each word into both halves of a dword, then arithmetic-shift to sign-extend
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+        ScalarOps::Int16(in + i * 2, count - i, out + i);
+    }
+
+    // No byte shuffle before SSSE3; AVX2 covers packed 24-bit on x86
+    static void Int24(const uint8_t* in, size_t count, float* out) {
+        ScalarOps::Int24(in, count, out);
+    }
+
+    static void Int32(const uint8_t* in, size_t count, float* out) {
+        const __m128 scale = _mm_set1_ps(SCALE_32);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 4));
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+        }
+        ScalarOps::Int32(in + i * 4, count - i, out + i);
+    }
+
+    static void Float32(const uint8_t* in, size_t count, float* out) {
+        ScalarOps::Float32(in, count, out);
+    }
+
+    static void Float64(const uint8_t* in, size_t count, float* out) {
+        const double* d = reinterpret_cast<const double*>(in);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(d + i));
+            const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(d + i + 2));
+            _mm_storeu_ps(out + i, _mm_movelh_ps(lo, hi));
+        }
+        ScalarOps::Float64(in + i * 8, count - i, out + i);
+    }
+};
+
+struct AVX2Ops {
+    SAMPLECONVERTER_TARGET("avx2")
+    static void UInt8(const uint8_t* in, size_t count, float* out) {
+        const __m256i bias = _mm256_set1_epi32(128);
+        const __m256 scale = _mm256_set1_ps(SCALE_8);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i)));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(v, bias)), scale));
+        }
+        ScalarOps::UInt8(in + i, count - i, out + i);
+    }
+
+    SAMPLECONVERTER_TARGET("avx2")
+    static void Int16(const uint8_t* in, size_t count, float* out) {
+        const __m256 scale = _mm256_set1_ps(SCALE_16);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2 + 16));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), scale));
+            _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), scale));
+        }
+        ScalarOps::Int16(in + i * 2, count - i, out + i);
+    }
+
+    // Eight samples (24 bytes) per step: each 128-bit lane loads 12 bytes
+    // and shuffles them into the top three bytes of four dwords.
+    SAMPLECONVERTER_TARGET("avx2")
+    static void Int24(const uint8_t* in, size_t count, float* out) {
+        const __m256i shuffle = _mm256_setr_epi8(
+            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+        const __m256 scale = _mm256_set1_ps(SCALE_24);
+        size_t i = 0;
+        // The upper lane's 16-byte load reaches 4 bytes past the 8 samples
+        for (; i + 10 <= count; i += 8) {
+            const uint8_t* p = in + i * 3;
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12));
+            const __m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+            const __m256i v = _mm256_srai_epi32(_mm256_shuffle_epi8(bytes, shuffle), 8);
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        }
+        ScalarOps::Int24(in + i * 3, count - i, out + i);
+    }
+
+    SAMPLECONVERTER_TARGET("avx2")
+    static void Int32(const uint8_t* in, size_t count, float* out) {
+        const __m256 scale = _mm256_set1_ps(SCALE_32);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 4));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        }
+        ScalarOps::Int32(in + i * 4, count - i, out + i);
+    }
+
+    static void Float32(const uint8_t* in, size_t count, float* out) {
+        ScalarOps::Float32(in, count, out);
+    }
+
+    SAMPLECONVERTER_TARGET("avx2")
+    static void Float64(const uint8_t* in, size_t count, float* out) {
+        const double* d = reinterpret_cast<const double*>(in);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(out + i, _mm256_cvtpd_ps(_mm256_loadu_pd(d + i)));
+        }
+        ScalarOps::Float64(in + i * 8, count - i, out + i);
+    }
+};
+
+#endif // SAMPLECONVERTER_X86
+
+#if SAMPLECONVERTER_NEON
+
+// vcvtq_n_f32_s32 treats the integers as fixed point with n fractional bits,
+// i.e. converts and scales by 2^-n in one rounding step
+struct NEONOps {
+    static void UInt8(const uint8_t* in, size_t count, float* out) {
+        const uint8x8_t bias = vdup_n_u8(128);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const uint8x16_t bytes = vld1q_u8(in + i);
+            // x - 128 wraps in 16 bits, which reinterpreted as signed is exact
+            const int16x8_t lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(bytes), bias));
+            const int16x8_t hi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(bytes), bias));
+            vst1q_f32(out + i, vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(lo)), 7));
+            vst1q_f32(out + i + 4, vcvtq_n_f32_s32(vmovl_s16(vget_high_s16(lo)), 7));
+            vst1q_f32(out + i + 8, vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(hi)), 7));
+            vst1q_f32(out + i + 12, vcvtq_n_f32_s32(vmovl_s16(vget_high_s16(hi)), 7));
+        }
+        ScalarOps::UInt8(in + i, count - i, out + i);
+    }
+
+    static void Int16(const uint8_t* in, size_t count, float* out) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const int16x8_t v = vld1q_s16(reinterpret_cast<const int16_t*>(in + i * 2));
+            vst1q_f32(out + i, vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(v)), 15));
+            vst1q_f32(out + i + 4, vcvtq_n_f32_s32(vmovl_s16(vget_high_s16(v)), 15));
+        }
+        ScalarOps::Int16(in + i * 2, count - i, out + i);
+    }
+
+    // vld3 splits 16 packed samples into low/mid/high byte planes; two zips
+    // rebuild them as dwords with the sample in the top 24 bits
+    static void Int24(const uint8_t* in, size_t count, float* out) {
+        const uint8x16_t zero = vdupq_n_u8(0);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const uint8x16x3_t planes = vld3q_u8(in + i * 3);
+            const uint8x16_t lowWords[2] = { vzip1q_u8(zero, planes.val[0]), vzip2q_u8(zero, planes.val[0]) };
+            const uint8x16_t highWords[2] = { vzip1q_u8(planes.val[1], planes.val[2]), vzip2q_u8(planes.val[1], planes.val[2]) };
+            for (int w = 0; w < 2; ++w) {
+                const uint16x8_t lo = vreinterpretq_u16_u8(lowWords[w]);
+                const uint16x8_t hi = vreinterpretq_u16_u8(highWords[w]);
+                const int32x4_t a = vreinterpretq_s32_u16(vzip1q_u16(lo, hi));
+                const int32x4_t b = vreinterpretq_s32_u16(vzip2q_u16(lo, hi));
+                vst1q_f32(out + i + w * 8, vcvtq_n_f32_s32(a, 31));
+                vst1q_f32(out + i + w * 8 + 4, vcvtq_n_f32_s32(b, 31));
+            }
+        }
+        ScalarOps::Int24(in + i * 3, count - i, out + i);
+    }
+
+    static void Int32(const uint8_t* in, size_t count, float* out) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            vst1q_f32(out + i, vcvtq_n_f32_s32(vld1q_s32(reinterpret_cast<const int32_t*>(in + i * 4)), 31));
+        }
+        ScalarOps::Int32(in + i * 4, count - i, out + i);
+    }
+
+    static void Float32(const uint8_t* in, size_t count, float* out) {
+        ScalarOps::Float32(in, count, out);
+    }
+
+    static void Float64(const uint8_t* in, size_t count, float* out) {
+        const double* d = reinterpret_cast<const double*>(in);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            vst1q_f32(out + i, vcombine_f32(vcvt_f32_f64(vld1q_f64(d + i)), vcvt_f32_f64(vld1q_f64(d + i + 2))));
+        }
+        ScalarOps::Float64(in + i * 8, count - i, out + i);
+    }
+};
+
+#endif // SAMPLECONVERTER_NEON
+
+template <typename Ops>
+SampleConverter::ConvertFn SelectKernel(SampleConverter::Encoding encoding) {
+    switch (encoding) {
+        case SampleConverter::Encoding::UInt8: return &Ops::UInt8;
+        case SampleConverter::Encoding::Int16: return &Ops::Int16;
+        case SampleConverter::Encoding::Int24: return &Ops::Int24;
+        case SampleConverter::Encoding::Int32: return &Ops::Int32;
+        case SampleConverter::Encoding::Float32: return &Ops::Float32;
+        case SampleConverter::Encoding::Float64: return &Ops::Float64;
+        default: return nullptr;
+    }
+}
+
+SampleConverter::Encoding ResolveEncoding(uint16_t formatTag, uint16_t bitsPerSample) {
+    if (formatTag == WAVE_FORMAT_PCM) {
+        switch (bitsPerSample) {
+            case 8: return SampleConverter::Encoding::UInt8;
+            case 16: return SampleConverter::Encoding::Int16;
+            case 24: return SampleConverter::Encoding::Int24;
+            case 32: return SampleConverter::Encoding::Int32;
+            default: break;
+        }
+    }
+    else if (formatTag == WAVE_FORMAT_IEEE_FLOAT) {
+        switch (bitsPerSample) {
+            case 32: return SampleConverter::Encoding::Float32;
+            case 64: return SampleConverter::Encoding::Float64;
+            default: break;
+        }
+    }
+    return SampleConverter::Encoding::Unknown;
+}
+}
+
+SampleConverter::SampleConverter()
+    : m_kernel(nullptr)
+{
+}
+
+bool SampleConverter::ParseWaveFormat(const void* waveFormat, size_t size, Format& format) {
+    const uint8_t* p = static_cast<const uint8_t*>(waveFormat);
+    if (!p || size < 16) {
+        std::cerr << "Wave format too short" << std::endl;
+        return false;
+    }
+
+    uint16_t formatTag = ReadU16(p);
+    format = {};
+    format.channels = ReadU16(p + 2);
+    format.sampleRate = ReadU32(p + 4);
+    format.blockAlign = ReadU16(p + 12);
+    format.bitsPerSample = ReadU16(p + 14);
+    format.validBits = format.bitsPerSample;
+
+    // WAVE_FORMAT_EXTENSIBLE: the real format is the first two bytes of the SubFormat GUID
+    if (formatTag == WAVE_FORMAT_EXTENSIBLE) {
+        if (size < 40) {
+            std::cerr << "Truncated WAVE_FORMAT_EXTENSIBLE header" << std::endl;
+            return false;
+        }
+        const uint16_t validBits = ReadU16(p + 18);
+        if (validBits != 0) {   // Some writers leave it unset
+            format.validBits = validBits;
+        }
+        format.channelMask = ReadU32(p + 20);
+        formatTag = ReadU16(p + 24);
+    }
+
+    if (format.channels == 0 || format.sampleRate == 0 || format.bitsPerSample % 8 != 0 ||
+        format.blockAlign != format.channels * (format.bitsPerSample / 8) ||
+        format.validBits > format.bitsPerSample) {
+        std::cerr << "Invalid wave format (" << format.channels << " channels, "
+                  << format.bitsPerSample << "-bit, block align " << format.blockAlign << ")" << std::endl;
+        return false;
+    }
+
+    format.encoding = ResolveEncoding(formatTag, format.bitsPerSample);
+    if (format.encoding == Encoding::Unknown) {
+        std::cerr << "Unsupported sample format (tag " << formatTag << ", "
+                  << format.bitsPerSample << "-bit)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+SampleConverter::ConvertFn SampleConverter::GetKernel(Encoding encoding, AudioKernels::InstructionSet isa) {
+    // Same instruction-set support as the analysis kernels
+    if (!AudioKernels::GetAnalyzeKernel(isa)) {
+        return nullptr;
+    }
+
+    switch (isa) {
+        case AudioKernels::InstructionSet::Scalar:
+            return SelectKernel<ScalarOps>(encoding);
+#if SAMPLECONVERTER_X86
+        case AudioKernels::InstructionSet::SSE2:
+            return SelectKernel<SSE2Ops>(encoding);
+        case AudioKernels::InstructionSet::AVX2:
+            return SelectKernel<AVX2Ops>(encoding);
+#endif
+#if SAMPLECONVERTER_NEON
+        case AudioKernels::InstructionSet::NEON:
+            return SelectKernel<NEONOps>(encoding);
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+SampleConverter::ConvertFn SampleConverter::GetKernel(Encoding encoding) {
+    return GetKernel(encoding, AudioKernels::GetActiveInstructionSet());
+}
+
+size_t SampleConverter::GetBytesPerSample(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::UInt8: return 1;
+        case Encoding::Int16: return 2;
+        case Encoding::Int24: return 3;
+        case Encoding::Int32: return 4;
+        case Encoding::Float32: return 4;
+        case Encoding::Float64: return 8;
+        default: return 0;
+    }
+}
+
+const char* SampleConverter::GetEncodingName(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::UInt8: return "8-bit PCM";
+        case Encoding::Int16: return "16-bit PCM";
+        case Encoding::Int24: return "24-bit PCM";
+        case Encoding::Int32: return "32-bit PCM";
+        case Encoding::Float32: return "32-bit float";
+        case Encoding::Float64: return "64-bit float";
+        default: return "Unknown";
+    }
+}
+
+bool SampleConverter::SetFormat(const Format& format) {
+    m_format = format;
+    m_kernel = GetKernel(format.encoding);
+    return m_kernel != nullptr;
+}
+
+void SampleConverter::Reserve(size_t maxFrames) {
+    if (m_buffer.size() < maxFrames * m_format.channels) {
+        m_buffer.resize(maxFrames * m_format.channels);
+    }
+}
+
+void SampleConverter::ConvertTo(const void* data, size_t frameCount, float* out) const {
+    if (m_kernel && data && frameCount > 0) {
+        m_kernel(static_cast<const uint8_t*>(data), frameCount * m_format.channels, out);
+    }
+}
+
+const float* SampleConverter::Convert(const void* data, size_t frameCount) {
+    if (!m_kernel || !data) {
+        return nullptr;
+    }
+
+    if (m_format.encoding == Encoding::Float32 &&
+        reinterpret_cast<uintptr_t>(data) % alignof(float) == 0) {
+        return static_cast<const float*>(data);
+    }
+
+    const size_t sampleCount = frameCount * m_format.channels;
+    if (m_buffer.size() < sampleCount) {
+        m_buffer.resize(sampleCount);
+    }
+    m_kernel(static_cast<const uint8_t*>(data), sampleCount, m_buffer.data());
+    return m_buffer.data();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "AudioKernels.h"
+
+// PCM/float -> interleaved float [-1, 1) for every sample layout a
+// WAVEFORMATEX or WAVEFORMATEXTENSIBLE can describe: 8-bit unsigned, 16-bit,
+// packed 24-bit, 32-bit integer (including 24-in-32 and other left-justified
+// containers) and 32/64-bit float. Shared by the WAV reader and the capture
+// backends. Kernels are vectorized per instruction set like AudioKernels; the
+// scalar kernels are the reference they must match exactly.
+class SampleConverter {
+public:
+    enum class Encoding {
+        Unknown,
+        UInt8,      // Offset binary
+        Int16,
+        Int24,      // Packed 3-byte samples
+        Int32,      // Also 24-in-32 and 20-in-32 containers (left-justified)
+        Float32,
+        Float64
+    };
+
+    struct Format {
+        Encoding encoding = Encoding::Unknown;
+        uint32_t sampleRate = 0;
+        uint16_t channels = 0;
+        uint16_t bitsPerSample = 0;   // Container size
+        uint16_t validBits = 0;       // Significant bits (<= container)
+        uint16_t blockAlign = 0;      // Bytes per frame
+        uint32_t channelMask = 0;     // Speaker positions (WAVE_FORMAT_EXTENSIBLE), 0 if not given
+    };
+
+    // Converts sampleCount samples; never allocates
+    using ConvertFn = void (*)(const uint8_t* in, size_t sampleCount, float* out);
+
+    SampleConverter();
+
+    // Parses a WAVEFORMATEX/WAVEFORMATEXTENSIBLE as laid out in a WAV fmt
+    // chunk or returned by IAudioClient::GetMixFormat; size is the bytes
+    // available. Returns false (with a message) for malformed or unsupported
+    // formats.
+    static bool ParseWaveFormat(const void* waveFormat, size_t size, Format& format);
+
+    // Best kernel for this CPU; nullptr for Unknown
+    static ConvertFn GetKernel(Encoding encoding);
+
+    // Specific kernel, or nullptr if the CPU/build does not support it
+    static ConvertFn GetKernel(Encoding encoding, AudioKernels::InstructionSet isa);
+
+    static size_t GetBytesPerSample(Encoding encoding);
+    static const char* GetEncodingName(Encoding encoding);
+
+    // Stream use: set the format once, then convert packets into the
+    // converter's own buffer, which only grows if a packet exceeds Reserve
+    bool SetFormat(const Format& format);
+    const Format& GetFormat() const { return m_format; }
+    void Reserve(size_t maxFrames);
+
+    // Interleaved floats for frameCount frames, valid until the next call.
+    // Aligned Float32 input is returned in place without copying.
+    const float* Convert(const void* data, size_t frameCount);
+
+    // Converts into the caller's buffer instead (frameCount * channels
+    // floats), e.g. both spans of a wrapped ring read back to back. Always
+    // converts; never allocates.
+    void ConvertTo(const void* data, size_t frameCount, float* out) const;
+
+private:
+    Format m_format;
+    ConvertFn m_kernel;
+    std::vector<float> m_buffer;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Hands a settings struct from configuration code (UI, config file reload) to
+// one hot thread (audio, haptic output) without ever blocking that thread.
+// Triple buffer: the writer fills a spare copy and swaps it in with one
+// atomic exchange; the reader swaps the newest copy out with another and then
+// reads it as plain memory. The reader never waits, locks or allocates;
+// copies (and whatever they allocate) happen on the writer's thread.
+template <typename T>
+class SettingsSnapshot {
+public:
+    explicit SettingsSnapshot(const T& initial = T{})
+        : m_slots{ initial, initial, initial }
+        , m_back(1)
+        , m_middle(2)
+        , m_front(0)
+    {
+    }
+
+    SettingsSnapshot(const SettingsSnapshot&) = delete;
+    SettingsSnapshot& operator=(const SettingsSnapshot&) = delete;
+
+    // Writer side, any thread (writers are serialized among themselves)
+    void Publish(const T& value) {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        m_slots[m_back] = value;
+        m_back = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side, one thread: adopts the newest published value. True if
+    // there was one since the last call (so the caller re-applies Get()).
+    bool Update() {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // Reader side: the value adopted by the last Update
+    const T& Get() const { return m_slots[m_front]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;   // Middle slot not yet seen by the reader
+
+    T m_slots[3];
+    std::mutex m_writeMutex;
+    uint8_t m_back;                 // Writer's slot (m_writeMutex)
+    std::atomic<uint8_t> m_middle;  // Last published slot, plus FRESH
+    uint8_t m_front;                // Reader's slot
+};
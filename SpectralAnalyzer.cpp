@@ -0,0 +1,163 @@
+#include "SpectralAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+}
+
+SpectralAnalyzer::SpectralAnalyzer()
+    : m_sampleRate(0)
+    , m_hopSize(0)
+    , m_fft(4)
+    , m_powerScale(0.0f)
+    , m_historyPos(0)
+    , m_samplesUntilHop(0)
+    , m_bandRanges{}
+    , m_bandEdges{}
+    , m_bassRange{}
+    , m_midRange{}
+    , m_trebleRange{}
+    , m_bands{}
+    , m_bass(0.0f)
+    , m_midrange(0.0f)
+    , m_treble(0.0f)
+    , m_framesAnalyzed(0)
+{
+    Configure(44100, Settings{});
+}
+
+void SpectralAnalyzer::Configure(uint32_t sampleRate, const Settings& settings) {
+    m_sampleRate = sampleRate ? sampleRate : 44100;
+    m_settings = settings;
+    m_settings.bandCount = std::clamp(m_settings.bandCount, size_t(1), MAX_BANDS);
+
+    m_fft = RealFft(m_settings.fftSize);
+    const size_t n = m_fft.GetSize();
+    m_settings.fftSize = n;
+    m_hopSize = n / 2;
+
+    // Periodic Hann; at 50% overlap the windows sum to a constant
+    m_window.resize(n);
+    double windowEnergy = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * static_cast<double>(i) / static_cast<double>(n)));
+        windowEnergy += static_cast<double>(m_window[i]) * m_window[i];
+    }
+
+    // Parseval: sum over the one-sided spectrum of 2|X|^2 / (N * sum(w^2)) is
+    // the mean square of the (unwindowed) signal
+    m_powerScale = static_cast<float>(1.0 / (static_cast<double>(n) * windowEnergy));
+
+    m_history.assign(n, 0.0f);
+    m_frame.assign(n, 0.0f);
+    m_binRe.assign(m_fft.GetBinCount(), 0.0f);
+    m_binIm.assign(m_fft.GetBinCount(), 0.0f);
+    m_binPower.assign(m_fft.GetBinCount(), 0.0f);
+
+    const float nyquist = 0.5f * static_cast<float>(m_sampleRate);
+    const float maxHz = std::min(m_settings.maxFrequency, nyquist);
+    const float minHz = std::clamp(m_settings.minFrequency, 1.0f, maxHz * 0.5f);
+    const float ratio = maxHz / minHz;
+
+    for (size_t b = 0; b <= m_settings.bandCount; ++b) {
+        m_bandEdges[b] = minHz * std::pow(ratio, static_cast<float>(b) / static_cast<float>(m_settings.bandCount));
+    }
+    for (size_t b = 0; b < m_settings.bandCount; ++b) {
+        m_bandRanges[b] = RangeForFrequencies(m_bandEdges[b], m_bandEdges[b + 1]);
+    }
+
+    m_bassRange = RangeForFrequencies(0.0f, m_settings.bassCutoff);
+    m_midRange = RangeForFrequencies(m_settings.bassCutoff, m_settings.trebleCutoff);
+    m_trebleRange = RangeForFrequencies(m_settings.trebleCutoff, nyquist);
+
+    Reset();
+}
+
+void SpectralAnalyzer::Reset() {
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_historyPos = 0;
+    m_samplesUntilHop = m_hopSize;
+    std::fill(std::begin(m_bands), std::end(m_bands), 0.0f);
+    m_bass = 0.0f;
+    m_midrange = 0.0f;
+    m_treble = 0.0f;
+    m_framesAnalyzed = 0;
+}
+
+SpectralAnalyzer::BinRange SpectralAnalyzer::RangeForFrequencies(float lowHz, float highHz) const {
+    const double binsPerHz = static_cast<double>(m_fft.GetSize()) / m_sampleRate;
+    const size_t lastBin = m_fft.GetBinCount();
+
+    // DC is excluded: an offset is not something an actuator should play
+    size_t begin = std::max<size_t>(1, static_cast<size_t>(std::lround(lowHz * binsPerHz)));
+    size_t end = static_cast<size_t>(std::lround(highHz * binsPerHz));
+    begin = std::min(begin, lastBin - 1);
+    end = std::clamp(end, begin + 1, lastBin);  // Narrow low bands still get one bin
+    return { begin, end };
+}
+
+float SpectralAnalyzer::RangeRms(const BinRange& range) const {
+    float sum = 0.0f;
+    for (size_t k = range.begin; k < range.end; ++k) {
+        sum += m_binPower[k];
+    }
+    return std::sqrt(sum);
+}
+
+bool SpectralAnalyzer::Push(const float* mono, size_t count) {
+    const size_t n = m_history.size();
+    bool produced = false;
+
+    while (count > 0) {
+        const size_t take = std::min({ count, m_samplesUntilHop, n - m_historyPos });
+        std::memcpy(m_history.data() + m_historyPos, mono, take * sizeof(float));
+
+        m_historyPos = (m_historyPos + take) & (n - 1);
+        m_samplesUntilHop -= take;
+        mono += take;
+        count -= take;
+
+        if (m_samplesUntilHop == 0) {
+            AnalyzeFrame();
+            m_samplesUntilHop = m_hopSize;
+            produced = true;
+        }
+    }
+
+    return produced;
+}
+
+void SpectralAnalyzer::AnalyzeFrame() {
+    const size_t n = m_history.size();
+
+    // Unwrap the ring (oldest sample at m_historyPos) while applying the window
+    const size_t tail = n - m_historyPos;
+    for (size_t i = 0; i < tail; ++i) {
+        m_frame[i] = m_history[m_historyPos + i] * m_window[i];
+    }
+    for (size_t i = tail; i < n; ++i) {
+        m_frame[i] = m_history[i - tail] * m_window[i];
+    }
+
+    m_fft.Forward(m_frame.data(), m_binRe.data(), m_binIm.data());
+
+    // One-sided power; DC and Nyquist appear once, every other bin twice
+    const size_t bins = m_binPower.size();
+    const float scale = 2.0f * m_powerScale;
+    for (size_t k = 0; k < bins; ++k) {
+        m_binPower[k] = (m_binRe[k] * m_binRe[k] + m_binIm[k] * m_binIm[k]) * scale;
+    }
+    m_binPower[0] *= 0.5f;
+    m_binPower[bins - 1] *= 0.5f;
+
+    for (size_t b = 0; b < m_settings.bandCount; ++b) {
+        m_bands[b] = RangeRms(m_bandRanges[b]);
+    }
+    m_bass = RangeRms(m_bassRange);
+    m_midrange = RangeRms(m_midRange);
+    m_treble = RangeRms(m_trebleRange);
+
+    ++m_framesAnalyzed;
+}
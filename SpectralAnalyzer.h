@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "RealFft.h"
+
+// Short-time spectrum of a mono stream: Hann window, 50% overlap, one real FFT
+// per hop. Bin powers are summed into log-spaced bands and into the fixed
+// bass/mid/treble ranges. Values are RMS amplitudes (Parseval-normalized), so
+// a band's value is directly comparable to the time-domain RMS of the signal.
+class SpectralAnalyzer {
+public:
+    static constexpr size_t MAX_BANDS = 16;
+
+    struct Settings {
+        size_t fftSize = 1024;          // Power of two; hop is half of it
+        size_t bandCount = 8;           // Log-spaced bands, up to MAX_BANDS
+        float minFrequency = 40.0f;     // Lower edge of the first band (Hz)
+        float maxFrequency = 16000.0f;  // Upper edge of the last band (Hz), capped at Nyquist
+        float bassCutoff = 250.0f;      // bass: below this (Hz)
+        float trebleCutoff = 4000.0f;   // treble: above this (Hz), midrange in between
+    };
+
+    SpectralAnalyzer();
+
+    // Allocates; call from setup code, not the audio path
+    void Configure(uint32_t sampleRate, const Settings& settings);
+    void Reset();
+
+    // Feed mono samples. Runs one FFT per completed hop. Returns true if at
+    // least one new spectrum frame was produced.
+    bool Push(const float* mono, size_t count);
+
+    // Latest spectrum frame (held until the next hop completes)
+    size_t GetBandCount() const { return m_settings.bandCount; }
+    const float* GetBands() const { return m_bands; }
+    float GetBandLowerEdge(size_t band) const { return m_bandEdges[band]; }
+    float GetBass() const { return m_bass; }
+    float GetMidrange() const { return m_midrange; }
+    float GetTreble() const { return m_treble; }
+
+    uint64_t GetFramesAnalyzed() const { return m_framesAnalyzed; }
+    size_t GetHopSize() const { return m_hopSize; }
+    size_t GetSamplesUntilHop() const { return m_samplesUntilHop; }     // Samples the next frame still needs
+    uint32_t GetSampleRate() const { return m_sampleRate; }
+    const Settings& GetSettings() const { return m_settings; }
+
+private:
+    struct BinRange {
+        size_t begin;
+        size_t end;     // Exclusive
+    };
+
+    BinRange RangeForFrequencies(float lowHz, float highHz) const;
+    float RangeRms(const BinRange& range) const;
+    void AnalyzeFrame();
+
+    Settings m_settings;
+    uint32_t m_sampleRate;
+    size_t m_hopSize;
+
+    RealFft m_fft;
+    std::vector<float> m_window;
+    float m_powerScale;             // Parseval normalization incl. window energy
+
+    // Input history ring of fftSize samples
+    std::vector<float> m_history;
+    size_t m_historyPos;
+    size_t m_samplesUntilHop;
+
+    // Per-frame scratch
+    std::vector<float> m_frame;
+    std::vector<float> m_binRe;
+    std::vector<float> m_binIm;
+    std::vector<float> m_binPower;
+
+    BinRange m_bandRanges[MAX_BANDS];
+    float m_bandEdges[MAX_BANDS + 1];
+    BinRange m_bassRange;
+    BinRange m_midRange;
+    BinRange m_trebleRange;
+
+    // Latest results
+    float m_bands[MAX_BANDS];
+    float m_bass;
+    float m_midrange;
+    float m_treble;
+    uint64_t m_framesAnalyzed;
+};
@@ -0,0 +1,419 @@
+#include "WasapiCaptureSource.h"
+#include <iostream>
+#include <algorithm>
+#include <comdef.h>
+#include <functiondiscoverykeys_devpkey.h>
+#include <propvarutil.h>
+#include <Mmreg.h>
+
+namespace {
+// Event-driven capture wakes at least this often to notice device errors
+constexpr uint32_t CAPTURE_WATCHDOG_MS = 2000;
+// Fallback when the engine can't signal us
+constexpr uint32_t CAPTURE_POLL_INTERVAL_MS = 10;
+
+// Without IAudioClient3 the engine keeps its own period; the buffer only has
+// to absorb a few of ours of scheduling jitter. Polling needs room for its
+// interval on top.
+constexpr REFERENCE_TIME EVENT_BUFFER_PERIODS = 4;
+constexpr REFERENCE_TIME POLL_BUFFER_DURATION = 100 * 10000;   // 100 ms, in 100 ns units
+
+// GetBuffer reports the performance counter at the packet's first frame, in
+// 100 ns units. Re-express it on steady_clock via its age relative to now.
+std::chrono::steady_clock::time_point QpcToSteadyClock(UINT64 qpcPosition) {
+    static const LONGLONG frequency = [] {
+        LARGE_INTEGER value;
+        QueryPerformanceFrequency(&value);
+        return value.QuadPart;
+    }();
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    const auto steadyNow = std::chrono::steady_clock::now();
+
+    // Split to avoid overflowing counter * 10^7
+    const LONGLONG now100ns = (counter.QuadPart / frequency) * 10000000 +
+                              (counter.QuadPart % frequency) * 10000000 / frequency;
+    const LONGLONG age100ns = (std::max)(now100ns - static_cast<LONGLONG>(qpcPosition), LONGLONG(0));
+    return steadyNow - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(age100ns * 100));
+}
+}
+
+WasapiCaptureSource::WasapiCaptureSource(bool loopback)
+    : m_loopback(loopback)
+    , m_targetPeriod(DEFAULT_PERIOD)
+    , m_deviceEnumerator(nullptr)
+    , m_device(nullptr)
+    , m_audioClient(nullptr)
+    , m_captureClient(nullptr)
+    , m_waveFormat(nullptr)
+    , m_bufferFrameCount(0)
+    , m_sampleRate(48000)
+    , m_channelCount(2)
+    , m_channelMask(0)
+    , m_eventDriven(false)
+{
+}
+
+WasapiCaptureSource::~WasapiCaptureSource() {
+    Stop();
+    Cleanup();
+}
+
+bool WasapiCaptureSource::Initialize() {
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    if (FAILED(hr) && hr != RPC_E_CHANGED_MODE) {
+        std::cerr << "Failed to initialize COM: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    const char* target = m_loopback ? "loopback" : "microphone";
+
+    try {
+        // Create device enumerator
+        hr = CoCreateInstance(
+            __uuidof(MMDeviceEnumerator), nullptr,
+            CLSCTX_ALL, __uuidof(IMMDeviceEnumerator),
+            (void**)&m_deviceEnumerator);
+
+        if (FAILED(hr)) {
+            std::cerr << "Failed to create device enumerator: " << std::hex << hr << std::endl;
+            return false;
+        }
+
+        // Loopback captures the default render endpoint, otherwise the default microphone
+        hr = m_deviceEnumerator->GetDefaultAudioEndpoint(m_loopback ? eRender : eCapture, eConsole, &m_device);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to get default " << (m_loopback ? "render" : "capture")
+                      << " endpoint: " << std::hex << hr << std::endl;
+            return false;
+        }
+
+        // Activate audio client
+        hr = m_device->Activate(
+            __uuidof(IAudioClient), CLSCTX_ALL,
+            nullptr, (void**)&m_audioClient);
+
+        if (FAILED(hr)) {
+            std::cerr << "Failed to activate audio client: " << std::hex << hr << std::endl;
+            return false;
+        }
+
+        // Get the default format
+        hr = m_audioClient->GetMixFormat(&m_waveFormat);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to get mix format: " << std::hex << hr << std::endl;
+            return false;
+        }
+
+        // Store format information
+        SampleConverter::Format format;
+        const size_t formatSize = sizeof(WAVEFORMATEX) +
+            (m_waveFormat->wFormatTag == WAVE_FORMAT_PCM ? 0 : m_waveFormat->cbSize);
+        if (!SampleConverter::ParseWaveFormat(m_waveFormat, formatSize, format) || !m_converter.SetFormat(format)) {
+            std::cerr << "Unsupported " << target << " mix format" << std::endl;
+            return false;
+        }
+        m_sampleRate = format.sampleRate;
+        m_channelCount = format.channels;
+        m_channelMask = format.channelMask;
+
+        std::cout << (m_loopback ? "Audio format: " : "Microphone format: ")
+                  << m_sampleRate << " Hz, " << m_channelCount << " channels, "
+                  << SampleConverter::GetEncodingName(format.encoding) << std::endl;
+
+        // Initialize the audio client; loopback captures system audio
+        hr = InitializeAudioClientStream(m_loopback ? AUDCLNT_STREAMFLAGS_LOOPBACK : 0);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to initialize audio client for " << target << ": " << std::hex << hr << std::endl;
+            return false;
+        }
+
+        // Get buffer size
+        hr = m_audioClient->GetBufferSize(&m_bufferFrameCount);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to get buffer size: " << std::hex << hr << std::endl;
+            return false;
+        }
+        m_converter.Reserve(m_bufferFrameCount);
+        std::cout << "Capture buffer: " << (m_bufferFrameCount * 1000.0 / m_sampleRate) << " ms" << std::endl;
+
+        // Get capture client
+        hr = m_audioClient->GetService(__uuidof(IAudioCaptureClient), (void**)&m_captureClient);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to get capture client: " << std::hex << hr << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+    catch (...) {
+        std::cerr << "Exception in WasapiCaptureSource::Initialize (" << target << ")" << std::endl;
+        return false;
+    }
+}
+
+HRESULT WasapiCaptureSource::InitializeAudioClientStream(DWORD streamFlags) {
+    // Prefer event-driven capture: the capture thread sleeps until the audio
+    // engine signals a new period instead of polling on a timer. Where the
+    // driver allows it, shorten the period itself to the target.
+    HRESULT hr = InitializeLowLatencyStream(streamFlags);
+    if (SUCCEEDED(hr)) {
+        return hr;
+    }
+
+    const REFERENCE_TIME targetPeriod = static_cast<REFERENCE_TIME>(m_targetPeriod.count()) * 10000;
+    hr = ReactivateAudioClient();
+    if (SUCCEEDED(hr)) {
+        hr = InitializeEventStream(streamFlags, targetPeriod * EVENT_BUFFER_PERIODS);
+        if (SUCCEEDED(hr)) {
+            return hr;
+        }
+    }
+
+    // Older Windows builds reject event callbacks on loopback streams
+    std::cout << "Event-driven capture unavailable (" << std::hex << hr << std::dec
+              << "), falling back to polling" << std::endl;
+
+    hr = ReactivateAudioClient();
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    m_eventDriven = false;
+    return m_audioClient->Initialize(
+        AUDCLNT_SHAREMODE_SHARED,
+        streamFlags,
+        (std::max)(targetPeriod * EVENT_BUFFER_PERIODS, POLL_BUFFER_DURATION),
+        0,
+        m_waveFormat,
+        nullptr);
+}
+
+HRESULT WasapiCaptureSource::InitializeLowLatencyStream(DWORD streamFlags) {
+    IAudioClient3* audioClient3 = nullptr;
+    HRESULT hr = m_audioClient->QueryInterface(__uuidof(IAudioClient3), (void**)&audioClient3);
+    if (FAILED(hr)) {
+        return hr;     // Before Windows 10
+    }
+
+    // Periods are in frames, in multiples of the fundamental period
+    UINT32 defaultPeriod = 0;
+    UINT32 fundamentalPeriod = 0;
+    UINT32 minPeriod = 0;
+    UINT32 maxPeriod = 0;
+    hr = audioClient3->GetSharedModeEnginePeriod(m_waveFormat, &defaultPeriod, &fundamentalPeriod, &minPeriod, &maxPeriod);
+    if (SUCCEEDED(hr) && fundamentalPeriod > 0) {
+        const UINT32 target = static_cast<UINT32>(m_waveFormat->nSamplesPerSec * m_targetPeriod.count() / 1000);
+        const UINT32 rounded = (target + fundamentalPeriod / 2) / fundamentalPeriod * fundamentalPeriod;
+        const UINT32 period = (std::min)((std::max)(rounded, minPeriod), maxPeriod);
+
+        hr = audioClient3->InitializeSharedAudioStream(
+            streamFlags | AUDCLNT_STREAMFLAGS_EVENTCALLBACK, period, m_waveFormat, nullptr);
+        if (SUCCEEDED(hr)) {
+            hr = m_audioClient->SetEventHandle(static_cast<HANDLE>(m_captureEvent.GetNativeHandle()));
+        }
+        if (SUCCEEDED(hr)) {
+            m_eventDriven = true;
+            std::cout << "Capture period: " << (period * 1000.0 / m_waveFormat->nSamplesPerSec) << " ms (engine default "
+                      << (defaultPeriod * 1000.0 / m_waveFormat->nSamplesPerSec) << " ms)" << std::endl;
+        }
+    }
+
+    audioClient3->Release();
+    return hr;
+}
+
+HRESULT WasapiCaptureSource::InitializeEventStream(DWORD streamFlags, REFERENCE_TIME bufferDuration) {
+    HRESULT hr = m_audioClient->Initialize(
+        AUDCLNT_SHAREMODE_SHARED,
+        streamFlags | AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+        bufferDuration,
+        0,
+        m_waveFormat,
+        nullptr);
+
+    if (SUCCEEDED(hr)) {
+        hr = m_audioClient->SetEventHandle(static_cast<HANDLE>(m_captureEvent.GetNativeHandle()));
+    }
+    if (SUCCEEDED(hr)) {
+        m_eventDriven = true;
+    }
+    return hr;
+}
+
+HRESULT WasapiCaptureSource::ReactivateAudioClient() {
+    if (m_audioClient) {
+        m_audioClient->Release();
+        m_audioClient = nullptr;
+    }
+    return m_device->Activate(
+        __uuidof(IAudioClient), CLSCTX_ALL,
+        nullptr, (void**)&m_audioClient);
+}
+
+bool WasapiCaptureSource::Start() {
+    if (!m_audioClient) {
+        return false;
+    }
+
+    m_captureEvent.Reset();
+    HRESULT hr = m_audioClient->Start();
+    if (FAILED(hr)) {
+        std::cerr << "Failed to start audio client: " << std::hex << hr << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void WasapiCaptureSource::Stop() {
+    if (m_audioClient) {
+        m_audioClient->Stop();
+    }
+}
+
+void WasapiCaptureSource::Interrupt() {
+    m_captureEvent.Signal();
+}
+
+bool WasapiCaptureSource::Capture(const DataSink& sink) {
+    // Block until the audio engine signals a new period (or Interrupt wakes
+    // us). In polling mode the same wait just paces the loop.
+    auto wait = m_captureEvent.Wait(m_eventDriven ? CAPTURE_WATCHDOG_MS : CAPTURE_POLL_INTERVAL_MS);
+    if (wait == CaptureEvent::WaitResult::Failed) {
+        std::cerr << "Failed to wait for capture event" << std::endl;
+        return false;
+    }
+
+    UINT32 packetLength = 0;
+    HRESULT hr = m_captureClient->GetNextPacketSize(&packetLength);
+
+    if (FAILED(hr)) {
+        std::cerr << "Failed to get packet size: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    while (packetLength != 0) {
+        BYTE* data;
+        UINT32 framesAvailable;
+        DWORD flags;
+        UINT64 qpcPosition = 0;
+
+        hr = m_captureClient->GetBuffer(&data, &framesAvailable, &flags, nullptr, &qpcPosition);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to get buffer: " << std::hex << hr << std::endl;
+            break;
+        }
+
+        // The sink only copies into the pipeline; processing happens on its consumer thread
+        if (framesAvailable > 0) {
+            const auto captureTime = (flags & AUDCLNT_BUFFERFLAGS_TIMESTAMP_ERROR) || qpcPosition == 0
+                ? std::chrono::steady_clock::now()
+                : QpcToSteadyClock(qpcPosition);
+
+            // Float mix formats pass through; anything else lands in the converter's reserved buffer
+            const float* samples = m_converter.Convert(data, framesAvailable);
+            sink(samples, framesAvailable * m_channelCount, m_channelCount, captureTime);
+        }
+
+        hr = m_captureClient->ReleaseBuffer(framesAvailable);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to release buffer: " << std::hex << hr << std::endl;
+            return false;
+        }
+
+        hr = m_captureClient->GetNextPacketSize(&packetLength);
+        if (FAILED(hr)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void WasapiCaptureSource::Cleanup() {
+    if (m_captureClient) {
+        m_captureClient->Release();
+        m_captureClient = nullptr;
+    }
+    if (m_audioClient) {
+        m_audioClient->Release();
+        m_audioClient = nullptr;
+    }
+    if (m_device) {
+        m_device->Release();
+        m_device = nullptr;
+    }
+    if (m_deviceEnumerator) {
+        m_deviceEnumerator->Release();
+        m_deviceEnumerator = nullptr;
+    }
+    if (m_waveFormat) {
+        CoTaskMemFree(m_waveFormat);
+        m_waveFormat = nullptr;
+    }
+}
+
+// Static utility methods
+std::vector<std::string> WasapiCaptureSource::GetAvailableDevices() {
+    std::vector<std::string> devices;
+
+    IMMDeviceEnumerator* enumerator = nullptr;
+    HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr,
+                                  CLSCTX_ALL, __uuidof(IMMDeviceEnumerator),
+                                  (void**)&enumerator);
+
+    if (SUCCEEDED(hr)) {
+        IMMDeviceCollection* collection = nullptr;
+        hr = enumerator->EnumAudioEndpoints(eAll, DEVICE_STATE_ACTIVE, &collection);
+
+        if (SUCCEEDED(hr)) {
+            UINT count;
+            collection->GetCount(&count);
+
+            for (UINT i = 0; i < count; i++) {
+                IMMDevice* device = nullptr;
+                if (SUCCEEDED(collection->Item(i, &device))) {
+                    IPropertyStore* props = nullptr;
+                    if (SUCCEEDED(device->OpenPropertyStore(STGM_READ, &props))) {
+                        PROPVARIANT varName;
+                        PropVariantInit(&varName);
+
+                        if (SUCCEEDED(props->GetValue(PKEY_Device_FriendlyName, &varName))) {
+                            if (varName.vt == VT_LPWSTR) {
+                                // Convert wide string to regular string
+                                int len = WideCharToMultiByte(CP_UTF8, 0, varName.pwszVal, -1, nullptr, 0, nullptr, nullptr);
+                                if (len > 0) {
+                                    std::string deviceName(len - 1, 0);
+                                    WideCharToMultiByte(CP_UTF8, 0, varName.pwszVal, -1, &deviceName[0], len, nullptr, nullptr);
+                                    devices.push_back(deviceName);
+                                }
+                            }
+                        }
+
+                        PropVariantClear(&varName);
+                        props->Release();
+                    }
+                    device->Release();
+                }
+            }
+            collection->Release();
+        }
+        enumerator->Release();
+    }
+
+    return devices;
+}
+
+bool WasapiCaptureSource::IsAvailable() {
+    IMMDeviceEnumerator* enumerator = nullptr;
+    HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr,
+                                  CLSCTX_ALL, __uuidof(IMMDeviceEnumerator),
+                                  (void**)&enumerator);
+
+    if (SUCCEEDED(hr)) {
+        enumerator->Release();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Windows.h>
+#include <mmdeviceapi.h>
+#include <audioclient.h>
+#include <audiopolicy.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include "ICaptureSource.h"
+#include "CaptureEvent.h"
+#include "SampleConverter.h"
+
+// WASAPI shared-mode capture: loopback of the default render endpoint
+// (system audio) or the default capture endpoint (microphone). The stream is
+// negotiated from the lowest latency down: an IAudioClient3 engine period
+// near the target, then an event-driven stream with a buffer of a few target
+// periods, then polling.
+class WasapiCaptureSource : public ICaptureSource {
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_PERIOD{ 10 };
+
+    explicit WasapiCaptureSource(bool loopback);
+    ~WasapiCaptureSource() override;
+
+    // Engine period to aim for; the driver's nearest supported period is used.
+    // Call before Initialize.
+    void SetTargetPeriod(std::chrono::milliseconds period) { m_targetPeriod = period; }
+
+    bool Initialize() override;
+    bool Start() override;
+    void Stop() override;
+    bool Capture(const DataSink& sink) override;
+    void Interrupt() override;
+
+    uint32_t GetSampleRate() const override { return m_sampleRate; }
+    uint32_t GetChannelCount() const override { return m_channelCount; }
+    uint32_t GetChannelMask() const override { return m_channelMask; }
+    bool IsEventDriven() const override { return m_eventDriven; }
+
+    // Static utility methods
+    static std::vector<std::string> GetAvailableDevices();
+    static bool IsAvailable();
+
+private:
+    HRESULT InitializeAudioClientStream(DWORD streamFlags);
+    HRESULT InitializeLowLatencyStream(DWORD streamFlags);
+    HRESULT InitializeEventStream(DWORD streamFlags, REFERENCE_TIME bufferDuration);
+    // An audio client can only be initialized once, so each fallback needs a fresh one
+    HRESULT ReactivateAudioClient();
+    void Cleanup();
+
+    bool m_loopback;
+    std::chrono::milliseconds m_targetPeriod;
+
+    IMMDeviceEnumerator* m_deviceEnumerator;
+    IMMDevice* m_device;
+    IAudioClient* m_audioClient;
+    IAudioCaptureClient* m_captureClient;
+    WAVEFORMATEX* m_waveFormat;
+    UINT32 m_bufferFrameCount;
+
+    // Audio format
+    UINT32 m_sampleRate;
+    UINT32 m_channelCount;
+    DWORD m_channelMask;
+
+    // Mix format -> float, into a buffer sized for the whole endpoint buffer
+    SampleConverter m_converter;
+
+    // Capture-ready event: signalled by the audio engine, and by Interrupt
+    CaptureEvent m_captureEvent;
+    bool m_eventDriven;
+};
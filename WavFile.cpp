@@ -0,0 +1,149 @@
+#include "WavFile.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+// RF64 stores 0xFFFFFFFF in 32-bit size fields and the real size in ds64
+constexpr uint32_t RF64_SIZE_PLACEHOLDER = 0xFFFFFFFF;
+
+uint32_t ReadU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t ReadU64(const uint8_t* p) {
+    return static_cast<uint64_t>(ReadU32(p)) | (static_cast<uint64_t>(ReadU32(p + 4)) << 32);
+}
+
+bool ChunkIdIs(const uint8_t* p, const char* id) {
+    return std::memcmp(p, id, 4) == 0;
+}
+}
+
+WavFile::WavFile()
+    : m_kernel(nullptr)
+    , m_data(nullptr)
+    , m_frameCount(0)
+{
+}
+
+bool WavFile::Open(const std::string& path) {
+    Close();
+
+    if (!m_file.Open(path)) {
+        return false;
+    }
+
+    if (!ParseHeader(path)) {
+        Close();
+        return false;
+    }
+
+    std::cout << "WAV file: " << path << " - " << m_format.sampleRate << " Hz, "
+              << m_format.channels << " channels, "
+              << SampleConverter::GetEncodingName(m_format.encoding) << ", "
+              << GetDurationSeconds() << " seconds" << std::endl;
+    return true;
+}
+
+void WavFile::Close() {
+    m_file.Close();
+    m_format = {};
+    m_kernel = nullptr;
+    m_data = nullptr;
+    m_frameCount = 0;
+}
+
+double WavFile::GetDurationSeconds() const {
+    return m_format.sampleRate ? static_cast<double>(m_frameCount) / m_format.sampleRate : 0.0;
+}
+
+bool WavFile::ParseHeader(const std::string& path) {
+    const uint8_t* base = m_file.GetData();
+    const uint64_t fileSize = m_file.GetSize();
+
+    if (fileSize < 12 || !(ChunkIdIs(base, "RIFF") || ChunkIdIs(base, "RF64")) || !ChunkIdIs(base + 8, "WAVE")) {
+        std::cerr << "Not a RIFF/RF64 WAVE file: " << path << std::endl;
+        return false;
+    }
+
+    const bool isRF64 = ChunkIdIs(base, "RF64");
+    uint64_t rf64DataSize = 0;
+    const uint8_t* formatChunk = nullptr;
+    size_t formatSize = 0;
+
+    uint64_t offset = 12;
+    while (offset + 8 <= fileSize) {
+        const uint8_t* chunk = base + offset;
+        uint64_t chunkSize = ReadU32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        const uint64_t bodyAvailable = fileSize - offset - 8;
+
+        if (ChunkIdIs(chunk, "ds64") && chunkSize >= 16 && bodyAvailable >= 16) {
+            rf64DataSize = ReadU64(body + 8);
+        }
+        else if (ChunkIdIs(chunk, "fmt ") && chunkSize >= 16 && bodyAvailable >= 16) {
+            // Parsed once the data chunk is found; the body is a WAVEFORMATEX(TENSIBLE)
+            formatChunk = body;
+            formatSize = static_cast<size_t>((std::min)(chunkSize, bodyAvailable));
+        }
+        else if (ChunkIdIs(chunk, "data")) {
+            if (!formatChunk) {
+                std::cerr << "WAV data chunk before fmt chunk: " << path << std::endl;
+                return false;
+            }
+
+            if (isRF64 && chunkSize == RF64_SIZE_PLACEHOLDER) {
+                chunkSize = rf64DataSize;
+            }
+            // Tolerate truncated files and recorders that never patched the size
+            chunkSize = (std::min)(chunkSize, bodyAvailable);
+
+            if (!SampleConverter::ParseWaveFormat(formatChunk, formatSize, m_format)) {
+                std::cerr << "Unsupported or invalid WAV format: " << path << std::endl;
+                return false;
+            }
+
+            m_data = body;
+            m_frameCount = chunkSize / m_format.blockAlign;
+            break;
+        }
+
+        // Chunks are padded to an even size
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (!m_data) {
+        std::cerr << "WAV file has no fmt/data chunk: " << path << std::endl;
+        return false;
+    }
+
+    m_kernel = SampleConverter::GetKernel(m_format.encoding);
+    return true;
+}
+
+const float* WavFile::GetFloatFrames(uint64_t frame) const {
+    if (!m_data || m_format.encoding != SampleConverter::Encoding::Float32 || frame >= m_frameCount) {
+        return nullptr;
+    }
+
+    const uint8_t* p = m_data + frame * m_format.blockAlign;
+    if (reinterpret_cast<uintptr_t>(p) % alignof(float) != 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<const float*>(p);
+}
+
+size_t WavFile::ReadFrames(uint64_t frame, size_t frameCount, float* out) const {
+    if (!m_data || frame >= m_frameCount) {
+        return 0;
+    }
+
+    frameCount = static_cast<size_t>((std::min)(static_cast<uint64_t>(frameCount), m_frameCount - frame));
+    const size_t sampleCount = frameCount * m_format.channels;
+    const uint8_t* in = m_data + frame * m_format.blockAlign;
+
+    m_kernel(in, sampleCount, out);
+    return frameCount;
+}
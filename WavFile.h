@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+#include "SampleConverter.h"
+
+// Memory-mapped WAV reader. Supports RIFF and RF64 (for recordings over 4 GB)
+// with every sample format SampleConverter decodes (8/16/24/32-bit PCM,
+// including 24-in-32 extensible containers, and 32/64-bit float), any channel
+// count and sample rate.
+class WavFile {
+public:
+    using Format = SampleConverter::Format;
+
+    WavFile();
+    ~WavFile() = default;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr; }
+    const Format& GetFormat() const { return m_format; }
+    uint64_t GetFrameCount() const { return m_frameCount; }
+    double GetDurationSeconds() const;
+
+    // Float32 data that is suitably aligned in the mapping can be consumed in
+    // place. Returns nullptr when the samples need converting.
+    const float* GetFloatFrames(uint64_t frame) const;
+
+    // Convert frames to interleaved float [-1, 1). Returns frames written.
+    size_t ReadFrames(uint64_t frame, size_t frameCount, float* out) const;
+
+private:
+    bool ParseHeader(const std::string& path);
+
+    MappedFile m_file;
+    Format m_format;
+    SampleConverter::ConvertFn m_kernel;
+    const uint8_t* m_data;  // First byte of the data chunk
+    uint64_t m_frameCount;
+};
@@ -0,0 +1,89 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool()
+    : m_generation(0)
+    , m_busyWorkers(0)
+    , m_stopping(false)
+    , m_task(nullptr)
+    , m_context(nullptr)
+    , m_count(0)
+    , m_next(0)
+{
+}
+
+WorkerPool::~WorkerPool() {
+    Stop();
+}
+
+void WorkerPool::Start(size_t workerCount) {
+    Stop();
+    m_stopping = false;
+    m_workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&WorkerPool::WorkerLoop, this, m_generation);
+    }
+}
+
+void WorkerPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workReady.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void WorkerPool::RunTasks(size_t count, TaskFn task, void* context) {
+    if (m_workers.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(context, i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = task;
+        m_context = context;
+        m_count = count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_busyWorkers = m_workers.size();
+        ++m_generation;
+    }
+    m_workReady.notify_all();
+
+    // The caller works too, so a Run never waits on a wake-up alone
+    Drain();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_workDone.wait(lock, [this] { return m_busyWorkers == 0; });
+}
+
+void WorkerPool::WorkerLoop(uint64_t seen) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workReady.wait(lock, [&] { return m_stopping || m_generation != seen; });
+            if (m_stopping) {
+                return;
+            }
+            seen = m_generation;
+        }
+
+        Drain();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busyWorkers == 0) {
+            m_workDone.notify_one();
+        }
+    }
+}
+
+void WorkerPool::Drain() {
+    for (size_t i = m_next.fetch_add(1, std::memory_order_relaxed); i < m_count; i = m_next.fetch_add(1, std::memory_order_relaxed)) {
+        m_task(m_context, i);
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fork-join pool for blocking calls that should overlap (device
+// writes). Run(count, task) calls task(i) for every i in [0, count) on the
+// workers and the calling thread, and returns once all calls are done. One
+// Run at a time; nothing is allocated per Run.
+class WorkerPool {
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // (Re)starts with this many worker threads (0 = Run works on the caller only)
+    void Start(size_t workerCount);
+    void Stop();
+    size_t GetWorkerCount() const { return m_workers.size(); }
+
+    template <typename Task>
+    void Run(size_t count, Task& task) {
+        RunTasks(count, [](void* context, size_t index) { (*static_cast<Task*>(context))(index); }, &task);
+    }
+
+private:
+    using TaskFn = void (*)(void* context, size_t index);
+
+    void RunTasks(size_t count, TaskFn task, void* context);
+    // seen: the generation at spawn, so a worker only joins later Runs
+    void WorkerLoop(uint64_t seen);
+    // Claims and runs indices until none are left
+    void Drain();
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workReady;
+    std::condition_variable m_workDone;
+    uint64_t m_generation;      // Bumped by every Run
+    size_t m_busyWorkers;       // Workers still inside the current Run
+    bool m_stopping;
+
+    // The current Run; indices are claimed with m_next
+    TaskFn m_task;
+    void* m_context;
+    size_t m_count;
+    std::atomic<size_t> m_next;
+};
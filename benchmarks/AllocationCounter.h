@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts heap allocations made through global operator new (replaced in
+// AllocationCounter.cpp), so benchmarks can report allocations per call.
+namespace AllocationCounter {
+    uint64_t GetCount();
+}
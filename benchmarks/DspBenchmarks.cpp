@@ -0,0 +1,298 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "AudioProcessor.h"
+#include "CaptureFreshnessGuard.h"
+#include "CaptureRingReader.h"
+#include "SampleConverter.h"
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+
+// One second of interleaved music-like test signal: bass and treble tones
+// with a per-channel phase offset, plus a little noise
+std::vector<float> MakeSignal(size_t channels, uint32_t sampleRate) {
+    std::vector<float> samples(static_cast<size_t>(sampleRate) * channels);
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+    for (size_t frame = 0; frame < sampleRate; ++frame) {
+        const double t = static_cast<double>(frame) / sampleRate;
+        for (size_t ch = 0; ch < channels; ++ch) {
+            const double phase = 0.3 * static_cast<double>(ch);
+            samples[frame * channels + ch] = static_cast<float>(
+                0.5 * std::sin(2.0 * PI * 60.0 * t + phase) + 0.2 * std::sin(2.0 * PI * 6000.0 * t + phase)) + noise(rng);
+        }
+    }
+    return samples;
+}
+
+void SetCounters(benchmark::State& state, size_t framesPerCall, uint64_t allocations) {
+    // Seconds per frame, shown with an SI prefix (e.g. "2.7n" = 2.7 ns/frame)
+    state.counters["time/frame"] = benchmark::Counter(static_cast<double>(framesPerCall),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    state.counters["allocs/call"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+// Args: channels, frames per call, sample rate
+void RunProcessAudio(benchmark::State& state, bool decimated) {
+    const size_t channels = static_cast<size_t>(state.range(0));
+    const size_t frames = static_cast<size_t>(state.range(1));
+    const uint32_t sampleRate = static_cast<uint32_t>(state.range(2));
+
+    AudioProcessor processor;
+    processor.SetSampleRate(sampleRate);
+    processor.SetDecimatedAnalysis(decimated);
+    const std::vector<float> signal = MakeSignal(channels, sampleRate);
+
+    // Walk through the signal so the analyzer sees continuous audio
+    const size_t blocks = (std::max)(signal.size() / channels / frames, size_t(1));
+    size_t block = 0;
+
+    // Warm up: first calls size the analysis buffers
+    for (size_t i = 0; i < blocks; ++i) {
+        benchmark::DoNotOptimize(processor.ProcessAudio(&signal[i * frames * channels], frames * channels, channels));
+    }
+
+    const uint64_t allocationsBefore = AllocationCounter::GetCount();
+    for (auto _ : state) {
+        auto features = processor.ProcessAudio(&signal[block * frames * channels], frames * channels, channels);
+        benchmark::DoNotOptimize(features);
+        block = (block + 1) % blocks;
+    }
+    SetCounters(state, frames, AllocationCounter::GetCount() - allocationsBefore);
+}
+
+void BM_ProcessAudio(benchmark::State& state) {
+    RunProcessAudio(state, false);
+}
+
+void BM_ProcessAudioDecimated(benchmark::State& state) {
+    RunProcessAudio(state, true);
+}
+
+// Capture/WAV sample conversion through SampleConverter, per kernel so each
+// SIMD path can be compared with the scalar reference.
+// Args: encoding, instruction set, frames per packet (stereo)
+void BM_ConvertSamples(benchmark::State& state) {
+    const auto encoding = static_cast<SampleConverter::Encoding>(state.range(0));
+    const auto isa = static_cast<AudioKernels::InstructionSet>(state.range(1));
+    const size_t channels = 2;
+    const size_t samples = static_cast<size_t>(state.range(2)) * channels;
+
+    SampleConverter::ConvertFn kernel = SampleConverter::GetKernel(encoding, isa);
+    if (!kernel) {
+        state.SkipWithError("Instruction set not supported on this CPU/build");
+        return;
+    }
+    state.SetLabel(std::string(SampleConverter::GetEncodingName(encoding)) + " " + AudioKernels::GetInstructionSetName(isa));
+
+    // Random bytes are valid samples for the integer encodings; floats get real values
+    std::vector<uint8_t> packet(samples * SampleConverter::GetBytesPerSample(encoding));
+    std::mt19937 rng(1234);
+    if (encoding == SampleConverter::Encoding::Float32 || encoding == SampleConverter::Encoding::Float64) {
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (size_t i = 0; i < samples; ++i) {
+            if (encoding == SampleConverter::Encoding::Float32) {
+                const float value = static_cast<float>(dist(rng));
+                std::memcpy(&packet[i * sizeof(value)], &value, sizeof(value));
+            }
+            else {
+                const double value = dist(rng);
+                std::memcpy(&packet[i * sizeof(value)], &value, sizeof(value));
+            }
+        }
+    }
+    else {
+        for (auto& byte : packet) {
+            byte = static_cast<uint8_t>(rng());
+        }
+    }
+    std::vector<float> out(samples);
+
+    const uint64_t allocationsBefore = AllocationCounter::GetCount();
+    for (auto _ : state) {
+        kernel(packet.data(), samples, out.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    SetCounters(state, samples / channels, AllocationCounter::GetCount() - allocationsBefore);
+}
+
+// The analysis kernel alone, generic (layout = 0) against the one compiled
+// for the channel count (layout = 1), per instruction set. Same call shape as
+// ProcessAudio: 1024-frame chunks with the mono signal written out.
+// Args: channels, instruction set, layout
+void BM_AnalyzeKernel(benchmark::State& state) {
+    const size_t channels = static_cast<size_t>(state.range(0));
+    const auto isa = static_cast<AudioKernels::InstructionSet>(state.range(1));
+    const bool layout = state.range(2) != 0;
+    const size_t frames = 1024;
+
+    AudioKernels::AnalyzeFn kernel = layout ? AudioKernels::GetAnalyzeKernel(isa, channels) : AudioKernels::GetAnalyzeKernel(isa);
+    if (!kernel) {
+        state.SkipWithError("Instruction set not supported on this CPU/build");
+        return;
+    }
+    state.SetLabel(std::string(AudioKernels::GetInstructionSetName(isa)) + (layout ? " layout" : " generic"));
+
+    const std::vector<float> signal = MakeSignal(channels, 48000);
+    std::vector<float> mono(frames);
+    const size_t blocks = signal.size() / channels / frames;
+    size_t block = 0;
+
+    const uint64_t allocationsBefore = AllocationCounter::GetCount();
+    for (auto _ : state) {
+        AudioKernels::BlockStats stats;
+        kernel(&signal[block * frames * channels], frames, channels, stats, mono.data());
+        benchmark::DoNotOptimize(stats);
+        benchmark::ClobberMemory();
+        block = (block + 1) % blocks;
+    }
+    SetCounters(state, frames, AllocationCounter::GetCount() - allocationsBefore);
+}
+
+// DirectSound-style capture from a simulated one-second circular buffer
+// (44.1 kHz, 16-bit stereo): the device cursor moves one chunk per
+// iteration, and the reader converts the readable region straight from its
+// one or two spans (staged = 0), or first copies it into a staging buffer
+// like the old half-buffer path did (staged = 1). Chunks that do not divide
+// the buffer wrap at varying offsets.
+// Args: chunk in ms, staged
+void BM_CaptureRingRead(benchmark::State& state) {
+    const uint32_t chunkMs = static_cast<uint32_t>(state.range(0));
+    const bool staged = state.range(1) != 0;
+    const uint32_t sampleRate = 44100;
+    const uint32_t blockAlign = 4;
+    const uint32_t bufferBytes = sampleRate * blockAlign;
+    const uint32_t chunkBytes = sampleRate * chunkMs / 1000 * blockAlign;
+
+    SampleConverter::Format format;
+    format.encoding = SampleConverter::Encoding::Int16;
+    format.sampleRate = sampleRate;
+    format.channels = 2;
+    format.bitsPerSample = 16;
+    format.validBits = 16;
+    format.blockAlign = blockAlign;
+    SampleConverter converter;
+    converter.SetFormat(format);
+    converter.Reserve(bufferBytes / blockAlign);
+
+    std::vector<uint8_t> device(bufferBytes);
+    std::mt19937 rng(1234);
+    for (auto& byte : device) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    std::vector<uint8_t> staging(bufferBytes);
+    std::vector<float> samples(bufferBytes / blockAlign * format.channels);
+
+    // Only the read side matters here; the buffer stays one second long
+    CaptureRingReader ring;
+    ring.Configure(bufferBytes, blockAlign, blockAlign);
+    uint32_t writePosition = 0;
+
+    const uint64_t allocationsBefore = AllocationCounter::GetCount();
+    for (auto _ : state) {
+        writePosition = (writePosition + chunkBytes) % bufferBytes;
+        const CaptureRingReader::Region region = ring.GetReadable(writePosition, bufferBytes);
+        const size_t frames1 = region.bytes1 / blockAlign;
+        const size_t frames2 = region.bytes2 / blockAlign;
+        if (staged) {
+            std::memcpy(staging.data(), &device[region.offset], region.bytes1);
+            std::memcpy(staging.data() + region.bytes1, device.data(), region.bytes2);
+            benchmark::DoNotOptimize(converter.Convert(staging.data(), frames1 + frames2));
+        }
+        else {
+            converter.ConvertTo(&device[region.offset], frames1, samples.data());
+            converter.ConvertTo(device.data(), frames2, samples.data() + frames1 * format.channels);
+            benchmark::DoNotOptimize(samples.data());
+        }
+        benchmark::ClobberMemory();
+        ring.Advance(region.GetBytes());
+    }
+    SetCounters(state, chunkBytes / blockAlign, AllocationCounter::GetCount() - allocationsBefore);
+}
+
+// Stall recovery against a simulated live source on a simulated clock: 10 ms
+// packets (48 kHz stereo), and once per simulated second the capture thread
+// stalls for stall_ms (half a second at most), after which the backlog arrives as one burst. Each
+// iteration is one second. Counters: the oldest audio passed on (age of its
+// first frame when it reached the capture thread) and the share skipped.
+// Without the guard (guard = 0) the whole backlog is analyzed late.
+// Args: stall in ms, guard
+void BM_CaptureStallRecovery(benchmark::State& state) {
+    using Clock = CaptureFreshnessGuard::Clock;
+    const auto stall = std::chrono::milliseconds(state.range(0));
+    const bool guarded = state.range(1) != 0;
+    const uint32_t sampleRate = 48000;
+    const size_t channels = 2;
+    const size_t frames = sampleRate / 100;
+    const auto packetDuration = std::chrono::milliseconds(10);
+    const std::vector<float> packet(frames * channels, 0.25f);
+
+    CaptureFreshnessGuard guard(guarded ? CaptureFreshnessGuard::DEFAULT_MAX_AGE : std::chrono::milliseconds(0));
+    Clock::time_point captureTime;
+    double maxAgeMs = 0.0;
+    uint64_t totalFrames = 0;
+
+    for (auto _ : state) {
+        const Clock::time_point stallStart = captureTime + 50 * packetDuration;
+        for (int i = 0; i < 100; ++i) {
+            // Ready one period after capture, or when the stalled thread wakes
+            const Clock::time_point ready = captureTime + packetDuration;
+            const Clock::time_point now = ready > stallStart ? (std::max)(ready, stallStart + stall) : ready;
+            const size_t stale = guard.GetStaleFrames(captureTime, frames, sampleRate, now);
+            if (stale < frames) {
+                const auto keptTime = captureTime + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(static_cast<double>(stale) / sampleRate));
+                maxAgeMs = (std::max)(maxAgeMs, std::chrono::duration<double, std::milli>(now - keptTime).count());
+                benchmark::DoNotOptimize(packet[stale * channels]);
+            }
+            totalFrames += frames;
+            captureTime += packetDuration;
+        }
+    }
+
+    state.counters["max_age_ms"] = maxAgeMs;
+    state.counters["skipped_%"] = totalFrames > 0 ? 100.0 * guard.GetStats().staleFrames / totalFrames : 0.0;
+    state.counters["stalls/s"] = benchmark::Counter(static_cast<double>(guard.GetStats().stalls), benchmark::Counter::kAvgIterations);
+}
+}
+
+BENCHMARK(BM_ProcessAudio)
+    ->ArgNames({ "ch", "frames", "rate" })
+    ->ArgsProduct({ { 1, 2, 6, 8 }, { 64, 256, 1024, 4096 }, { 44100, 48000, 96000, 192000 } });
+
+BENCHMARK(BM_ProcessAudioDecimated)
+    ->ArgNames({ "ch", "frames", "rate" })
+    ->ArgsProduct({ { 2 }, { 256, 1024 }, { 48000, 192000 } });
+
+BENCHMARK(BM_ConvertSamples)
+    ->ArgNames({ "enc", "isa", "frames" })
+    ->ArgsProduct({
+        { static_cast<int64_t>(SampleConverter::Encoding::UInt8), static_cast<int64_t>(SampleConverter::Encoding::Int16),
+          static_cast<int64_t>(SampleConverter::Encoding::Int24), static_cast<int64_t>(SampleConverter::Encoding::Int32),
+          static_cast<int64_t>(SampleConverter::Encoding::Float32), static_cast<int64_t>(SampleConverter::Encoding::Float64) },
+        { static_cast<int64_t>(AudioKernels::InstructionSet::Scalar), static_cast<int64_t>(AudioKernels::InstructionSet::SSE2),
+          static_cast<int64_t>(AudioKernels::InstructionSet::AVX2), static_cast<int64_t>(AudioKernels::InstructionSet::NEON) },
+        { 480, 4096 } });
+
+BENCHMARK(BM_AnalyzeKernel)
+    ->ArgNames({ "ch", "isa", "layout" })
+    ->ArgsProduct({
+        { 1, 2, 6, 8 },
+        { static_cast<int64_t>(AudioKernels::InstructionSet::Scalar), static_cast<int64_t>(AudioKernels::InstructionSet::SSE2),
+          static_cast<int64_t>(AudioKernels::InstructionSet::AVX2), static_cast<int64_t>(AudioKernels::InstructionSet::NEON) },
+        { 0, 1 } });
+
+BENCHMARK(BM_CaptureRingRead)
+    ->ArgNames({ "chunk_ms", "staged" })
+    ->ArgsProduct({ { 3, 10, 30, 500 }, { 0, 1 } });
+
+BENCHMARK(BM_CaptureStallRecovery)
+    ->ArgNames({ "stall_ms", "guard" })
+    ->ArgsProduct({ { 0, 50, 250, 450 }, { 0, 1 } });
@@ -0,0 +1,154 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include "AllocationCounter.h"
+#include "HapticController.h"
+#include "HapticMapper.h"
+
+namespace {
+// Accepts and counts writes; no recording, so only controller cost is measured
+class NullHapticSink : public IHapticSink {
+public:
+    explicit NullHapticSink(size_t deviceCount) : m_deviceCount(deviceCount) {}
+
+    bool Initialize() override { return true; }
+    void Shutdown() override {}
+    size_t FindDevices() override { return m_deviceCount; }
+    size_t GetDeviceCount() const override { return m_deviceCount; }
+    bool Write(size_t, const HapticMapper::MotorLevels&) override { ++m_writes; return true; }
+    std::string GetDeviceId(size_t device) const override { return "null:" + std::to_string(device); }
+    std::string DescribeDevice(size_t) const override { return "Null"; }
+    const char* GetName() const override { return "Null"; }
+
+    uint64_t GetWriteCount() const { return m_writes; }
+
+private:
+    size_t m_deviceCount;
+    std::atomic<uint64_t> m_writes{ 0 };    // Devices are written concurrently
+};
+
+// Every write blocks for a fixed time, like a driver call to a wireless pad
+class SlowHapticSink : public NullHapticSink {
+public:
+    SlowHapticSink(size_t deviceCount, std::chrono::microseconds writeTime)
+        : NullHapticSink(deviceCount), m_writeTime(writeTime) {}
+
+    bool Write(size_t device, const HapticMapper::MotorLevels& levels) override {
+        std::this_thread::sleep_for(m_writeTime);
+        return NullHapticSink::Write(device, levels);
+    }
+
+private:
+    std::chrono::microseconds m_writeTime;
+};
+
+AudioProcessor::AudioFeatures MakeFeatures(float level) {
+    AudioProcessor::AudioFeatures features{};
+    features.volume = level;
+    features.bass = level;
+    features.treble = 1.0f - level;
+    features.midrange = 0.5f;
+    features.peak = level;
+    features.dynamic_range = 0.3f * level;
+    features.left = level;
+    features.right = 1.0f - level;
+    features.volumeTrend.smoothed = features.volume;
+    features.bassTrend.smoothed = features.bass;
+    features.midrangeTrend.smoothed = features.midrange;
+    features.trebleTrend.smoothed = features.treble;
+    return features;
+}
+
+// Silences the haptic mode report from Initialize, so it stays out of the benchmark table
+void InitializeQuietly(HapticController& controller, std::shared_ptr<IHapticSink> sink) {
+    std::streambuf* console = std::cout.rdbuf(nullptr);
+    controller.Initialize(std::move(sink), false);
+    std::cout.rdbuf(console);
+}
+
+// Feature -> motor math alone
+void BM_MapAndSmooth(benchmark::State& state) {
+    HapticMapper mapper;
+    HapticMapper::MotorLevels current;
+    float phase = 0.0f;
+    for (auto _ : state) {
+        const float level = 0.5f + 0.5f * std::sin(phase);
+        phase += 0.1f;
+        current = mapper.Smooth(current, mapper.MapFeatures(MakeFeatures(level)), 0.016f);
+        benchmark::DoNotOptimize(current);
+    }
+}
+
+// One controller output tick (interpolate, map, smooth, filter, write) per
+// iteration, with a new feature block each tick.
+// Args: devices, changing features (1) or a steady signal (0, writes filtered)
+void BM_OutputTick(benchmark::State& state) {
+    const size_t devices = static_cast<size_t>(state.range(0));
+    const bool changing = state.range(1) != 0;
+
+    auto sink = std::make_shared<NullHapticSink>(devices);
+    HapticController controller;
+    HapticController::HapticSettings settings;
+    settings.preferredMode = HapticController::HapticMode::Rumble;
+    settings.maxWritesPerSecond = 0;
+    controller.SetHapticSettings(settings);
+    InitializeQuietly(controller, sink);
+
+    float phase = 0.0f;
+    const uint64_t allocationsBefore = AllocationCounter::GetCount();
+    for (auto _ : state) {
+        const float level = changing ? 0.5f + 0.5f * std::sin(phase) : 0.5f;
+        phase += 0.5f;
+        controller.ProcessAudioFeatures(MakeFeatures(level));
+        controller.RunOutputTick(0.016f);
+    }
+    const uint64_t allocations = AllocationCounter::GetCount() - allocationsBefore;
+
+    state.counters["writes/tick"] = benchmark::Counter(static_cast<double>(sink->GetWriteCount()), benchmark::Counter::kAvgIterations);
+    state.counters["allocs/call"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    controller.Shutdown();
+}
+
+// Output ticks against devices whose writes block for 200 us each. Writes
+// overlap on the controller's pool, so tick time should stay near one write
+// rather than grow with the device count.
+// Args: devices
+void BM_OutputTickBlockingWrites(benchmark::State& state) {
+    const size_t devices = static_cast<size_t>(state.range(0));
+
+    auto sink = std::make_shared<SlowHapticSink>(devices, std::chrono::microseconds(200));
+    HapticController controller;
+    HapticController::HapticSettings settings;
+    settings.preferredMode = HapticController::HapticMode::Rumble;
+    settings.maxWritesPerSecond = 0;
+    settings.fadeTimeMs = 0;
+    controller.SetHapticSettings(settings);
+    InitializeQuietly(controller, sink);
+
+    float phase = 0.0f;
+    for (auto _ : state) {
+        controller.ProcessAudioFeatures(MakeFeatures(0.5f + 0.5f * std::sin(phase)));
+        phase += 0.5f;
+        controller.RunOutputTick(0.016f);
+    }
+
+    state.counters["writes/tick"] = benchmark::Counter(static_cast<double>(sink->GetWriteCount()), benchmark::Counter::kAvgIterations);
+    controller.Shutdown();
+}
+}
+
+BENCHMARK(BM_MapAndSmooth);
+
+BENCHMARK(BM_OutputTick)
+    ->ArgNames({ "devices", "changing" })
+    ->ArgsProduct({ { 1, 4 }, { 0, 1 } });
+
+BENCHMARK(BM_OutputTickBlockingWrites)
+    ->ArgNames({ "devices" })
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
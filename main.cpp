@@ -1,26 +1,78 @@
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <thread>
 #include <chrono>
-#include <conio.h> // For _kbhit() and _getch()
 #include <iomanip>
-#include <mutex>
+#include <memory>
 
 #include "AudioCaptureManager.h"
 #include "AudioProcessor.h"
+#include "ConfigFile.h"
+#include "HapticRenderer.h"
+
+#ifdef _WIN32
+#include <conio.h> // For _kbhit() and _getch()
 #include "HapticController.h"
+#include "LatestValue.h"
+#include "SettingsSnapshot.h"
 
+// Live capture -> gamepad app (needs GameInput, so Windows only)
 class AudioHapticsApp {
 public:
     AudioHapticsApp() = default;
     ~AudioHapticsApp() = default;
 
+    // Play a WAV file (looped, in real time) instead of capturing live audio
+    void SetInputFile(const std::string& path) { m_inputFile = path; }
+
+    // Analyze the spectrum at a decimated rate (~2-4 kHz)
+    void SetDecimatedAnalysis(bool enabled) { m_decimatedAnalysis = enabled; }
+
+    // Device period for live capture (3/10/20 ms)
+    void SetCaptureLatency(AudioCaptureManager::CaptureLatency latency) { m_audioCapture.SetCaptureLatency(latency); }
+
+    // File input only: analyze ahead of playback and schedule the haptics to
+    // land with the audio on a device with this much output latency
+    void SetLookAhead(uint32_t deviceLatencyMs) { m_lookAhead = true; m_deviceLatencyMs = deviceLatencyMs; }
+
+    // Tuning from a loaded config file, re-applied whenever the file changes
+    void SetConfigFile(std::unique_ptr<ConfigFile> config) { m_config = std::move(config); }
+
     bool Initialize() {
         std::cout << "=== Audio to Haptics Converter ===" << std::endl;
         std::cout << "Initializing components..." << std::endl;
 
-            // Initialize audio capture with AUTO method (tries multiple approaches)
-    if (!m_audioCapture.Initialize(AudioCaptureManager::CaptureMethod::AUTO)) {
+        if (m_config) {
+            ApplyConfig();
+        }
+
+            // Initialize audio capture with AUTO method (tries multiple approaches),
+            // or play the requested file
+    AudioCaptureManager::CaptureMethod method = AudioCaptureManager::CaptureMethod::AUTO;
+    if (!m_inputFile.empty()) {
+        m_audioCapture.SetInputFile(m_inputFile);
+        method = AudioCaptureManager::CaptureMethod::FILE_INPUT;
+
+        if (m_lookAhead) {
+            // The file is read ahead by everything the controller looks
+            // ahead (the longest ramp of the global settings and any
+            // profile), plus headroom for capture and analysis
+            HapticController::HapticSettings settings = m_hapticController.GetHapticSettings();
+            settings.deviceLatencyMs = m_deviceLatencyMs;
+            m_hapticController.SetHapticSettings(settings);
+            m_hapticController.SetLookAhead(true);
+            uint32_t rampMs = (std::max)(settings.fadeTimeMs, settings.riseTimeMs);
+            if (m_config) {
+                for (const auto& profile : m_config->Get().profiles) {
+                    rampMs = (std::max)({ rampMs, profile.second.fadeTimeMs, profile.second.riseTimeMs });
+                }
+            }
+            m_audioCapture.SetInputLookAhead(std::chrono::milliseconds(m_deviceLatencyMs + rampMs + LOOKAHEAD_HEADROOM_MS));
+        }
+    }
+    if (!m_audioCapture.Initialize(method)) {
         std::cerr << "Failed to initialize audio capture" << std::endl;
         return false;
     }
@@ -28,18 +80,23 @@ public:
     std::cout << "Using audio capture method: " << m_audioCapture.GetMethodName() << std::endl;
 
         // Initialize haptic controller
+        m_hapticController.SetLatencyTracker(&m_latency);
         if (!m_hapticController.Initialize()) {
             std::cerr << "Failed to initialize haptic controller" << std::endl;
             return false;
         }
 
-        // Set up audio processor
+        // Set up audio processor (sensitivity defaults to ultra, 4x); later
+        // changes reach it through m_audioSnapshot
         m_audioProcessor.SetSampleRate(m_audioCapture.GetSampleRate());
-        m_audioProcessor.SetSensitivity(4.0f); // Start with ultra sensitivity (4x)
+        m_audioProcessor.SetChannelMask(m_audioCapture.GetChannelMask());
+        m_audioProcessor.SetDecimatedAnalysis(m_decimatedAnalysis);
+        ApplyAudioSettings(m_audioSettings);
 
         // Set up audio callback
-        m_audioCapture.SetAudioCallback([this](const float* samples, size_t sampleCount, size_t channels) {
-            this->OnAudioData(samples, sampleCount, channels);
+        m_audioCapture.SetAudioCallback([this](const float* samples, size_t sampleCount, size_t channels,
+                                               const BlockTimestamps& timestamps) {
+            this->OnAudioData(samples, sampleCount, channels, timestamps);
         });
 
         std::cout << "Initialization complete!" << std::endl;
@@ -53,8 +110,11 @@ public:
         }
 
         std::cout << "\n=== Audio-to-Haptics Active ===" << std::endl;
-        std::cout << m_hapticController.GetDeviceStatusString() << std::endl;
+        PrintDevices();
         std::cout << "Haptic mode: " << m_hapticController.GetHapticModeString() << std::endl;
+        if (m_config) {
+            std::cout << "Config: " << m_config->GetPath() << " (applied when saved)" << std::endl;
+        }
         std::cout << "\nControls:" << std::endl;
         std::cout << "  [Q] Quit" << std::endl;
         std::cout << "  [S] Adjust sensitivity" << std::endl;
@@ -62,6 +122,7 @@ public:
         std::cout << "  [M] Haptic mode (GameInput 1.0/2.0)" << std::endl;
         std::cout << "  [T] Test haptics" << std::endl;
         std::cout << "  [R] Refresh devices" << std::endl;
+        std::cout << "  [L] Latency report" << std::endl;
         std::cout << "\nListening for audio... (Press any key for controls)\n" << std::endl;
 
         bool running = true;
@@ -70,6 +131,7 @@ public:
         while (running) {
             // Update devices periodically
             m_hapticController.UpdateDevices();
+            PollConfig();
 
             // Display live audio stats
             auto now = std::chrono::steady_clock::now();
@@ -108,6 +170,7 @@ public:
             while (m_running) {
                 // Update devices periodically
                 m_hapticController.UpdateDevices();
+                PollConfig();
                 
                 // Sleep to prevent high CPU usage
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -129,26 +192,71 @@ public:
     }
 
 private:
-    void OnAudioData(const float* samples, size_t sampleCount, size_t channels) {
+    // Pushes the config file's settings to the controller and the audio thread
+    void ApplyConfig() {
+        const ConfigFile::Config& config = m_config->Get();
+        HapticController::HapticSettings settings = config.haptics;
+        std::map<std::string, HapticController::HapticSettings> profiles = config.profiles;
+        if (m_lookAhead) {
+            // --lookahead wins, for every pad
+            settings.deviceLatencyMs = m_deviceLatencyMs;
+            for (auto& profile : profiles) {
+                profile.second.deviceLatencyMs = m_deviceLatencyMs;
+            }
+        }
+        m_hapticController.SetHapticSettings(settings);
+        m_hapticController.SetDeviceProfiles(profiles);
+
+        m_audioSettings = config.audio;
+        m_audioSnapshot.Publish(m_audioSettings);
+    }
+
+    void PollConfig() {
+        auto now = std::chrono::steady_clock::now();
+        if (!m_config || now - m_lastConfigCheck < CONFIG_POLL_INTERVAL) {
+            return;
+        }
+        m_lastConfigCheck = now;
+        if (m_config->ReloadIfChanged()) {
+            ApplyConfig();
+            std::cout << "\nConfig reloaded from " << m_config->GetPath() << std::endl;
+        }
+    }
+
+    // Audio thread (or before capture starts). A cutoff change reconfigures
+    // the analyzer, which allocates; everything else is a plain copy.
+    void ApplyAudioSettings(const ConfigFile::AudioSettings& settings) {
+        m_audioProcessor.SetSensitivity(settings.sensitivity);
+        const SpectralAnalyzer::Settings& spectral = m_audioProcessor.GetSpectralSettings();
+        if (settings.bassCutoff != spectral.bassCutoff || settings.trebleCutoff != spectral.trebleCutoff) {
+            m_audioProcessor.SetFrequencyBands(settings.bassCutoff, settings.trebleCutoff);
+        }
+        m_audioProcessor.SetOnsetSettings(settings.onsets);
+        m_audioProcessor.SetAutoGainSettings(settings.gain);
+    }
+
+    void OnAudioData(const float* samples, size_t sampleCount, size_t channels, const BlockTimestamps& capturedTimestamps) {
+        // Adopt settings changed since the last block; never waits on the UI
+        if (m_audioSnapshot.Update()) {
+            ApplyAudioSettings(m_audioSnapshot.Get());
+        }
+
         // Process audio to extract features
         auto features = m_audioProcessor.ProcessAudio(samples, sampleCount, channels);
+
+        BlockTimestamps timestamps = capturedTimestamps;
+        timestamps.analyzed = BlockTimestamps::Clock::now();
+        m_latency.RecordBlock(timestamps);
         
-        // Store latest features for display
-        {
-            std::lock_guard<std::mutex> lock(m_featuresMutex);
-            m_latestFeatures = features;
-        }
+        // Store latest features for display (never waits on the UI thread)
+        m_latestFeatures.Publish(features);
 
         // Send to haptic controller
-        m_hapticController.ProcessAudioFeatures(features);
+        m_hapticController.ProcessAudioFeatures(features, timestamps);
     }
 
     void DisplayLiveStats() {
-        AudioProcessor::AudioFeatures features;
-        {
-            std::lock_guard<std::mutex> lock(m_featuresMutex);
-            features = m_latestFeatures;
-        }
+        const AudioProcessor::AudioFeatures features = m_latestFeatures.Read();
 
         // Move cursor to beginning of stats area (assuming we're at the bottom)
         std::cout << "\r";
@@ -167,7 +275,14 @@ private:
         std::cout << std::fixed << std::setprecision(2);
         std::cout << "Volume: " << makeBar(features.volume) << " " << features.volume << "  ";
         std::cout << "Bass: " << makeBar(features.bass, 10) << " " << features.bass << "  ";
-        std::cout << "Treble: " << makeBar(features.treble, 10) << " " << features.treble;
+        std::cout << "Treble: " << makeBar(features.treble, 10) << " " << features.treble << "  ";
+        std::cout << "Bal: " << std::showpos << features.balance << std::noshowpos << "  ";
+        std::cout << "Drops: " << m_audioCapture.GetPipelineStats().overflows << "  ";
+        std::cout << "Stalls: " << m_audioCapture.GetFreshnessStats().stalls << "  ";
+        const auto writes = m_hapticController.GetWriteStats();
+        std::cout << "Writes: " << writes.issued << "/" << (writes.issued + writes.suppressed) << "  ";
+        const auto latency = m_latency.GetSummary(LatencyTracker::Stage::EndToEnd);
+        std::cout << "Lat p50/p99: " << std::setprecision(1) << latency.p50Ms << "/" << latency.p99Ms << " ms";
         std::cout << std::flush;
     }
 
@@ -198,6 +313,10 @@ private:
                 RefreshDevices();
                 break;
 
+            case 'l':
+                ShowLatencyReport();
+                break;
+
             default:
                 break;
         }
@@ -230,7 +349,8 @@ private:
                 return;
         }
 
-        m_audioProcessor.SetSensitivity(sensitivity);
+        m_audioSettings.sensitivity = sensitivity;
+        m_audioSnapshot.Publish(m_audioSettings);
         std::cout << "\nSensitivity set to " << sensitivity << "x" << std::endl;
         std::cout << "Press any key to continue..." << std::endl;
         _getch();
@@ -245,8 +365,12 @@ private:
         std::cout << "2. Treble intensity: " << settings.trebleIntensity << std::endl;
         std::cout << "3. Volume intensity: " << settings.volumeIntensity << std::endl;
         std::cout << "4. Dynamic intensity: " << settings.dynamicIntensity << std::endl;
-        std::cout << "5. Reset to defaults" << std::endl;
-        std::cout << "Select (1-5) or press any other key to return: ";
+        std::cout << "5. LFE intensity: " << settings.lfeIntensity << std::endl;
+        std::cout << "6. Spatial mapping: " << (settings.useSpatialMapping ? "on" : "off") << std::endl;
+        std::cout << "7. Write threshold: " << settings.writeThreshold << std::endl;
+        std::cout << "8. Max writes per second: " << settings.maxWritesPerSecond << std::endl;
+        std::cout << "9. Reset to defaults" << std::endl;
+        std::cout << "Select (1-9) or press any other key to return: ";
 
         char choice = _getch();
         
@@ -272,6 +396,25 @@ private:
                 settings.dynamicIntensity = std::clamp(settings.dynamicIntensity, 0.0f, 2.0f);
                 break;
             case '5':
+                std::cout << "\nLFE intensity (0.0-2.0): ";
+                std::cin >> settings.lfeIntensity;
+                settings.lfeIntensity = std::clamp(settings.lfeIntensity, 0.0f, 2.0f);
+                break;
+            case '6':
+                settings.useSpatialMapping = !settings.useSpatialMapping;
+                std::cout << "\nSpatial mapping " << (settings.useSpatialMapping ? "enabled" : "disabled") << "." << std::endl;
+                break;
+            case '7':
+                std::cout << "\nWrite threshold (0.0-0.1): ";
+                std::cin >> settings.writeThreshold;
+                settings.writeThreshold = std::clamp(settings.writeThreshold, 0.0f, 0.1f);
+                break;
+            case '8':
+                std::cout << "\nMax writes per second (0 = unlimited): ";
+                std::cin >> settings.maxWritesPerSecond;
+                settings.maxWritesPerSecond = (std::min)(settings.maxWritesPerSecond, 1000u);
+                break;
+            case '9':
                 settings = HapticController::HapticSettings{}; // Reset to defaults
                 std::cout << "\nSettings reset to defaults." << std::endl;
                 break;
@@ -349,89 +492,254 @@ private:
                 return;
         }
 
+        // Applies on the next output tick; the devices stay open
         m_hapticController.SetHapticSettings(settings);
-        std::cout << "\nHaptic mode updated. Reinitializing..." << std::endl;
-        
-        // Reinitialize to apply new mode
-        m_hapticController.Shutdown();
-        if (m_hapticController.Initialize()) {
-            std::cout << "New mode: " << m_hapticController.GetHapticModeString() << std::endl;
-        } else {
-            std::cout << "Failed to reinitialize with new mode!" << std::endl;
-        }
+        std::cout << "\nNew mode: " << m_hapticController.GetHapticModeString() << std::endl;
         
         std::cout << "Press any key to continue..." << std::endl;
         _getch();
         std::cout << "\n";
     }
 
+    void ShowLatencyReport() {
+        std::cout << "\n\nLatency (ms):" << std::endl;
+        std::cout << std::left << std::setw(12) << "Stage" << std::right
+                  << std::setw(10) << "count" << std::setw(9) << "p50" << std::setw(9) << "p99"
+                  << std::setw(9) << "p99.9" << std::setw(9) << "max" << std::endl;
+        std::cout << std::fixed << std::setprecision(2);
+        for (int i = 0; i < static_cast<int>(LatencyTracker::Stage::Count); ++i) {
+            const auto stage = static_cast<LatencyTracker::Stage>(i);
+            const auto summary = m_latency.GetSummary(stage);
+            std::cout << std::left << std::setw(12) << LatencyTracker::GetStageName(stage) << std::right
+                      << std::setw(10) << summary.count << std::setw(9) << summary.p50Ms << std::setw(9) << summary.p99Ms
+                      << std::setw(9) << summary.p999Ms << std::setw(9) << summary.maxMs << std::endl;
+        }
+        const auto freshness = m_audioCapture.GetFreshnessStats();
+        std::cout << "Capture stalls: " << freshness.stalls << " (" << std::setprecision(1)
+                  << freshness.staleFrames * 1000.0 / (std::max)(m_audioCapture.GetSampleRate(), 1u)
+                  << " ms of stale audio skipped)" << std::endl;
+        std::cout << "Press any key to continue (R to reset)..." << std::endl;
+        if (std::tolower(_getch()) == 'r') {
+            m_latency.Reset();
+        }
+        std::cout << "\n";
+    }
+
     void RefreshDevices() {
         std::cout << "\n\nRefreshing devices..." << std::endl;
         m_hapticController.FindGamepads();
-        std::cout << m_hapticController.GetDeviceStatusString() << std::endl;
+        PrintDevices();
         std::cout << "Haptic mode: " << m_hapticController.GetHapticModeString() << std::endl;
         std::cout << "Press any key to continue..." << std::endl;
         _getch();
         std::cout << "\n";
     }
 
+    // Device ids are what [device <id>] config sections match
+    void PrintDevices() {
+        std::cout << m_hapticController.GetDeviceStatusString() << std::endl;
+        for (size_t i = 0; i < m_hapticController.GetGamepadCount(); ++i) {
+            std::cout << "  " << m_hapticController.GetDeviceId(i) << std::endl;
+        }
+    }
+
     AudioCaptureManager m_audioCapture;
     AudioProcessor m_audioProcessor;
+    LatencyTracker m_latency;       // Outlives the controller's output thread (declared first)
     HapticController m_hapticController;
     
-    std::mutex m_featuresMutex;
-    AudioProcessor::AudioFeatures m_latestFeatures{};
-    bool m_running = false;
+    LatestValue<AudioProcessor::AudioFeatures> m_latestFeatures;
+    std::atomic<bool> m_running{ false };     // Shutdown may come from another thread
+
+    std::string m_inputFile;
+    bool m_decimatedAnalysis = false;
+    bool m_lookAhead = false;
+    uint32_t m_deviceLatencyMs = 0;
+    static constexpr uint32_t LOOKAHEAD_HEADROOM_MS = 100;
+
+    // Audio settings as last set from the UI thread, and their hand-off to the audio thread
+    ConfigFile::AudioSettings m_audioSettings;
+    SettingsSnapshot<ConfigFile::AudioSettings> m_audioSnapshot;
+
+    std::unique_ptr<ConfigFile> m_config;
+    std::chrono::steady_clock::time_point m_lastConfigCheck;
+    static constexpr auto CONFIG_POLL_INTERVAL = std::chrono::milliseconds(500);
 };
 
+#endif
+
+// Offline render: WAV in, haptic timeline out. Portable; needs no audio or input devices.
+static int RenderTimeline(const std::string& inputPath, const std::string& outputPath, bool burstEmulation, bool decimatedAnalysis,
+                          bool lookAhead, uint32_t deviceLatencyMs, const ConfigFile* config) {
+    HapticRenderer renderer;
+    renderer.SetBurstEmulation(burstEmulation);
+    renderer.SetDecimatedAnalysis(decimatedAnalysis);
+
+    HapticMapper::HapticSettings settings;
+    if (config) {
+        const ConfigFile::AudioSettings& audio = config->Get().audio;
+        settings = config->Get().haptics;
+        renderer.SetSensitivity(audio.sensitivity);
+        renderer.SetFrequencyBands(audio.bassCutoff, audio.trebleCutoff);
+        renderer.SetOnsetSettings(audio.onsets);
+        renderer.SetAutoGainSettings(audio.gain);
+    }
+    if (lookAhead) {
+        settings.deviceLatencyMs = deviceLatencyMs;
+        renderer.SetLookAhead(true);
+    }
+    renderer.SetHapticSettings(settings);
+
+    if (!renderer.Render(inputPath, outputPath)) {
+        std::cerr << "Render failed" << std::endl;
+        return -1;
+    }
+
+    const HapticRenderer::Result& result = renderer.GetResult();
+    std::cout << std::fixed << std::setprecision(2)
+              << "Rendered " << result.tickCount << " ticks (" << result.audioSeconds << " s of audio) in "
+              << result.renderSeconds << " s";
+    if (result.renderSeconds > 0.0) {
+        std::cout << " - " << std::setprecision(0) << (result.audioSeconds / result.renderSeconds) << "x real time";
+    }
+    std::cout << std::endl << "Timeline written to " << outputPath << std::endl;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     try {
         // Check for command-line arguments
-        if (argc > 1) {
-            std::string arg = argv[1];
+        bool runAsService = false;
+        bool burstEmulation = false;
+        bool decimatedAnalysis = false;
+        bool lookAhead = false;
+        uint32_t deviceLatencyMs = 0;
+        AudioCaptureManager::CaptureLatency captureLatency = AudioCaptureManager::CaptureLatency::BALANCED;
+        std::string inputFile;
+        std::string configPath;
+        std::string renderInput;
+        std::string renderOutput;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
             if (arg == "--console") {
-                // Run as console application
-                AudioHapticsApp app;
-                if (!app.Initialize()) {
-                    std::cerr << "Failed to initialize application" << std::endl;
-                    return -1;
-                }
-                app.Run();
-                return 0;
+                runAsService = false;
             }
             else if (arg == "--service") {
-                // Run as service (non-blocking)
-                AudioHapticsApp app;
-                if (!app.Initialize()) {
-                    std::cerr << "Failed to initialize service" << std::endl;
+                runAsService = true;
+            }
+            else if (arg == "--file" && i + 1 < argc) {
+                inputFile = argv[++i];
+            }
+            else if (arg == "--config" && i + 1 < argc) {
+                configPath = argv[++i];
+            }
+            else if (arg == "--render" && i + 2 < argc) {
+                renderInput = argv[++i];
+                renderOutput = argv[++i];
+            }
+            else if (arg == "--emulate") {
+                burstEmulation = true;
+            }
+            else if (arg == "--decimate") {
+                decimatedAnalysis = true;
+            }
+            else if (arg == "--lookahead" && i + 1 < argc) {
+                lookAhead = true;
+                deviceLatencyMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--latency" && i + 1 < argc) {
+                const std::string tier = argv[++i];
+                if (tier == "low") {
+                    captureLatency = AudioCaptureManager::CaptureLatency::LOW;
+                } else if (tier == "balanced") {
+                    captureLatency = AudioCaptureManager::CaptureLatency::BALANCED;
+                } else if (tier == "safe") {
+                    captureLatency = AudioCaptureManager::CaptureLatency::SAFE;
+                } else {
+                    std::cerr << "Unknown latency: " << tier << " (low, balanced or safe)" << std::endl;
                     return -1;
                 }
-                app.RunService();
-                return 0;
             }
             else if (arg == "--help") {
                 std::cout << "Audio-to-Haptics Usage:" << std::endl;
-                std::cout << "  --console    Run as console application (default)" << std::endl;
-                std::cout << "  --service    Run as background service" << std::endl;
-                std::cout << "  --help       Show this help message" << std::endl;
+                std::cout << "  --console      Run as console application (default)" << std::endl;
+                std::cout << "  --service      Run as background service" << std::endl;
+                std::cout << "  --file <wav>   Use a WAV file as the audio source instead of live capture" << std::endl;
+                std::cout << "  --config <ini> Load settings from <ini> (written with the defaults if missing)" << std::endl;
+                std::cout << "                 and re-apply them whenever the file is saved" << std::endl;
+                std::cout << "  --render <wav> <out.haptics>" << std::endl;
+                std::cout << "                 Render a haptic timeline offline, as fast as possible" << std::endl;
+                std::cout << "  --emulate      With --render: apply haptic emulation bursts" << std::endl;
+                std::cout << "  --decimate     Run spectral analysis at a decimated rate (~2-4 kHz)" << std::endl;
+                std::cout << "  --lookahead <ms>" << std::endl;
+                std::cout << "                 With --file or --render: schedule haptics ahead so they land with" << std::endl;
+                std::cout << "                 the audio on a device with <ms> output latency" << std::endl;
+                std::cout << "  --latency <low|balanced|safe>" << std::endl;
+                std::cout << "                 Live capture period: 3, 10 (default) or 20 ms" << std::endl;
+                std::cout << "  --help         Show this help message" << std::endl;
                 return 0;
             }
+            else {
+                std::cerr << "Unknown argument: " << arg << " (see --help)" << std::endl;
+                return -1;
+            }
+        }
+
+        std::unique_ptr<ConfigFile> config;
+        if (!configPath.empty()) {
+            config = std::make_unique<ConfigFile>(configPath);
+            if (!config->Exists() && ConfigFile::Save(configPath, ConfigFile::Config{})) {
+                std::cout << "Wrote default settings to " << configPath << std::endl;
+            }
+            if (!config->Load()) {
+                return -1;
+            }
+        }
+
+        if (!renderInput.empty()) {
+            return RenderTimeline(renderInput, renderOutput, burstEmulation, decimatedAnalysis, lookAhead, deviceLatencyMs,
+                                  config.get());
         }
 
-        // Default: run as console application
+#ifdef _WIN32
         AudioHapticsApp app;
-        
+        app.SetInputFile(inputFile);
+        app.SetDecimatedAnalysis(decimatedAnalysis);
+        app.SetCaptureLatency(captureLatency);
+        if (config) {
+            app.SetConfigFile(std::move(config));
+        }
+        if (lookAhead) {
+            app.SetLookAhead(deviceLatencyMs);
+        }
+
         if (!app.Initialize()) {
-            std::cerr << "Failed to initialize application" << std::endl;
+            std::cerr << (runAsService ? "Failed to initialize service" : "Failed to initialize application") << std::endl;
             return -1;
         }
-        
-        app.Run();
-        
+
+        if (runAsService) {
+            // Run as service (non-blocking)
+            app.RunService();
+        }
+        else {
+            app.Run();
+        }
+#else
+        (void)runAsService;
+        (void)inputFile;
+        (void)decimatedAnalysis;
+        (void)captureLatency;
+        (void)config;
+        std::cerr << "Live capture and gamepad output require Windows; only --render is available on this platform" << std::endl;
+        return -1;
+#endif
+
     } catch (const std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         return -1;
     }
 
     return 0;
-}
\ No newline at end of file
+}
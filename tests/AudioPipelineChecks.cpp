@@ -0,0 +1,347 @@
+// Checks AudioFrameRing and AudioPipeline: packets spanning several slots
+// across many wraps of the ring, the overflow count while the consumer is
+// held up, Stop delivering what is already queued, lossless PushWait from a
+// file source (sample-exact output), and which capture gaps count as
+// underruns. Exits non-zero on the first mismatch.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioCaptureManager.h"
+#include "AudioFrameRing.h"
+#include "AudioPipeline.h"
+
+namespace {
+
+using Clock = BlockTimestamps::Clock;
+
+const size_t CHANNELS = 2;
+
+bool Fail(const std::string& message) {
+    std::cerr << "AudioPipeline: " << message << std::endl;
+    return false;
+}
+
+// Stereo packet whose samples count up from first, so any loss, repeat or
+// reorder shows in the output
+std::vector<float> MakePacket(size_t frames, float first) {
+    std::vector<float> packet(frames * CHANNELS);
+    for (size_t i = 0; i < packet.size(); ++i) {
+        packet[i] = first + static_cast<float>(i);
+    }
+    return packet;
+}
+
+// Random pushes and pops against a model of the ring: 8 slots of 32 stereo
+// frames, packets of up to 3 slots (and a few that can never fit)
+bool CheckRingWrap() {
+    AudioFrameRing ring(8, 64);
+    const size_t framesPerSlot = 64 / CHANNELS;
+
+    struct Slot {
+        size_t sampleCount;
+        float first;
+        bool packetEnd;
+        Clock::time_point capture;
+    };
+    std::deque<Slot> model;
+    uint64_t overflows = 0;
+    float next = 0.0f;
+    uint64_t packets = 0;
+    size_t popped = 0;
+
+    std::mt19937 rng(1234);
+    for (int step = 0; step < 20000; ++step) {
+        if (rng() % 2 == 0) {
+            const size_t frames = rng() % 50 == 0 ? 9 * framesPerSlot : 1 + rng() % (3 * framesPerSlot);
+            const size_t slots = (frames + framesPerSlot - 1) / framesPerSlot;
+            const std::vector<float> packet = MakePacket(frames, next);
+            BlockTimestamps timestamps;
+            timestamps.capture = Clock::time_point(std::chrono::milliseconds(++packets));
+
+            const bool fits = slots <= ring.GetSlotCount() - model.size();
+            if (ring.CanPush(packet.size(), CHANNELS) != (fits || slots > ring.GetSlotCount())) {
+                return Fail("CanPush disagrees with the free space");
+            }
+            if (ring.Push(packet.data(), packet.size(), CHANNELS, timestamps) != fits) {
+                return Fail(std::string("a ") + std::to_string(slots) + "-slot packet was " + (fits ? "refused" : "accepted") +
+                            " with " + std::to_string(ring.GetSlotCount() - model.size()) + " slots free");
+            }
+            if (!fits) {
+                ++overflows;
+                continue;
+            }
+            for (size_t i = 0; i < slots; ++i) {
+                const size_t slotFrames = (std::min)(framesPerSlot, frames - i * framesPerSlot);
+                model.push_back({ slotFrames * CHANNELS, next, i + 1 == slots, timestamps.capture });
+                next += static_cast<float>(slotFrames * CHANNELS);
+            }
+        } else {
+            AudioFrameRing::Block block;
+            if (ring.Front(block) != !model.empty()) {
+                return Fail("Front disagrees with the queued slot count");
+            }
+            if (model.empty()) {
+                continue;
+            }
+            const Slot& expected = model.front();
+            if (block.sampleCount != expected.sampleCount || block.channels != CHANNELS ||
+                block.packetEnd != expected.packetEnd || block.timestamps.capture != expected.capture) {
+                return Fail("slot " + std::to_string(popped) + " has the wrong size, flags or timestamps");
+            }
+            for (size_t i = 0; i < block.sampleCount; ++i) {
+                if (block.samples[i] != expected.first + static_cast<float>(i)) {
+                    return Fail("slot " + std::to_string(popped) + " has the wrong samples");
+                }
+            }
+            ring.Pop();
+            model.pop_front();
+            ++popped;
+        }
+        if (ring.GetDepth() != model.size() || ring.GetOverflowCount() != overflows) {
+            return Fail("depth or overflow count off the model at step " + std::to_string(step));
+        }
+    }
+    if (popped < 20 * ring.GetSlotCount() || overflows == 0) {
+        return Fail("the random run did not wrap the ring or fill it");
+    }
+    return true;
+}
+
+// Pipeline whose callback records every sample and, while held, blocks in
+// its first call (so the ring fills behind it)
+struct HeldPipeline {
+    std::atomic<bool> held{ true };
+    std::atomic<bool> entered{ false };
+    std::atomic<uint64_t> calls{ 0 };
+    std::chrono::microseconds callbackTime{ 0 };
+    std::vector<float> received;    // Consumer thread until Stop
+    AudioPipeline pipeline;         // Last, so its consumer stops before the state above goes
+
+    HeldPipeline(size_t slotCount, size_t samplesPerSlot) : pipeline(slotCount, samplesPerSlot) {
+        pipeline.SetCallback([this](const float* samples, size_t sampleCount, size_t, const BlockTimestamps&) {
+            entered = true;
+            while (held) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            std::this_thread::sleep_for(callbackTime);
+            received.insert(received.end(), samples, samples + sampleCount);
+            calls.fetch_add(1);
+        });
+        pipeline.Start();
+    }
+
+    bool WaitUntilEntered() {
+        for (int i = 0; i < 5000 && !entered; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return entered;
+    }
+
+    // Releases the callback and waits for the consumer to deliver processed packets
+    bool Drain(uint64_t processed) {
+        held = false;
+        for (int i = 0; i < 5000 && pipeline.GetStats().blocksProcessed < processed; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return pipeline.GetStats().blocksProcessed == processed;
+    }
+};
+
+bool CheckOverflow() {
+    HeldPipeline held(8, 64);
+    const std::vector<float> packet = MakePacket(32, 0.0f);
+    const std::vector<float> twoSlots = MakePacket(48, 0.0f);
+    held.pipeline.Push(packet.data(), packet.size(), CHANNELS, Clock::now());
+    if (!held.WaitUntilEntered()) {
+        return Fail("the callback never ran");
+    }
+
+    // The held slot stays in the ring until its callback returns, so 7 more fit
+    size_t accepted = 1;
+    for (int i = 0; i < 20; ++i) {
+        accepted += held.pipeline.Push(packet.data(), packet.size(), CHANNELS, Clock::now()) ? 1 : 0;
+    }
+    accepted += held.pipeline.Push(twoSlots.data(), twoSlots.size(), CHANNELS, Clock::now()) ? 1 : 0;
+
+    AudioPipeline::Stats stats = held.pipeline.GetStats();
+    if (accepted != 8 || stats.blocksQueued != 8 || stats.overflows != 14 || stats.maxDepth != 8) {
+        return Fail("held consumer: " + std::to_string(stats.blocksQueued) + " queued, " + std::to_string(stats.overflows) +
+                    " overflows, depth " + std::to_string(stats.maxDepth) + "; expected 8, 14, 8");
+    }
+
+    // Once it catches up, packets fit again
+    if (!held.Drain(8) || !held.pipeline.Push(twoSlots.data(), twoSlots.size(), CHANNELS, Clock::now())) {
+        return Fail("the ring did not take packets again after the consumer caught up");
+    }
+    held.pipeline.Stop();
+    stats = held.pipeline.GetStats();
+    if (stats.blocksQueued != 9 || stats.blocksProcessed != 9 || held.calls != 10) {
+        return Fail("a two-slot packet was not counted once in and once out");
+    }
+    return true;
+}
+
+bool CheckStopDrains() {
+    HeldPipeline held(64, 64);
+    held.held = false;
+    held.callbackTime = std::chrono::microseconds(500);
+
+    // 40 packets of one or two slots, queued far faster than they are
+    // processed, then Stop right away
+    std::vector<float> expected;
+    for (int i = 0; i < 40; ++i) {
+        const std::vector<float> packet = MakePacket(i % 2 ? 48 : 20, static_cast<float>(expected.size()));
+        if (!held.pipeline.Push(packet.data(), packet.size(), CHANNELS, Clock::now())) {
+            return Fail("a packet did not fit an empty ring");
+        }
+        expected.insert(expected.end(), packet.begin(), packet.end());
+    }
+    held.pipeline.Stop();
+
+    const AudioPipeline::Stats stats = held.pipeline.GetStats();
+    if (stats.blocksProcessed != 40 || held.received != expected) {
+        return Fail("Stop delivered " + std::to_string(stats.blocksProcessed) + " of 40 queued packets");
+    }
+    return true;
+}
+
+// 16-bit stereo PCM whose samples walk through every code, so the decoded
+// output is known exactly: code / 32768
+bool WriteTestWav(const std::filesystem::path& path, uint32_t frames) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    auto u32 = [&](uint32_t value) { out.write(reinterpret_cast<const char*>(&value), 4); };
+    auto u16 = [&](uint16_t value) { out.write(reinterpret_cast<const char*>(&value), 2); };
+    const uint32_t dataBytes = frames * CHANNELS * 2;
+    out.write("RIFF", 4);
+    u32(36 + dataBytes);
+    out.write("WAVEfmt ", 8);
+    u32(16);
+    u16(1);             // PCM
+    u16(CHANNELS);
+    u32(48000);
+    u32(48000 * CHANNELS * 2);
+    u16(CHANNELS * 2);
+    u16(16);
+    out.write("data", 4);
+    u32(dataBytes);
+    for (uint32_t i = 0; i < frames * CHANNELS; ++i) {
+        u16(static_cast<uint16_t>(i * 7));
+    }
+    return static_cast<bool>(out);
+}
+
+bool CheckFileLossless() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "audiohaptics_pipeline_check.wav";
+    const uint32_t frames = 100003;     // Not a whole number of chunks
+    if (!WriteTestWav(path, frames)) {
+        return Fail("could not write the test file");
+    }
+
+    // Far slower than the file is read, so PushWait waits on a full ring
+    std::vector<float> received;
+    AudioCaptureManager capture;
+    std::streambuf* console = std::cout.rdbuf(nullptr);
+    capture.SetInputFile(path.string(), false);
+    bool ok = capture.Initialize(AudioCaptureManager::CaptureMethod::FILE_INPUT);
+    capture.SetAudioCallback([&](const float* samples, size_t sampleCount, size_t, const BlockTimestamps&) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        received.insert(received.end(), samples, samples + sampleCount);
+    });
+    ok = ok && capture.StartCapture();
+    for (int i = 0; ok && i < 10000 && !capture.IsInputFinished(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    capture.StopCapture();
+    std::cout.rdbuf(console);
+    std::error_code error;
+    std::filesystem::remove(path, error);
+
+    if (!ok) {
+        return Fail("file playback did not start");
+    }
+    const AudioPipeline::Stats stats = capture.GetPipelineStats();
+    if (stats.overflows != 0 || stats.blocksQueued != stats.blocksProcessed || stats.maxDepth < 2) {
+        return Fail("file playback dropped packets or never filled the ring");
+    }
+    if (received.size() != static_cast<size_t>(frames) * CHANNELS) {
+        return Fail("file playback delivered " + std::to_string(received.size()) + " of " +
+                    std::to_string(static_cast<size_t>(frames) * CHANNELS) + " samples");
+    }
+    for (uint32_t i = 0; i < received.size(); ++i) {
+        const float expected = static_cast<float>(static_cast<int16_t>(static_cast<uint16_t>(i * 7))) / 32768.0f;
+        if (received[i] != expected) {
+            return Fail("file playback sample " + std::to_string(i) + " differs from the file");
+        }
+    }
+    return true;
+}
+
+bool CheckUnderruns() {
+    const auto period = std::chrono::milliseconds(10);
+    const std::vector<float> packet = MakePacket(32, 0.0f);
+
+    // Queued behind a held consumer, packets are judged by their capture
+    // times alone: steady ones and a long pause are fine, two lost ones are
+    // an underrun
+    {
+        HeldPipeline held(64, 64);
+        Clock::time_point capture = Clock::now();
+        auto push = [&](int count) {
+            for (int i = 0; i < count; ++i) {
+                held.pipeline.Push(packet.data(), packet.size(), CHANNELS, capture);
+                capture += period;
+            }
+        };
+        push(1);
+        if (!held.WaitUntilEntered()) {
+            return Fail("the callback never ran");
+        }
+        push(10);
+        capture += std::chrono::milliseconds(500);
+        push(10);
+        capture += 2 * period;
+        push(10);
+        if (!held.Drain(31) || held.pipeline.GetStats().underruns != 1) {
+            return Fail("capture gaps gave " + std::to_string(held.pipeline.GetStats().underruns) +
+                        " underruns, expected 1 (lost packets, not the pause)");
+        }
+    }
+
+    // Audio captured on time but delivered long after the ring ran dry came late
+    {
+        HeldPipeline held(64, 64);
+        Clock::time_point capture = Clock::now();
+        for (int i = 0; i < 3; ++i) {
+            held.pipeline.Push(packet.data(), packet.size(), CHANNELS, capture);
+            capture += period;
+        }
+        if (!held.Drain(3)) {
+            return Fail("the first packets were not delivered");
+        }
+        std::this_thread::sleep_for(10 * period);
+        held.pipeline.Push(packet.data(), packet.size(), CHANNELS, capture);
+        if (!held.Drain(4) || held.pipeline.GetStats().underruns != 1) {
+            return Fail("a late packet gave " + std::to_string(held.pipeline.GetStats().underruns) + " underruns, expected 1");
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    if (!CheckRingWrap() || !CheckOverflow() || !CheckStopDrains() || !CheckFileLossless() || !CheckUnderruns()) {
+        return 1;
+    }
+    std::cout << "AudioPipeline: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Checks CaptureFreshnessGuard on a simulated clock: how many leading frames
+// of a packet it skips, when it counts a stall, and that after a capture
+// thread stall the audio passed on is never older than the limit. Exits
+// non-zero on the first mismatch.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include "CaptureFreshnessGuard.h"
+
+namespace {
+
+using Clock = CaptureFreshnessGuard::Clock;
+using std::chrono::milliseconds;
+using std::chrono::microseconds;
+
+const uint32_t SAMPLE_RATE = 48000;
+const size_t PACKET_FRAMES = SAMPLE_RATE / 100;     // 10 ms
+const Clock::time_point START = Clock::time_point() + std::chrono::seconds(10);
+
+bool Fail(const char* what, uint64_t actual, uint64_t expected) {
+    std::cerr << "CaptureFreshnessGuard: " << what << ": got " << actual << ", expected " << expected << std::endl;
+    return false;
+}
+
+// Age in seconds, at now, of the first frame a packet passes on after skipping stale ones
+double KeptAge(Clock::time_point captureTime, size_t stale, Clock::time_point now) {
+    return std::chrono::duration<double>(now - captureTime).count() - static_cast<double>(stale) / SAMPLE_RATE;
+}
+
+bool CheckPackets() {
+    CaptureFreshnessGuard guard;
+    const auto maxAge = CaptureFreshnessGuard::DEFAULT_MAX_AGE;
+
+    // Captured long before the limit: all of it goes
+    size_t stale = guard.GetStaleFrames(START - milliseconds(500), PACKET_FRAMES, SAMPLE_RATE, START);
+    if (stale != PACKET_FRAMES) {
+        return Fail("fully stale packet", stale, PACKET_FRAMES);
+    }
+
+    // Straddling the limit: the frames older than it, rounded up to whole frames
+    for (const auto excess : { microseconds(1), microseconds(5010), microseconds(9990) }) {
+        const Clock::time_point captureTime = START - maxAge - excess;
+        stale = guard.GetStaleFrames(captureTime, PACKET_FRAMES, SAMPLE_RATE, START);
+        const size_t expected = static_cast<size_t>(std::ceil(std::chrono::duration<double>(excess).count() * SAMPLE_RATE));
+        if (stale != expected) {
+            return Fail("partly stale packet", stale, expected);
+        }
+        // The first frame kept is within the limit, the last one skipped is not
+        const double limit = std::chrono::duration<double>(maxAge).count();
+        if (KeptAge(captureTime, stale, START) > limit || KeptAge(captureTime, stale - 1, START) <= limit) {
+            std::cerr << "CaptureFreshnessGuard: partly stale packet cut at the wrong frame" << std::endl;
+            return false;
+        }
+    }
+    stale = guard.GetStaleFrames(START - maxAge - microseconds(5010), PACKET_FRAMES, SAMPLE_RATE, START);
+    if (stale != 241) {
+        return Fail("5.01 ms over the limit at 48 kHz", stale, 241);
+    }
+
+    // Exactly at the limit, fresh, and in the future (look-ahead input)
+    for (const auto captureTime : { START - maxAge, START - milliseconds(10), START + milliseconds(50) }) {
+        stale = guard.GetStaleFrames(captureTime, PACKET_FRAMES, SAMPLE_RATE, START);
+        if (stale != 0) {
+            return Fail("fresh or future packet", stale, 0);
+        }
+    }
+    return true;
+}
+
+bool CheckStallCount() {
+    CaptureFreshnessGuard guard;
+
+    // Three stale packets in a row are one stall; a fresh one ends it
+    for (int i = 0; i < 3; ++i) {
+        guard.GetStaleFrames(START - milliseconds(300), PACKET_FRAMES, SAMPLE_RATE, START + milliseconds(10 * i));
+    }
+    if (guard.GetStats().stalls != 1) {
+        return Fail("stalls after one run of stale packets", guard.GetStats().stalls, 1);
+    }
+    if (guard.GetStats().staleFrames != 3 * PACKET_FRAMES) {
+        return Fail("stale frames after one run", guard.GetStats().staleFrames, 3 * PACKET_FRAMES);
+    }
+    guard.GetStaleFrames(START, PACKET_FRAMES, SAMPLE_RATE, START + milliseconds(10));
+    guard.GetStaleFrames(START - milliseconds(300), PACKET_FRAMES, SAMPLE_RATE, START + milliseconds(20));
+    if (guard.GetStats().stalls != 2) {
+        return Fail("stalls after a second run", guard.GetStats().stalls, 2);
+    }
+
+    guard.Reset();
+    if (guard.GetStats().stalls != 0 || guard.GetStats().staleFrames != 0) {
+        return Fail("stalls after Reset", guard.GetStats().stalls, 0);
+    }
+    return true;
+}
+
+bool CheckDisabled() {
+    CaptureFreshnessGuard guard;
+    guard.SetMaxAge(milliseconds(0));
+    const size_t stale = guard.GetStaleFrames(START - std::chrono::seconds(5), PACKET_FRAMES, SAMPLE_RATE, START);
+    if (stale != 0 || guard.GetStats().stalls != 0) {
+        return Fail("disabled guard skipped frames", stale, 0);
+    }
+    return true;
+}
+
+// A live source delivers a 10 ms packet one period after capturing it, until
+// the capture thread stalls for 250 ms and then reads the backlog at once.
+// Returns the age in ms of the oldest frame passed on.
+double OldestDelivered(CaptureFreshnessGuard& guard) {
+    const auto packetDuration = milliseconds(10);
+    const auto stall = milliseconds(250);
+    const Clock::time_point stallStart = START + 50 * packetDuration;
+    Clock::time_point captureTime = START;
+    double oldest = 0.0;
+    for (int i = 0; i < 100; ++i) {
+        const Clock::time_point ready = captureTime + packetDuration;
+        const Clock::time_point now = ready > stallStart ? (std::max)(ready, stallStart + stall) : ready;
+        const size_t stale = guard.GetStaleFrames(captureTime, PACKET_FRAMES, SAMPLE_RATE, now);
+        if (stale < PACKET_FRAMES) {
+            oldest = (std::max)(oldest, KeptAge(captureTime, stale, now) * 1000.0);
+        }
+        captureTime += packetDuration;
+    }
+    return oldest;
+}
+
+bool CheckStallRecovery() {
+    CaptureFreshnessGuard guard;
+    const double oldest = OldestDelivered(guard);
+    if (oldest > 100.0 + 1e-6) {
+        std::cerr << "CaptureFreshnessGuard: after a 250 ms stall, audio " << oldest << " ms old was passed on" << std::endl;
+        return false;
+    }
+    if (guard.GetStats().stalls != 1) {
+        return Fail("stalls for one capture thread stall", guard.GetStats().stalls, 1);
+    }
+
+    // The simulation does produce a backlog older than the limit
+    CaptureFreshnessGuard disabled(milliseconds(0));
+    if (OldestDelivered(disabled) < 250.0) {
+        std::cerr << "CaptureFreshnessGuard: the simulated stall left no backlog" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    if (!CheckPackets() || !CheckStallCount() || !CheckDisabled() || !CheckStallRecovery()) {
+        return 1;
+    }
+    std::cout << "CaptureFreshnessGuard: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Checks CaptureRingReader against a simulated device buffer: a writer puts
+// a known byte sequence into the ring at uneven, non-frame-aligned steps,
+// and every region the reader hands out must hold exactly the next bytes of
+// that sequence, in whole frames. Exits non-zero on the first mismatch.
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "CaptureRingReader.h"
+
+namespace {
+
+uint8_t SequenceByte(uint64_t index) {
+    return static_cast<uint8_t>(index % 251);
+}
+
+bool Fail(const char* what, uint32_t bufferBytes, uint32_t blockAlign, uint64_t step) {
+    std::cerr << "CaptureRingReader: " << what << " (buffer " << bufferBytes << ", frame " << blockAlign
+              << ", step " << step << ")" << std::endl;
+    return false;
+}
+
+bool CheckLayout(uint32_t bufferBytes, uint32_t blockAlign, uint32_t chunkBytes, std::mt19937& rng) {
+    CaptureRingReader reader;
+    reader.Configure(bufferBytes, blockAlign, chunkBytes);
+    const uint32_t size = reader.GetBufferBytes();
+    if (size % reader.GetChunkBytes() != 0 || reader.GetChunkBytes() % blockAlign != 0 || reader.GetChunkCount() < 2) {
+        return Fail("buffer is not whole chunks of whole frames", size, blockAlign, 0);
+    }
+
+    std::vector<uint8_t> device(size, 0);
+    uint64_t written = 0;   // Bytes the device has written in total
+    uint64_t read = 0;      // Bytes the reader has consumed in total
+    std::uniform_int_distribution<uint32_t> writeStep(0, size / 3);
+    std::uniform_int_distribution<uint32_t> readLimit(0, size);
+
+    for (uint64_t step = 0; step < 2000; ++step) {
+        // The device never laps the reader (that is a lost buffer, not a read)
+        const uint64_t room = size - 1 - (written - read);
+        const uint64_t bytes = (std::min<uint64_t>)(writeStep(rng), room);
+        for (uint64_t i = 0; i < bytes; ++i) {
+            device[(written + i) % size] = SequenceByte(written + i);
+        }
+        written += bytes;
+        const uint32_t writePosition = static_cast<uint32_t>(written % size);
+
+        const uint64_t pending = (written - read) / blockAlign * blockAlign;
+        if (reader.GetAvailable(writePosition) != pending) {
+            return Fail("available bytes differ from what the device wrote", size, blockAlign, step);
+        }
+
+        const uint32_t maxBytes = readLimit(rng);
+        const CaptureRingReader::Region region = reader.GetReadable(writePosition, maxBytes);
+        const uint32_t expected = static_cast<uint32_t>((std::min<uint64_t>)(pending, maxBytes / blockAlign * blockAlign));
+        if (region.GetBytes() != expected || region.bytes1 % blockAlign != 0 || region.bytes2 % blockAlign != 0) {
+            return Fail("region is not the whole frames available", size, blockAlign, step);
+        }
+        if (region.offset != read % size || region.offset + region.bytes1 > size || (region.bytes2 > 0 && region.offset + region.bytes1 != size)) {
+            return Fail("region does not split at the buffer end", size, blockAlign, step);
+        }
+
+        for (uint32_t i = 0; i < region.bytes1; ++i) {
+            if (device[region.offset + i] != SequenceByte(read + i)) {
+                return Fail("first span holds the wrong bytes", size, blockAlign, step);
+            }
+        }
+        for (uint32_t i = 0; i < region.bytes2; ++i) {
+            if (device[i] != SequenceByte(read + region.bytes1 + i)) {
+                return Fail("wrapped span holds the wrong bytes", size, blockAlign, step);
+            }
+        }
+        reader.Advance(region.GetBytes());
+        read += region.GetBytes();
+    }
+
+    // Write cursor on the read cursor: empty, and a full lap after a stall
+    // looks the same, so it reads as nothing
+    const uint32_t position = reader.GetReadPosition();
+    if (reader.GetAvailable(position) != 0 || reader.GetAvailable(position + size) != 0 ||
+        reader.GetReadable(position, size).GetBytes() != 0) {
+        return Fail("write cursor on the read cursor is not empty", size, blockAlign, 0);
+    }
+
+    // Reset rounds a device cursor down to a frame
+    reader.Reset(blockAlign + blockAlign / 2);
+    if (reader.GetReadPosition() != blockAlign) {
+        return Fail("Reset does not round down to a frame", size, blockAlign, 0);
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1234);
+    // Frame sizes from 8-bit mono to 32-bit 7.1, including odd ones (24-bit
+    // stereo, 5.1) whose frames do not divide a power-of-two buffer
+    const uint32_t frames[] = { 1, 2, 4, 6, 8, 12, 18, 24, 32 };
+    for (uint32_t blockAlign : frames) {
+        if (!CheckLayout(4410 * blockAlign, blockAlign, 441 * blockAlign, rng) ||
+            !CheckLayout(65536, blockAlign, 1000, rng) ||
+            !CheckLayout(3 * blockAlign, blockAlign, 1, rng)) {
+            return 1;
+        }
+    }
+    std::cout << "CaptureRingReader: all checks passed" << std::endl;
+    return 0;
+}
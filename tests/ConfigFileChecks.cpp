@@ -0,0 +1,119 @@
+// Checks that ConfigFile::Parse accepts a well-formed file and rejects the
+// ones that must not reach the running session: non-finite numbers, values
+// that parse but mean nothing, and empty or cut-off files. Also checks that
+// ReloadIfChanged only loads a file once it has stopped changing. Exits
+// non-zero on the first mismatch.
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "ConfigFile.h"
+
+namespace {
+
+// Parse errors are expected here; keep them out of the test log
+bool Parses(const std::string& text, ConfigFile::Config& config) {
+    std::istringstream in(text);
+    std::streambuf* errors = std::cerr.rdbuf(nullptr);
+    const bool ok = ConfigFile::Parse(in, "check", config);
+    std::cerr.rdbuf(errors);
+    return ok;
+}
+
+bool Expect(bool accepted, const std::string& text) {
+    ConfigFile::Config config;
+    if (Parses(text, config) != accepted) {
+        std::cerr << "ConfigFile: expected the file to be " << (accepted ? "accepted" : "rejected") << ":\n"
+                  << text << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool CheckValues() {
+    ConfigFile::Config config;
+    if (!Parses("[audio]\nbass_cutoff = 120\n[haptics]\nresponse_curve = 0.5\n[device pad]\nfade_time_ms = 40\n", config) ||
+        config.audio.bassCutoff != 120.0f || config.haptics.responseCurve != 0.5f ||
+        config.profiles["pad"].fadeTimeMs != 40 || config.profiles["pad"].responseCurve != 0.5f) {
+        std::cerr << "ConfigFile: a valid file did not parse to its values" << std::endl;
+        return false;
+    }
+
+    return Expect(true, "[haptics]\nresponse_curve = 2\n") &&
+           // strtof accepts these spellings; none is a usable setting
+           Expect(false, "[haptics]\nresponse_curve = nan\n") &&
+           Expect(false, "[haptics]\nbass_intensity = inf\n") &&
+           Expect(false, "[audio]\nbass_cutoff = NAN\n") &&
+           Expect(false, "[gain]\nmax_gain = infinity\n") &&
+           Expect(false, "[haptics]\nresponse_curve = -1\n") &&
+           // In range one by one, meaningless together or at zero
+           Expect(false, "[haptics]\nresponse_curve = 0\n") &&
+           Expect(false, "[device pad]\nresponse_curve = 0\n") &&
+           Expect(false, "[audio]\nbass_cutoff = 5000\n") &&
+           Expect(false, "[audio]\nbass_cutoff = 300\ntreble_cutoff = 300\n") &&
+           Expect(false, "[gain]\nmin_gain = 20\nmax_gain = 10\n") &&
+           Expect(true, "[gain]\nmin_gain = 10\nmax_gain = 10\n") &&
+           // What an editor leaves behind mid-save
+           Expect(false, "") &&
+           Expect(false, "# Audio-to-Haptics configuration\n") &&
+           Expect(true, "[haptics]\n");
+}
+
+void Write(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream(path, std::ios::trunc) << text;
+}
+
+// Each write changes the size, so this does not depend on the file system's
+// timestamp resolution
+bool CheckReload() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "audiohaptics_config_check.ini";
+    ConfigFile file(path.string());
+    std::streambuf* errors = std::cerr.rdbuf(nullptr);
+    auto poll = [&]() { return file.ReloadIfChanged(); };
+
+    Write(path, "[haptics]\nfade_time_ms = 40\n");
+    bool ok = file.Load() && !poll();
+    const char* failure = "a valid file did not load, or loaded again unchanged";
+
+    // A change is loaded on the second poll that sees it
+    Write(path, "[haptics]\nfade_time_ms = 200\n");
+    if (ok && (poll() || !poll() || file.Get().haptics.fadeTimeMs != 200 || poll())) {
+        ok = false;
+        failure = "a settled change was not loaded exactly once, one poll late";
+    }
+
+    // A file still growing at the second poll waits for a third
+    Write(path, "[haptics]\nfade_time_ms = 3\n");
+    const bool firstPoll = poll();
+    Write(path, "[haptics]\nfade_time_ms = 300\n");
+    if (ok && (firstPoll || poll() || !poll() || file.Get().haptics.fadeTimeMs != 300)) {
+        ok = false;
+        failure = "a file that was still being written was loaded";
+    }
+
+    // An emptied file is rejected and the last good config kept
+    Write(path, "");
+    if (ok && (poll() || poll() || file.Get().haptics.fadeTimeMs != 300)) {
+        ok = false;
+        failure = "an empty file replaced the config";
+    }
+
+    std::cerr.rdbuf(errors);
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    if (!ok) {
+        std::cerr << "ConfigFile: " << failure << std::endl;
+    }
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    if (!CheckValues() || !CheckReload()) {
+        return 1;
+    }
+    std::cout << "ConfigFile: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,289 @@
+// Checks what HapticController writes to a device, through a
+// RecordingHapticSink: rise and fade ramps take riseTimeMs/fadeTimeMs, writes
+// are filtered by writeThreshold and maxWritesPerSecond, an emulated burst
+// starts within one tick of its onset, and bursts keep emulationMinInterval
+// apart. Ramps and filtering are driven by RunOutputTick with a fixed step;
+// the burst checks run on the wall clock, as the controller times bursts by
+// it, and only assert what holds however late a tick wakes. Exits non-zero on
+// the first mismatch.
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "HapticController.h"
+#include "RecordingHapticSink.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Levels = HapticMapper::MotorLevels;
+using Settings = HapticController::HapticSettings;
+
+const float TICK = 0.004f;      // Seconds per RunOutputTick
+const char* DEVICE = "recording:0";
+
+// One device, output advanced by hand, mapping taken from its profile
+struct Rig {
+    std::shared_ptr<RecordingHapticSink> sink = std::make_shared<RecordingHapticSink>(1);
+    HapticController controller;
+
+    explicit Rig(const Settings& settings) {
+        // Keep the controller's status line out of the test log
+        std::streambuf* out = std::cout.rdbuf(nullptr);
+        controller.Initialize(sink, false);
+        std::cout.rdbuf(out);
+        controller.SetDeviceProfile(DEVICE, settings);
+    }
+
+    // Bass level as the mapped left motor level. Fed twice, so the
+    // controller has no older block to ramp from; the onset, if any, goes
+    // with the second block only.
+    void Feed(float level, const BlockTimestamps& timestamps = {}, bool onset = false) {
+        AudioProcessor::AudioFeatures features{};
+        features.bassTrend.smoothed = level;
+        controller.ProcessAudioFeatures(features, timestamps);
+        if (onset) {
+            features.onsets[0] = { 0.0f, 1.0f };
+            features.onsetCount = 1;
+        }
+        controller.ProcessAudioFeatures(features, timestamps);
+    }
+};
+
+// Left motor only, at the bass level; no fades, filtering or bursts unless a check sets them
+Settings LeftMotorOnly() {
+    Settings settings;
+    settings.bassIntensity = 1.0f;
+    settings.volumeIntensity = 0.0f;
+    settings.lfeIntensity = 0.0f;
+    settings.useHighFrequencyMotor = false;
+    settings.useImpulseMotor = false;
+    settings.riseTimeMs = 0;
+    settings.fadeTimeMs = 0;
+    settings.writeThreshold = 0.0f;
+    settings.maxWritesPerSecond = 0;
+    settings.preferredMode = HapticController::HapticMode::Rumble;
+    return settings;
+}
+
+bool Fail(const std::string& message) {
+    std::cerr << "HapticOutput: " << message << std::endl;
+    return false;
+}
+
+// Ticks until the left motor settles at level, checking every write is one
+// full rise/fade step; returns the ramp's duration in seconds, or -1
+double Ramp(Rig& rig, float from, float level, uint32_t rampMs) {
+    rig.sink->Clear();
+    rig.Feed(level);
+    const float step = 1000.0f / static_cast<float>(rampMs) * TICK;
+    int ticks = 0;
+    while (ticks < 1000) {
+        rig.controller.RunOutputTick(TICK);
+        ++ticks;
+        const auto writes = rig.sink->GetWrites();
+        if (writes.size() != static_cast<size_t>(ticks)) {
+            Fail("a ramp tick wrote nothing");
+            return -1.0;
+        }
+        const Levels& written = writes.back().levels;
+        const float expected = level > from ? (std::min)(from + step * ticks, level) : (std::max)(from - step * ticks, level);
+        if (std::abs(written.leftMotor - expected) > 1e-5f) {
+            Fail("ramp step " + std::to_string(ticks) + " wrote " + std::to_string(written.leftMotor) + ", expected " +
+                 std::to_string(expected));
+            return -1.0;
+        }
+        if (written.leftMotor == level) {
+            break;
+        }
+    }
+
+    // Once there, nothing more to write
+    rig.controller.RunOutputTick(TICK);
+    const auto writes = rig.sink->GetWrites();
+    if (writes.size() != static_cast<size_t>(ticks)) {
+        Fail("a settled level was written again");
+        return -1.0;
+    }
+    for (size_t i = 1; i < writes.size(); ++i) {
+        if (writes[i].time < writes[i - 1].time || writes[i].device != 0) {
+            Fail("ramp writes out of order or to the wrong device");
+            return -1.0;
+        }
+    }
+    return ticks * static_cast<double>(TICK);
+}
+
+bool CheckRamps() {
+    Settings settings = LeftMotorOnly();
+    settings.riseTimeMs = 30;
+    settings.fadeTimeMs = 100;
+    Rig rig(settings);
+
+    // A full-scale change takes the ramp time, so 0.7 of one takes 0.7 of it,
+    // rounded up to whole ticks
+    const double rise = Ramp(rig, 0.0f, 0.7f, settings.riseTimeMs);
+    const double fade = Ramp(rig, 0.7f, 0.0f, settings.fadeTimeMs);
+    if (rise < 0.0 || fade < 0.0) {
+        return false;
+    }
+    if (rise < 0.7 * 0.030 || rise > 0.7 * 0.030 + TICK) {
+        return Fail("rise took " + std::to_string(rise * 1000.0) + " ms");
+    }
+    if (fade < 0.7 * 0.100 || fade > 0.7 * 0.100 + TICK) {
+        return Fail("fade took " + std::to_string(fade * 1000.0) + " ms");
+    }
+    return true;
+}
+
+bool CheckWriteThreshold() {
+    Settings settings = LeftMotorOnly();
+    settings.writeThreshold = 0.05f;
+    Rig rig(settings);
+
+    // Changes within the threshold wait; the next one past it is written,
+    // and so is silence, however close to it the last write was
+    const float levels[] = { 0.5f, 0.53f, 0.47f, 0.56f, 0.03f, 0.0f };
+    const bool written[] = { true, false, false, true, true, true };
+    size_t expectedWrites = 0;
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); ++i) {
+        rig.Feed(levels[i]);
+        rig.controller.RunOutputTick(TICK);
+        expectedWrites += written[i] ? 1 : 0;
+        const auto writes = rig.sink->GetWrites();
+        if (writes.size() != expectedWrites || (written[i] && writes.back().levels.leftMotor != levels[i])) {
+            return Fail("level " + std::to_string(levels[i]) + (written[i] ? " was not written" : " was written"));
+        }
+    }
+    const HapticController::WriteStats stats = rig.controller.GetWriteStats();
+    if (stats.issued != 4 || stats.suppressed != 2) {
+        return Fail("threshold write stats " + std::to_string(stats.issued) + "/" + std::to_string(stats.suppressed));
+    }
+    return true;
+}
+
+bool CheckWriteBudget() {
+    Settings settings = LeftMotorOnly();
+    settings.maxWritesPerSecond = 50;
+    Rig rig(settings);
+
+    // Every tick has a new level, 250 ticks a second; the budget allows 50
+    // writes a second, plus the one the bucket starts with
+    const int ticks = static_cast<int>(std::lround(1.0f / TICK));
+    for (int i = 0; i < ticks; ++i) {
+        rig.Feed(i % 2 ? 0.2f : 0.6f);
+        rig.controller.RunOutputTick(TICK);
+    }
+    const size_t writes = rig.sink->GetWriteCount();
+    const HapticController::WriteStats stats = rig.controller.GetWriteStats();
+    if (writes < 50 || writes > 51) {
+        return Fail(std::to_string(writes) + " writes in one second at 50 a second");
+    }
+    if (stats.issued != writes || stats.issued + stats.suppressed != static_cast<uint64_t>(ticks)) {
+        return Fail("budget write stats do not add up to the ticks run");
+    }
+    return true;
+}
+
+// Runs ticks TICK apart on the wall clock, with loud features fed before
+// each so they never go stale. tickStarts[i] is taken before tick i, and
+// writeTicks[w] is the tick that made write w.
+void RunTicks(Rig& rig, std::chrono::milliseconds duration, std::vector<Clock::time_point>& tickStarts,
+              std::vector<size_t>& writeTicks) {
+    const Clock::time_point end = Clock::now() + duration;
+    while (Clock::now() < end) {
+        rig.Feed(0.7f);
+        tickStarts.push_back(Clock::now());
+        rig.controller.RunOutputTick(TICK);
+        writeTicks.resize(rig.sink->GetWriteCount(), tickStarts.size() - 1);
+        std::this_thread::sleep_for(std::chrono::duration<float>(TICK));
+    }
+    tickStarts.push_back(Clock::now());
+}
+
+bool IsSilent(const Levels& levels) {
+    return levels.leftMotor == 0.0f && levels.rightMotor == 0.0f && levels.leftTrigger == 0.0f && levels.rightTrigger == 0.0f;
+}
+
+bool CheckBurstOnOnset() {
+    Settings settings = LeftMotorOnly();
+    settings.preferredMode = HapticController::HapticMode::HapticEmulation;
+    settings.emulationOnsets = true;
+    settings.emulationOnsetDelay = 0.04f;
+    Rig rig(settings);
+
+    // The controller's clock must be past the first emulationMinInterval, or
+    // the onset would be dropped as too soon after time zero
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    BlockTimestamps timestamps;
+    timestamps.capture = Clock::now();
+    rig.Feed(0.7f, timestamps, true);
+    const Clock::time_point due = timestamps.capture + std::chrono::milliseconds(40);
+
+    std::vector<Clock::time_point> tickStarts;
+    std::vector<size_t> writeTicks;
+    RunTicks(rig, std::chrono::milliseconds(120), tickStarts, writeTicks);
+    const auto writes = rig.sink->GetWrites();
+    if (writes.empty() || IsSilent(writes.front().levels)) {
+        return Fail("no burst for a scheduled onset");
+    }
+
+    // Never early, and no tick that started after the onset was due let it pass
+    const size_t tick = writeTicks.front();
+    if (writes.front().time < due) {
+        return Fail("a burst started before its onset was due");
+    }
+    if (tick >= 2 && tickStarts[tick - 1] >= due) {
+        return Fail("a burst started more than one tick after its onset was due");
+    }
+    return true;
+}
+
+bool CheckBurstInterval() {
+    Settings settings = LeftMotorOnly();
+    settings.preferredMode = HapticController::HapticMode::HapticEmulation;
+    settings.emulationOnsets = false;   // Fixed cadence, as fast as the interval allows
+    settings.emulationBurstDuration = 0.05f;
+    settings.emulationMinInterval = 0.1f;
+    settings.writeThreshold = 0.01f;
+    Rig rig(settings);
+
+    std::vector<Clock::time_point> tickStarts;
+    std::vector<size_t> writeTicks;
+    RunTicks(rig, std::chrono::milliseconds(700), tickStarts, writeTicks);
+    const auto writes = rig.sink->GetWrites();
+
+    // A burst starts with the first loud write after silence. Its tick ran
+    // between its start and the next tick's, so two bursts in ticks a < b
+    // started at most tickStarts[b + 1] - tickStarts[a] apart.
+    std::vector<size_t> burstTicks;
+    for (size_t i = 0; i < writes.size(); ++i) {
+        if (!IsSilent(writes[i].levels) && (i == 0 || IsSilent(writes[i - 1].levels))) {
+            burstTicks.push_back(writeTicks[i]);
+        }
+    }
+    if (burstTicks.size() < 3) {
+        return Fail(std::to_string(burstTicks.size()) + " bursts in 700 ms of loud input");
+    }
+    for (size_t i = 1; i < burstTicks.size(); ++i) {
+        const auto apart = tickStarts[burstTicks[i] + 1] - tickStarts[burstTicks[i - 1]];
+        if (apart < std::chrono::duration<float>(settings.emulationMinInterval)) {
+            return Fail("bursts " + std::to_string(std::chrono::duration<double, std::milli>(apart).count()) +
+                        " ms apart, under emulationMinInterval");
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    if (!CheckRamps() || !CheckWriteThreshold() || !CheckWriteBudget() || !CheckBurstOnOnset() || !CheckBurstInterval()) {
+        return 1;
+    }
+    std::cout << "HapticOutput: all checks passed" << std::endl;
+    return 0;
+}
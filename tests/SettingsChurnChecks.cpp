@@ -0,0 +1,107 @@
+// Race check: retunes the haptic settings, a device profile, the mode and the
+// audio settings in a tight loop for a fixed time while test-tone playback
+// runs through the capture, analysis and output threads. Built with
+// -DAUDIOHAPTICS_SANITIZE=thread, ThreadSanitizer fails the run on any race;
+// in any build it checks that audio and haptic writes kept flowing and that
+// the last settings won. Exits non-zero on failure.
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include "AudioCaptureManager.h"
+#include "ConfigFile.h"
+#include "HapticController.h"
+#include "LatestValue.h"
+#include "RecordingHapticSink.h"
+#include "SettingsSnapshot.h"
+
+namespace {
+
+const auto CHURN_DURATION = std::chrono::seconds(1);
+
+bool Fail(const std::string& message) {
+    std::cerr << "SettingsChurn: " << message << std::endl;
+    return false;
+}
+
+bool CheckChurn() {
+    // Keep the capture and controller status lines out of the test log
+    std::streambuf* console = std::cout.rdbuf(nullptr);
+
+    AudioCaptureManager capture;
+    capture.SetInputFile("");
+    capture.Initialize(AudioCaptureManager::CaptureMethod::FILE_INPUT);
+
+    AudioProcessor processor;
+    processor.SetSampleRate(capture.GetSampleRate());
+    SettingsSnapshot<ConfigFile::AudioSettings> audioSettings;
+    LatestValue<AudioProcessor::AudioFeatures> latestFeatures;
+
+    HapticController controller;
+    HapticController::HapticSettings settings;
+    settings.updateRateMs = 1;
+    controller.SetHapticSettings(settings);
+    auto sink = std::make_shared<RecordingHapticSink>(2);
+    controller.Initialize(sink);
+
+    std::atomic<uint64_t> blocks{ 0 };
+    capture.SetAudioCallback([&](const float* samples, size_t sampleCount, size_t channels, const BlockTimestamps& timestamps) {
+        if (audioSettings.Update()) {
+            processor.SetSensitivity(audioSettings.Get().sensitivity);
+            processor.SetOnsetSettings(audioSettings.Get().onsets);
+        }
+        const AudioProcessor::AudioFeatures features = processor.ProcessAudio(samples, sampleCount, channels);
+        latestFeatures.Publish(features);
+        controller.ProcessAudioFeatures(features, timestamps);
+        blocks.fetch_add(1, std::memory_order_relaxed);
+    });
+    const bool started = capture.StartCapture();
+    std::cout.rdbuf(console);
+    if (!started) {
+        return Fail("test-tone capture did not start");
+    }
+
+    ConfigFile::AudioSettings audio;
+    AudioProcessor::AudioFeatures newest{};
+    uint64_t i = 0;
+    const auto end = std::chrono::steady_clock::now() + CHURN_DURATION;
+    while (std::chrono::steady_clock::now() < end) {
+        ++i;
+        settings.bassIntensity = 1.0f + (i % 2) * 0.5f;
+        settings.preferredMode = (i % 3) ? HapticController::HapticMode::Rumble : HapticController::HapticMode::HapticEmulation;
+        settings.fadeTimeMs = static_cast<uint32_t>(50 + i % 100);
+        controller.SetHapticSettings(settings);
+        if (i % 8 == 0) {
+            controller.SetDeviceProfile("recording:1", settings);
+        }
+        audio.sensitivity = 1.0f + static_cast<float>(i % 5);
+        audioSettings.Publish(audio);
+        newest = latestFeatures.Read();
+    }
+
+    console = std::cout.rdbuf(nullptr);
+    capture.StopCapture();
+    controller.Shutdown();
+    std::cout.rdbuf(console);
+
+    if (blocks.load() == 0 || newest.volume <= 0.0f) {
+        return Fail("no test tone reached the analysis while settings changed");
+    }
+    if (sink->GetWriteCount() == 0) {
+        return Fail("no haptic writes while settings changed");
+    }
+    const HapticController::HapticSettings last = controller.GetHapticSettings();
+    if (last.bassIntensity != settings.bassIntensity || last.fadeTimeMs != settings.fadeTimeMs ||
+        last.preferredMode != settings.preferredMode || controller.GetActiveHapticMode() != settings.preferredMode) {
+        return Fail("the last settings set did not stick");
+    }
+    std::cout << "SettingsChurn: " << i << " settings changes over " << blocks.load() << " audio blocks" << std::endl;
+    return true;
+}
+
+} // namespace
+
+int main() {
+    return CheckChurn() ? 0 : 1;
+}